@@ -133,6 +133,10 @@ bool CmdLineParser::parseFromArgs(int argc, const char* const argv[])
             else if (std::strncmp(argv[i], "--addon=", 8) == 0)
                 mSettings->addons.emplace_back(argv[i]+8);
 
+            // Write the analyzer info in XML format
+            else if (std::strcmp(argv[i], "--analyzer-info-xml") == 0)
+                mSettings->analyzerInfoXml = true;
+
             else if (std::strncmp(argv[i], "--cppcheck-build-dir=", 21) == 0) {
                 mSettings->buildDir = Path::fromNativeSeparators(argv[i] + 21);
                 if (endsWith(mSettings->buildDir, '/'))
@@ -271,6 +275,10 @@ bool CmdLineParser::parseFromArgs(int argc, const char* const argv[])
             else if (std::strcmp(argv[i], "--inline-suppr") == 0)
                 mSettings->inlineSuppressions = true;
 
+            // Check the files in long-lived worker processes
+            else if (std::strcmp(argv[i], "--worker-pool") == 0)
+                mSettings->workerPool = true;
+
             // Verbose error messages (configuration info)
             else if (std::strcmp(argv[i], "-v") == 0 || std::strcmp(argv[i], "--verbose") == 0)
                 mSettings->verbose = true;
@@ -486,6 +494,20 @@ bool CmdLineParser::parseFromArgs(int argc, const char* const argv[])
                 }
             }
 
+            // Number of threads that check the configurations of a file
+            else if (std::strncmp(argv[i], "--config-jobs=", 14) == 0) {
+                std::istringstream iss(14+argv[i]);
+                if (!(iss >> mSettings->configJobs)) {
+                    printMessage("cppcheck: argument to '--config-jobs=' is not a number.");
+                    return false;
+                }
+
+                if (mSettings->configJobs < 1 || mSettings->configJobs > 1024) {
+                    printMessage("cppcheck: argument to '--config-jobs=' must be between 1 and 1024.");
+                    return false;
+                }
+            }
+
             // file list specified
             else if (std::strncmp(argv[i], "--file-list=", 12) == 0) {
                 // open this file and read every input file (1 file name per line)
@@ -658,6 +680,15 @@ bool CmdLineParser::parseFromArgs(int argc, const char* const argv[])
                 }
             }
 
+            // Write trace events of the timers
+            else if (std::strncmp(argv[i], "--trace=", 8) == 0) {
+                mSettings->traceFile = Path::simplifyPath(Path::fromNativeSeparators(argv[i] + 8));
+                if (mSettings->traceFile.empty()) {
+                    printMessage("cppcheck: error: no file given to '--trace'.");
+                    return false;
+                }
+            }
+
             // Checking threads
             else if (std::strncmp(argv[i], "-j", 2) == 0) {
                 std::string numberString;
@@ -747,12 +778,17 @@ bool CmdLineParser::parseFromArgs(int argc, const char* const argv[])
                     mSettings->showtime = SHOWTIME_SUMMARY;
                 else if (showtimeMode == "top5")
                     mSettings->showtime = SHOWTIME_TOP5;
+                else if (showtimeMode == "json") {
+                    // Only the JSON is written to stdout
+                    mSettings->showtime = SHOWTIME_JSON;
+                    mSettings->quiet = true;
+                }
                 else if (showtimeMode.empty())
                     mSettings->showtime = SHOWTIME_NONE;
                 else {
                     std::string message("cppcheck: error: unrecognized showtime mode: \"");
                     message += showtimeMode;
-                    message += "\". Supported modes: file, summary, top5.";
+                    message += "\". Supported modes: file, summary, top5, json.";
                     printMessage(message);
                     return false;
                 }
@@ -853,6 +889,57 @@ bool CmdLineParser::parseFromArgs(int argc, const char* const argv[])
                 maxconfigs = true;
             }
 
+            // Number of threads for the ValueFlow analysis of a file
+            else if (std::strncmp(argv[i], "--valueflow-jobs=", 17) == 0) {
+                std::istringstream iss(17+argv[i]);
+                if (!(iss >> mSettings->valueFlowJobs)) {
+                    printMessage("cppcheck: argument to '--valueflow-jobs=' is not a number.");
+                    return false;
+                }
+
+                if (mSettings->valueFlowJobs < 1 || mSettings->valueFlowJobs > 1024) {
+                    printMessage("cppcheck: argument to '--valueflow-jobs=' must be between 1 and 1024.");
+                    return false;
+                }
+            }
+
+            // Number of iterations of the ValueFlow analysis
+            else if (std::strncmp(argv[i], "--valueflow-max-iterations=", 27) == 0) {
+                std::istringstream iss(27+argv[i]);
+                if (!(iss >> mSettings->valueFlowMaxIterations)) {
+                    printMessage("cppcheck: argument to '--valueflow-max-iterations=' is not a number.");
+                    return false;
+                }
+            }
+
+            // Number of tokens ValueFlow follows forward
+            else if (std::strncmp(argv[i], "--valueflow-max-forward-tokens=", 31) == 0) {
+                std::istringstream iss(31+argv[i]);
+                if (!(iss >> mSettings->valueFlowMaxForwardTokens)) {
+                    printMessage("cppcheck: argument to '--valueflow-max-forward-tokens=' is not a number.");
+                    return false;
+                }
+
+                if (mSettings->valueFlowMaxForwardTokens < 1) {
+                    printMessage("cppcheck: argument to '--valueflow-max-forward-tokens=' must be greater than 0.");
+                    return false;
+                }
+            }
+
+            // Number of values of a token
+            else if (std::strncmp(argv[i], "--valueflow-max-values=", 23) == 0) {
+                std::istringstream iss(23+argv[i]);
+                if (!(iss >> mSettings->valueFlowMaxValues)) {
+                    printMessage("cppcheck: argument to '--valueflow-max-values=' is not a number.");
+                    return false;
+                }
+
+                if (mSettings->valueFlowMaxValues < 1) {
+                    printMessage("cppcheck: argument to '--valueflow-max-values=' must be greater than 0.");
+                    return false;
+                }
+            }
+
             // Print help
             else if (std::strcmp(argv[i], "-h") == 0 || std::strcmp(argv[i], "--help") == 0) {
                 mPathNames.clear();
@@ -924,6 +1011,9 @@ void CmdLineParser::printHelp()
               "Options:\n"
               "    --addon=<addon>\n"
               "                         Execute addon. i.e. cert.\n"
+              "    --analyzer-info-xml  Write the analysis results in the --cppcheck-build-dir\n"
+              "                         in XML format, for tools that read them. By default\n"
+              "                         they are written in a compact binary format.\n"
               "    --cppcheck-build-dir=<dir>\n"
               "                         Analysis output directory. Useful for various data.\n"
               "                         Some possible usages are; whole program analysis,\n"
@@ -939,6 +1029,12 @@ void CmdLineParser::printHelp()
               "                         be considered for evaluation.\n"
               "    --config-excludes-file=<file>\n"
               "                         A file that contains a list of config-excludes\n"
+              "    --config-jobs=<jobs>\n"
+              "                         Start <jobs> threads that check the preprocessor\n"
+              "                         configurations of a file simultaneously. The results\n"
+              "                         are the same as when the configurations are checked\n"
+              "                         one after another. Ignored together with --dump,\n"
+              "                         --addon and rules for the simplified token list.\n"
               "    --doc                Print a list of all available checks.\n"
               "    --dump               Dump xml data for each translation unit. The dump\n"
               "                         files have the extension .dump and contain ast,\n"
@@ -1152,8 +1248,35 @@ void CmdLineParser::printHelp()
               "                           \\r         insert carriage return\n"
               "                         Example format (gcc-like):\n"
               "                         '{file}:{line}:{column}: note: {info}\\n{code}'\n"
+              "    --trace=<file>       Write the time of each step of the analysis of each\n"
+              "                         file in each process to <file>. The file can be\n"
+              "                         loaded in chrome://tracing or Perfetto.\n"
+              "    --valueflow-jobs=<jobs>\n"
+              "                         Start <jobs> threads that analyse the values of the\n"
+              "                         variables in the functions of a file simultaneously.\n"
+              "                         This speeds up the checking of large files. Values\n"
+              "                         that are forwarded past the end of a function are\n"
+              "                         analysed when all threads are done, so the results\n"
+              "                         are the same as with one job.\n"
+              "    --valueflow-max-forward-tokens=<limit>\n"
+              "                         Maximum number of tokens that are followed forward\n"
+              "                         from an assignment or condition to find the values\n"
+              "                         of a variable. Default is 100000.\n"
+              "    --valueflow-max-iterations=<limit>\n"
+              "                         Maximum number of times the values of the variables\n"
+              "                         are analysed to find more values. Default is 0, the\n"
+              "                         analysis is repeated until no more values are found.\n"
+              "    --valueflow-max-values=<limit>\n"
+              "                         Maximum number of values of an expression. Default\n"
+              "                         is 10. The limits make the analysis faster and do not\n"
+              "                         depend on the speed of the machine. Use\n"
+              "                         --debug-warnings to see when they are reached.\n"
               "    -v, --verbose        Output more detailed error information.\n"
               "    --version            Print out version number.\n"
+              "    --worker-pool        Used together with -j. Start <jobs> long-lived worker\n"
+              "                         processes that check one file after another, instead\n"
+              "                         of starting a new process for each file. Together with\n"
+              "                         --showtime, the throughput of each worker is printed.\n"
               "    --xml                Write results in xml format to error stream (stderr).\n"
               "    --xml-version=<version>\n"
               "                         Select the XML file version. Currently only versions 2 is available."
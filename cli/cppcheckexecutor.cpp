@@ -32,6 +32,7 @@
 #include "standards.h"
 #include "suppressions.h"
 #include "threadexecutor.h"
+#include "timer.h"
 #include "utils.h"
 #include "checkunusedfunctions.h"
 
@@ -854,6 +855,17 @@ int CppCheckExecutor::check_internal(CppCheck& cppcheck, int /*argc*/, const cha
         errorOutput = new std::ofstream(settings.outputFile);
     }
 
+    // The trace file is closed on every return
+    struct TraceFile {
+        ~TraceFile() {
+            TraceEvents::close();
+        }
+    } traceFile;
+    if (!settings.traceFile.empty() && !TraceEvents::open(settings.traceFile)) {
+        std::cout << "cppcheck: error: could not open the trace file '" << settings.traceFile << "'." << std::endl;
+        return EXIT_FAILURE;
+    }
+
     if (settings.xml) {
         reportErr(ErrorLogger::ErrorMessage::getXMLHeader());
     }
@@ -18,17 +18,21 @@
 
 #include "threadexecutor.h"
 
+#include "analyzerinfo.h"
 #include "config.h"
 #include "cppcheck.h"
 #include "cppcheckexecutor.h"
 #include "importproject.h"
 #include "settings.h"
 #include "suppressions.h"
+#include "timer.h"
 
 #include <algorithm>
 #include <cerrno>
+#include <chrono>
 #include <cstdlib>
 #include <cstring>
+#include <fstream>
 #include <iostream>
 #include <utility>
 
@@ -38,6 +42,7 @@
 #ifdef THREADING_MODEL_FORK
 #include <sys/select.h>
 #include <sys/wait.h>
+#include <csignal>
 #include <fcntl.h>
 #include <unistd.h>
 #endif
@@ -56,6 +61,7 @@ ThreadExecutor::ThreadExecutor(const std::map<std::string, std::size_t> &files,
 #if defined(THREADING_MODEL_FORK)
     _wpipe = 0;
 #elif defined(THREADING_MODEL_WIN)
+    _nextJob = 0;
     _processedFiles = 0;
     _totalFiles = 0;
     _processedSize = 0;
@@ -68,6 +74,69 @@ ThreadExecutor::~ThreadExecutor()
     //dtor
 }
 
+std::string ThreadExecutor::Job::name() const
+{
+    if (fileSettings)
+        return fileSettings->filename + ' ' + fileSettings->cfg;
+    return *file;
+}
+
+static std::size_t getFileSize(const std::string &filename)
+{
+    std::ifstream fin(filename, std::ios::in | std::ios::binary | std::ios::ate);
+    if (!fin.is_open())
+        return 0;
+    const std::streamoff size = fin.tellg();
+    return (size > 0) ? static_cast<std::size_t>(size) : 0;
+}
+
+void ThreadExecutor::createJobs()
+{
+    _jobs.clear();
+    _timings.clear();
+    _jobs.reserve(_settings.project.fileSettings.size() + _files.size());
+    for (const ImportProject::FileSettings &fs : _settings.project.fileSettings) {
+        _jobs.emplace_back(fs);
+        _jobs.back().size = getFileSize(fs.filename);
+    }
+    for (std::map<std::string, std::size_t>::const_iterator i = _files.begin(); i != _files.end(); ++i)
+        _jobs.emplace_back(i->first, i->second);
+
+    // Predict the cost of each job. Use the check time of earlier runs when
+    // it is known. Else the cost is estimated from the file size, scaled by
+    // the average time per byte of the files with known times.
+    std::map<std::string, double> timings;
+    if (!_settings.buildDir.empty())
+        timings = AnalyzerInformation::readTimings(_settings.buildDir);
+    double knownTime = 0;
+    std::size_t knownSize = 0;
+    std::vector<bool> known(_jobs.size(), false);
+    for (std::size_t i = 0; i < _jobs.size(); ++i) {
+        const std::map<std::string, double>::const_iterator timing = timings.find(_jobs[i].name());
+        if (timing == timings.end())
+            continue;
+        known[i] = true;
+        _jobs[i].cost = timing->second;
+        knownTime += timing->second;
+        knownSize += _jobs[i].size;
+    }
+    const double timePerByte = (knownTime > 0 && knownSize > 0) ? (knownTime / static_cast<double>(knownSize)) : 1.0;
+    for (std::size_t i = 0; i < _jobs.size(); ++i) {
+        if (!known[i])
+            _jobs[i].cost = static_cast<double>(_jobs[i].size) * timePerByte;
+    }
+
+    std::stable_sort(_jobs.begin(), _jobs.end(), [](const Job &job1, const Job &job2) {
+        return job1.cost > job2.cost;
+    });
+}
+
+void ThreadExecutor::writeTimings()
+{
+    if (!_settings.buildDir.empty() && !_timings.empty())
+        AnalyzerInformation::writeTimings(_settings.buildDir, _timings);
+}
+
 
 ///////////////////////////////////////////////////////////////////////////////
 ////// This code is for platforms that support fork() only ////////////////////
@@ -80,64 +149,130 @@ void ThreadExecutor::addFileContent(const std::string &path, const std::string &
     _fileContents[ path ] = content;
 }
 
-int ThreadExecutor::handleRead(int rpipe, unsigned int &result)
-{
-    char type = 0;
-    if (read(rpipe, &type, 1) <= 0) {
-        if (errno == EAGAIN)
-            return 0;
+// Messages are sent in frames: type (1 byte), payload length (unsigned int) and payload
+static const std::size_t FRAME_HEADER_SIZE = 1 + sizeof(unsigned int);
 
-        return -1;
+// Diagnostics are buffered in the child until this much data is collected
+static const std::size_t PIPE_BUFFER_SIZE = 64 * 1024;
+
+// When the child crashes, the complete frames in its buffer are written to
+// the pipe by a signal handler so the diagnostics of the file are not lost
+static const int crashSignals[] = {SIGABRT, SIGBUS, SIGFPE, SIGILL, SIGSEGV};
+static const std::size_t numberOfCrashSignals = sizeof(crashSignals) / sizeof(crashSignals[0]);
+static struct sigaction previousCrashActions[numberOfCrashSignals];
+static int crashPipe = -1;
+static const std::string *crashBuffer = nullptr;
+static volatile std::size_t crashBufferSize = 0;
+
+static void crashHandler(int signo, siginfo_t *info, void * /*context*/)
+{
+    std::size_t written = 0;
+    while (written < crashBufferSize) {
+        const ssize_t len = write(crashPipe, crashBuffer->data() + written, crashBufferSize - written);
+        if (len < 0 && errno == EINTR)
+            continue;
+        if (len <= 0)
+            break;
+        written += len;
     }
+    crashBufferSize = 0;
 
-    if (type != REPORT_OUT && type != REPORT_ERROR && type != REPORT_INFO && type != CHILD_END) {
-        std::cerr << "#### ThreadExecutor::handleRead error, type was:" << type << std::endl;
-        std::exit(0);
+    // Pass the signal on to the handler of CppCheckExecutor or the default action.
+    // A fault happens again when the handler returns, a sent signal is raised again.
+    for (std::size_t i = 0; i < numberOfCrashSignals; ++i) {
+        if (crashSignals[i] == signo)
+            sigaction(signo, &previousCrashActions[i], nullptr);
     }
+    if (info->si_code <= 0)
+        raise(signo);
+}
 
-    unsigned int len = 0;
-    if (read(rpipe, &len, sizeof(len)) <= 0) {
-        std::cerr << "#### ThreadExecutor::handleRead error, type was:" << type << std::endl;
-        std::exit(0);
+static void flushPipeOnCrash(int wpipe, const std::string &buffer)
+{
+    crashPipe = wpipe;
+    crashBuffer = &buffer;
+    crashBufferSize = 0;
+
+    struct sigaction act;
+    std::memset(&act, 0, sizeof(act));
+    act.sa_flags = SA_SIGINFO | SA_ONSTACK;
+    act.sa_sigaction = crashHandler;
+    for (std::size_t i = 0; i < numberOfCrashSignals; ++i)
+        sigaction(crashSignals[i], &act, &previousCrashActions[i]);
+}
+
+int ThreadExecutor::handleRead(int rpipe, unsigned int &result)
+{
+    char data[PIPE_BUFFER_SIZE];
+    const ssize_t len = read(rpipe, data, sizeof(data));
+    if (len < 0 && (errno == EAGAIN || errno == EINTR))
+        return 0;
+
+    std::string &buffer = _readBuffers[rpipe];
+    if (len > 0)
+        buffer.append(data, len);
+
+    // Handle all complete frames, up to the end of the file
+    int ret = (len > 0) ? 1 : 0;
+    std::size_t pos = 0;
+    while (ret == 1 && buffer.size() - pos >= FRAME_HEADER_SIZE) {
+        const char type = buffer[pos];
+        unsigned int payloadLen = 0;
+        std::memcpy(&payloadLen, buffer.data() + pos + 1, sizeof(payloadLen));
+        if (buffer.size() - pos - FRAME_HEADER_SIZE < payloadLen)
+            break;
+        const char * const payload = buffer.data() + pos + FRAME_HEADER_SIZE;
+        pos += FRAME_HEADER_SIZE + payloadLen;
+        ret = handleMessage(type, payload, payloadLen, result);
     }
+    buffer.erase(0, pos);
 
-    // Don't rely on incoming data being null-terminated.
-    // Allocate +1 element and null-terminate the buffer.
-    char *buf = new char[len + 1];
-    const ssize_t readIntoBuf = read(rpipe, buf, len);
-    if (readIntoBuf <= 0) {
-        std::cerr << "#### ThreadExecutor::handleRead error, type was:" << type << std::endl;
-        std::exit(0);
+    if (len <= 0 || ret == -1) {
+        // The child has exited
+        _readBuffers.erase(rpipe);
+        return -1;
     }
-    buf[readIntoBuf] = 0;
+    return ret;
+}
 
+int ThreadExecutor::handleMessage(char type, const char *data, std::size_t len, unsigned int &result)
+{
     if (type == REPORT_OUT) {
-        _errorLogger.reportOut(buf);
+        _errorLogger.reportOut(std::string(data, len));
     } else if (type == REPORT_ERROR || type == REPORT_INFO) {
         ErrorLogger::ErrorMessage msg;
-        msg.deserialize(buf);
+        if (!msg.deserializeBinary(data, len)) {
+            std::cerr << "#### ThreadExecutor::handleRead error, invalid message" << std::endl;
+            std::exit(0);
+        }
 
         if (!_settings.nomsg.isSuppressed(msg.toSuppressionsErrorMessage())) {
             // Alert only about unique errors
-            std::string errmsg = msg.toString(_settings.verbose);
-            if (std::find(_errorList.begin(), _errorList.end(), errmsg) == _errorList.end()) {
-                _errorList.push_back(errmsg);
+            if (_errorList.insert(msg.uniqueKey(_settings.verbose)).second) {
                 if (type == REPORT_ERROR)
                     _errorLogger.reportErr(msg);
                 else
                     _errorLogger.reportInfo(msg);
             }
         }
-    } else if (type == CHILD_END) {
-        std::istringstream iss(buf);
+    } else if (type == TIMER_RESULTS) {
+        if (!CppCheck::timerResults().merge(data, len)) {
+            std::cerr << "#### ThreadExecutor::handleRead error, invalid timer results" << std::endl;
+            std::exit(0);
+        }
+    } else if (type == TRACE_EVENTS) {
+        TraceEvents::append(std::string(data, len));
+    } else if (type == CHILD_END || type == FILE_DONE) {
+        std::istringstream iss(std::string(data, len));
         unsigned int fileResult = 0;
         iss >> fileResult;
         result += fileResult;
-        delete [] buf;
-        return -1;
+        return (type == CHILD_END) ? -1 : 2;
+    } else {
+        std::cerr << "#### ThreadExecutor::handleRead error, type was:" << type << std::endl;
+        std::exit(0);
     }
 
-    delete [] buf;
     return 1;
 }
 
@@ -162,6 +297,85 @@ bool ThreadExecutor::checkLoadAverage(size_t nchildren)
 }
 
 unsigned int ThreadExecutor::check()
+{
+    createJobs();
+
+    // Compile the rules before forking so the children don't compile them for each file
+    CppCheck::compileRules(_settings);
+
+    const unsigned int result = _settings.workerPool ? checkWorkerPool() : checkForkPerFile();
+    writeTimings();
+    return result;
+}
+
+unsigned int ThreadExecutor::checkJob(CppCheck &fileChecker, const Job &job)
+{
+    if (job.fileSettings)
+        return fileChecker.check(*job.fileSettings);
+
+    const std::map<std::string, std::string>::const_iterator fileContent = _fileContents.find(*job.file);
+    if (fileContent != _fileContents.end()) {
+        // File content was given as a string
+        return fileChecker.check(*job.file, fileContent->second);
+    }
+
+    // Read file from a file
+    return fileChecker.check(*job.file);
+}
+
+static void createPipe(int pipes[2])
+{
+    if (pipe(pipes) == -1) {
+        std::cerr << "#### ThreadExecutor::check, pipe() failed: "<< std::strerror(errno) << std::endl;
+        std::exit(EXIT_FAILURE);
+    }
+}
+
+/** The parent polls the read ends of the result pipes with select() */
+static void setNonBlocking(int fd)
+{
+    int flags = 0;
+    if ((flags = fcntl(fd, F_GETFL, 0)) < 0) {
+        std::cerr << "#### ThreadExecutor::check, fcntl(F_GETFL) failed: "<< std::strerror(errno) << std::endl;
+        std::exit(EXIT_FAILURE);
+    }
+
+    if (fcntl(fd, F_SETFL, flags | O_NONBLOCK) < 0) {
+        std::cerr << "#### ThreadExecutor::check, fcntl(F_SETFL) failed: "<< std::strerror(errno) << std::endl;
+        std::exit(EXIT_FAILURE);
+    }
+}
+
+static pid_t forkChild()
+{
+    const pid_t pid = fork();
+    if (pid < 0) {
+        // Error
+        std::cerr << "#### ThreadExecutor::check, Failed to create child process: "<< std::strerror(errno) << std::endl;
+        std::exit(EXIT_FAILURE);
+    }
+    return pid;
+}
+
+void ThreadExecutor::reportChildCrash(const std::string &childname, int stat)
+{
+    std::ostringstream oss;
+    oss << "Internal error: Child process crashed with signal " << WTERMSIG(stat);
+
+    std::list<ErrorLogger::ErrorMessage::FileLocation> locations;
+    locations.emplace_back(childname, 0);
+    const ErrorLogger::ErrorMessage errmsg(locations,
+                                           emptyString,
+                                           Severity::error,
+                                           oss.str(),
+                                           "cppcheckError",
+                                           false);
+
+    if (!_settings.nomsg.isSuppressed(errmsg.toSuppressionsErrorMessage()))
+        _errorLogger.reportErr(errmsg);
+}
+
+unsigned int ThreadExecutor::checkForkPerFile()
 {
     _fileCount = 0;
     unsigned int result = 0;
@@ -173,54 +387,33 @@ unsigned int ThreadExecutor::check()
 
     std::list<int> rpipes;
     std::map<pid_t, std::string> childFile;
-    std::map<int, std::string> pipeFile;
+    std::map<int, std::size_t> pipeFile;
+    std::map<int, std::chrono::steady_clock::time_point> pipeStart;
     std::size_t processedsize = 0;
-    std::map<std::string, std::size_t>::const_iterator iFile = _files.begin();
-    std::list<ImportProject::FileSettings>::const_iterator iFileSettings = _settings.project.fileSettings.begin();
+    std::size_t nextJob = 0;
     for (;;) {
         // Start a new child
         size_t nchildren = rpipes.size();
-        if ((iFile != _files.end() || iFileSettings != _settings.project.fileSettings.end()) && nchildren < _settings.jobs && checkLoadAverage(nchildren)) {
+        if (nextJob < _jobs.size() && nchildren < _settings.jobs && checkLoadAverage(nchildren)) {
             int pipes[2];
-            if (pipe(pipes) == -1) {
-                std::cerr << "#### ThreadExecutor::check, pipe() failed: "<< std::strerror(errno) << std::endl;
-                std::exit(EXIT_FAILURE);
-            }
+            createPipe(pipes);
+            setNonBlocking(pipes[0]);
 
-            int flags = 0;
-            if ((flags = fcntl(pipes[0], F_GETFL, 0)) < 0) {
-                std::cerr << "#### ThreadExecutor::check, fcntl(F_GETFL) failed: "<< std::strerror(errno) << std::endl;
-                std::exit(EXIT_FAILURE);
-            }
-
-            if (fcntl(pipes[0], F_SETFL, flags | O_NONBLOCK) < 0) {
-                std::cerr << "#### ThreadExecutor::check, fcntl(F_SETFL) failed: "<< std::strerror(errno) << std::endl;
-                std::exit(EXIT_FAILURE);
-            }
-
-            pid_t pid = fork();
-            if (pid < 0) {
-                // Error
-                std::cerr << "#### ThreadExecutor::check, Failed to create child process: "<< std::strerror(errno) << std::endl;
-                std::exit(EXIT_FAILURE);
-            } else if (pid == 0) {
+            const pid_t pid = forkChild();
+            if (pid == 0) {
                 close(pipes[0]);
                 _wpipe = pipes[1];
+                flushPipeOnCrash(_wpipe, _pipeBuffer);
+                sendTraceEvents();
+
+                // The results that the parent has merged so far are not sent back
+                CppCheck::timerResults().clear();
 
                 CppCheck fileChecker(*this, false);
                 fileChecker.settings() = _settings;
-                unsigned int resultOfCheck = 0;
-
-                if (iFileSettings != _settings.project.fileSettings.end()) {
-                    resultOfCheck = fileChecker.check(*iFileSettings);
-                } else if (!_fileContents.empty() && _fileContents.find(iFile->first) != _fileContents.end()) {
-                    // File content was given as a string
-                    resultOfCheck = fileChecker.check(iFile->first, _fileContents[ iFile->first ]);
-                } else {
-                    // Read file from a file
-                    resultOfCheck = fileChecker.check(iFile->first);
-                }
+                const unsigned int resultOfCheck = checkJob(fileChecker, _jobs[nextJob]);
 
+                writeTimerResults();
                 std::ostringstream oss;
                 oss << resultOfCheck;
                 writeToPipe(CHILD_END, oss.str());
@@ -229,15 +422,10 @@ unsigned int ThreadExecutor::check()
 
             close(pipes[1]);
             rpipes.push_back(pipes[0]);
-            if (iFileSettings != _settings.project.fileSettings.end()) {
-                childFile[pid] = iFileSettings->filename + ' ' + iFileSettings->cfg;
-                pipeFile[pipes[0]] = iFileSettings->filename + ' ' + iFileSettings->cfg;
-                ++iFileSettings;
-            } else {
-                childFile[pid] = iFile->first;
-                pipeFile[pipes[0]] = iFile->first;
-                ++iFile;
-            }
+            childFile[pid] = _jobs[nextJob].name();
+            pipeFile[pipes[0]] = nextJob;
+            pipeStart[pipes[0]] = std::chrono::steady_clock::now();
+            ++nextJob;
         } else if (!rpipes.empty()) {
             fd_set rfds;
             FD_ZERO(&rfds);
@@ -255,20 +443,22 @@ unsigned int ThreadExecutor::check()
                         int readRes = handleRead(*rp, result);
                         if (readRes == -1) {
                             std::size_t size = 0;
-                            std::map<int, std::string>::iterator p = pipeFile.find(*rp);
+                            std::map<int, std::size_t>::iterator p = pipeFile.find(*rp);
                             if (p != pipeFile.end()) {
-                                std::string name = p->second;
-                                pipeFile.erase(p);
-                                std::map<std::string, std::size_t>::const_iterator fs = _files.find(name);
-                                if (fs != _files.end()) {
-                                    size = fs->second;
+                                size = _jobs[p->second].size;
+                                const std::map<int, std::chrono::steady_clock::time_point>::iterator start = pipeStart.find(*rp);
+                                if (start != pipeStart.end()) {
+                                    const std::chrono::duration<double> elapsed = std::chrono::steady_clock::now() - start->second;
+                                    _timings[_jobs[p->second].name()] = elapsed.count();
+                                    pipeStart.erase(start);
                                 }
+                                pipeFile.erase(p);
                             }
 
                             _fileCount++;
                             processedsize += size;
                             if (!_settings.quiet)
-                                CppCheckExecutor::reportStatus(_fileCount, _files.size() + _settings.project.fileSettings.size(), processedsize, totalfilesize);
+                                CppCheckExecutor::reportStatus(_fileCount, _jobs.size(), processedsize, totalfilesize);
 
                             close(*rp);
                             rp = rpipes.erase(rp);
@@ -289,22 +479,198 @@ unsigned int ThreadExecutor::check()
                     childFile.erase(c);
                 }
 
-                if (WIFSIGNALED(stat)) {
-                    std::ostringstream oss;
-                    oss << "Internal error: Child process crashed with signal " << WTERMSIG(stat);
-
-                    std::list<ErrorLogger::ErrorMessage::FileLocation> locations;
-                    locations.emplace_back(childname, 0);
-                    const ErrorLogger::ErrorMessage errmsg(locations,
-                                                           emptyString,
-                                                           Severity::error,
-                                                           oss.str(),
-                                                           "cppcheckError",
-                                                           false);
-
-                    if (!_settings.nomsg.isSuppressed(errmsg.toSuppressionsErrorMessage()))
-                        _errorLogger.reportErr(errmsg);
+                if (WIFSIGNALED(stat))
+                    reportChildCrash(childname, stat);
+            }
+        } else {
+            // All done
+            break;
+        }
+    }
+
+
+    return result;
+}
+
+namespace {
+    /** @brief Parent side bookkeeping of a --worker-pool process */
+    struct Worker {
+        Worker() : pid(0), rpipe(-1), wpipe(-1), job(NO_JOB), files(0), size(0), busy(0) {}
+
+        static const std::size_t NO_JOB = ~static_cast<std::size_t>(0);
+
+        pid_t pid;
+        int rpipe;          // results from the worker
+        int wpipe;          // job indexes to the worker
+        std::size_t job;    // job that is being checked, or NO_JOB
+        std::chrono::steady_clock::time_point jobStart;
+        std::size_t files;  // number of checked files
+        std::size_t size;   // total size of checked files
+        double busy;        // seconds spent checking files
+    };
+
+    const std::size_t Worker::NO_JOB;
+}
+
+/** Job index that tells a worker to exit */
+static const unsigned int STOP_WORKER = ~0U;
+
+static void sendJob(int wpipe, unsigned int job)
+{
+    if (write(wpipe, &job, sizeof(job)) != sizeof(job)) {
+        std::cerr << "#### ThreadExecutor::sendJob, Failed to write to pipe: " << std::strerror(errno) << std::endl;
+        std::exit(EXIT_FAILURE);
+    }
+}
+
+void ThreadExecutor::runWorker(int rpipe)
+{
+    CppCheck::timerResults().clear();
+    CppCheck fileChecker(*this, false);
+    fileChecker.settings() = _settings;
+
+    for (;;) {
+        unsigned int job = STOP_WORKER;
+        ssize_t len;
+        do {
+            len = read(rpipe, &job, sizeof(job));
+        } while (len < 0 && errno == EINTR);
+        if (len != sizeof(job) || job >= _jobs.size())
+            break;
+
+        const unsigned int resultOfCheck = checkJob(fileChecker, _jobs[job]);
+        fileChecker.clearFileInfo();
+
+        writeTimerResults();
+        std::ostringstream oss;
+        oss << resultOfCheck;
+        writeToPipe(FILE_DONE, oss.str());
+    }
+    std::exit(0);
+}
+
+unsigned int ThreadExecutor::checkWorkerPool()
+{
+    _fileCount = 0;
+    unsigned int result = 0;
+
+    std::size_t totalfilesize = 0;
+    for (std::map<std::string, std::size_t>::const_iterator i = _files.begin(); i != _files.end(); ++i) {
+        totalfilesize += i->second;
+    }
+
+    std::list<Worker> workers;
+    std::list<Worker> stoppedWorkers;
+    std::map<pid_t, std::string> childFile;
+    std::size_t processedsize = 0;
+    std::size_t nextJob = 0;
+
+    for (;;) {
+        // Start a new worker, as long as there are jobs that no worker is waiting for
+        const size_t nworkers = workers.size();
+        if (nextJob < _jobs.size() && nworkers < _settings.jobs && checkLoadAverage(nworkers)) {
+            int resultPipes[2];
+            createPipe(resultPipes);
+            setNonBlocking(resultPipes[0]);
+            int jobPipes[2];
+            createPipe(jobPipes);
+
+            const pid_t pid = forkChild();
+            if (pid == 0) {
+                close(resultPipes[0]);
+                close(jobPipes[1]);
+                for (const Worker &w : workers) {
+                    close(w.rpipe);
+                    close(w.wpipe);
                 }
+                _wpipe = resultPipes[1];
+                flushPipeOnCrash(_wpipe, _pipeBuffer);
+                sendTraceEvents();
+                runWorker(jobPipes[0]);
+            }
+
+            close(resultPipes[1]);
+            close(jobPipes[0]);
+            workers.emplace_back();
+            Worker &worker = workers.back();
+            worker.pid = pid;
+            worker.rpipe = resultPipes[0];
+            worker.wpipe = jobPipes[1];
+            worker.job = nextJob++;
+            worker.jobStart = std::chrono::steady_clock::now();
+            childFile[pid] = _jobs[worker.job].name();
+            sendJob(worker.wpipe, static_cast<unsigned int>(worker.job));
+        } else if (!workers.empty()) {
+            fd_set rfds;
+            FD_ZERO(&rfds);
+            int maxfd = 0;
+            for (const Worker &w : workers) {
+                FD_SET(w.rpipe, &rfds);
+                maxfd = std::max(maxfd, w.rpipe);
+            }
+            struct timeval tv; // for every second polling of load average condition
+            tv.tv_sec = 1;
+            tv.tv_usec = 0;
+            int r = select(maxfd + 1, &rfds, nullptr, nullptr, &tv);
+
+            if (r > 0) {
+                std::list<Worker>::iterator w = workers.begin();
+                while (w != workers.end()) {
+                    if (!FD_ISSET(w->rpipe, &rfds)) {
+                        ++w;
+                        continue;
+                    }
+                    const int readRes = handleRead(w->rpipe, result);
+                    if (readRes == 1 || readRes == 0) {
+                        ++w;
+                        continue;
+                    }
+
+                    // The worker is done with its file (2), or it has exited (-1)
+                    if (w->job != Worker::NO_JOB) {
+                        const std::chrono::duration<double> elapsed = std::chrono::steady_clock::now() - w->jobStart;
+                        w->busy += elapsed.count();
+                        _timings[_jobs[w->job].name()] = elapsed.count();
+                        w->files++;
+                        w->size += _jobs[w->job].size;
+                        _fileCount++;
+                        processedsize += _jobs[w->job].size;
+                        if (!_settings.quiet)
+                            CppCheckExecutor::reportStatus(_fileCount, _jobs.size(), processedsize, totalfilesize);
+                        w->job = Worker::NO_JOB;
+                    }
+
+                    if (readRes == 2) {
+                        if (nextJob < _jobs.size()) {
+                            w->job = nextJob++;
+                            w->jobStart = std::chrono::steady_clock::now();
+                            childFile[w->pid] = _jobs[w->job].name();
+                            sendJob(w->wpipe, static_cast<unsigned int>(w->job));
+                        } else {
+                            sendJob(w->wpipe, STOP_WORKER);
+                        }
+                        ++w;
+                    } else {
+                        close(w->rpipe);
+                        close(w->wpipe);
+                        stoppedWorkers.push_back(*w);
+                        w = workers.erase(w);
+                    }
+                }
+            }
+
+            int stat = 0;
+            pid_t child = waitpid(0, &stat, WNOHANG);
+            if (child > 0) {
+                std::string childname;
+                std::map<pid_t, std::string>::iterator c = childFile.find(child);
+                if (c != childFile.end()) {
+                    childname = c->second;
+                    childFile.erase(c);
+                }
+
+                if (WIFSIGNALED(stat))
+                    reportChildCrash(childname, stat);
             }
         } else {
             // All done
@@ -312,25 +678,79 @@ unsigned int ThreadExecutor::check()
         }
     }
 
+    if (_settings.showtime != SHOWTIME_NONE && _settings.showtime != SHOWTIME_JSON) {
+        std::cout << std::endl;
+        unsigned int nr = 0;
+        for (const Worker &w : stoppedWorkers) {
+            std::cout << "Worker " << ++nr << ": " << w.files << " file(s), " << w.size << " bytes in " << w.busy << "s";
+            if (w.busy > 0)
+                std::cout << " (" << (static_cast<double>(w.files) / w.busy) << " files/s, " << (static_cast<double>(w.size) / w.busy) << " bytes/s)";
+            std::cout << std::endl;
+        }
+    }
 
     return result;
 }
 
-void ThreadExecutor::writeToPipe(PipeSignal type, const std::string &data)
+std::size_t ThreadExecutor::beginFrame(PipeSignal type)
 {
-    unsigned int len = static_cast<unsigned int>(data.length() + 1);
-    char *out = new char[ len + 1 + sizeof(len)];
-    out[0] = static_cast<char>(type);
-    std::memcpy(&(out[1]), &len, sizeof(len));
-    std::memcpy(&(out[1+sizeof(len)]), data.c_str(), len);
-    if (write(_wpipe, out, len + 1 + sizeof(len)) <= 0) {
-        delete [] out;
-        out = nullptr;
-        std::cerr << "#### ThreadExecutor::writeToPipe, Failed to write to pipe" << std::endl;
-        std::exit(0);
+    const std::size_t start = _pipeBuffer.size();
+    _pipeBuffer += static_cast<char>(type);
+    _pipeBuffer.append(sizeof(unsigned int), '\0');
+    return start;
+}
+
+void ThreadExecutor::endFrame(PipeSignal type, std::size_t start)
+{
+    const unsigned int len = static_cast<unsigned int>(_pipeBuffer.size() - start - FRAME_HEADER_SIZE);
+    std::memcpy(&_pipeBuffer[start + 1], &len, sizeof(len));
+    crashBufferSize = _pipeBuffer.size();
+
+    // Batch diagnostics, everything else is sent right away
+    if ((type != REPORT_ERROR && type != REPORT_INFO) || _pipeBuffer.size() >= PIPE_BUFFER_SIZE)
+        flushPipe();
+}
+
+void ThreadExecutor::flushPipe()
+{
+    crashBufferSize = 0;
+    std::size_t written = 0;
+    while (written < _pipeBuffer.size()) {
+        const ssize_t len = write(_wpipe, _pipeBuffer.data() + written, _pipeBuffer.size() - written);
+        if (len < 0 && errno == EINTR)
+            continue;
+        if (len <= 0) {
+            std::cerr << "#### ThreadExecutor::writeToPipe, Failed to write to pipe" << std::endl;
+            std::exit(0);
+        }
+        written += len;
     }
+    _pipeBuffer.clear();
+}
+
+void ThreadExecutor::sendTraceEvents()
+{
+    if (!TraceEvents::enabled())
+        return;
+    TraceEvents::setWriter([this](const std::string &events) {
+        writeToPipe(TRACE_EVENTS, events);
+    });
+}
+
+void ThreadExecutor::writeTimerResults()
+{
+    TraceEvents::flush();
+    if (_settings.showtime == SHOWTIME_NONE || _settings.showtime == SHOWTIME_FILE)
+        return;
+    writeToPipe(TIMER_RESULTS, CppCheck::timerResults().serialize());
+    CppCheck::timerResults().clear();
+}
 
-    delete [] out;
+void ThreadExecutor::writeToPipe(PipeSignal type, const std::string &data)
+{
+    const std::size_t start = beginFrame(type);
+    _pipeBuffer += data;
+    endFrame(type, start);
 }
 
 void ThreadExecutor::reportOut(const std::string &outmsg)
@@ -340,12 +760,16 @@ void ThreadExecutor::reportOut(const std::string &outmsg)
 
 void ThreadExecutor::reportErr(const ErrorLogger::ErrorMessage &msg)
 {
-    writeToPipe(REPORT_ERROR, msg.serialize());
+    const std::size_t start = beginFrame(REPORT_ERROR);
+    msg.serializeBinary(_pipeBuffer);
+    endFrame(REPORT_ERROR, start);
 }
 
 void ThreadExecutor::reportInfo(const ErrorLogger::ErrorMessage &msg)
 {
-    writeToPipe(REPORT_INFO, msg.serialize());
+    const std::size_t start = beginFrame(REPORT_INFO);
+    msg.serializeBinary(_pipeBuffer);
+    endFrame(REPORT_INFO, start);
 }
 
 #elif defined(THREADING_MODEL_WIN)
@@ -359,12 +783,15 @@ unsigned int ThreadExecutor::check()
 {
     HANDLE *threadHandles = new HANDLE[_settings.jobs];
 
-    _itNextFile = _files.begin();
-    _itNextFileSettings = _settings.project.fileSettings.begin();
+    createJobs();
+    _nextJob = 0;
+
+    // Compile the rules once, the threads share them
+    CppCheck::compileRules(_settings);
 
     _processedFiles = 0;
     _processedSize = 0;
-    _totalFiles = _files.size() + _settings.project.fileSettings.size();
+    _totalFiles = _jobs.size();
     _totalFileSize = 0;
     for (std::map<std::string, std::size_t>::const_iterator i = _files.begin(); i != _files.end(); ++i) {
         _totalFileSize += i->second;
@@ -416,6 +843,8 @@ unsigned int ThreadExecutor::check()
 
     delete[] threadHandles;
 
+    writeTimings();
+
     return result;
 }
 
@@ -424,8 +853,6 @@ unsigned int __stdcall ThreadExecutor::threadProc(void *args)
     unsigned int result = 0;
 
     ThreadExecutor *threadExecutor = static_cast<ThreadExecutor*>(args);
-    std::map<std::string, std::size_t>::const_iterator &itFile = threadExecutor->_itNextFile;
-    std::list<ImportProject::FileSettings>::const_iterator &itFileSettings = threadExecutor->_itNextFileSettings;
 
     // guard static members of CppCheck against concurrent access
     EnterCriticalSection(&threadExecutor->_fileSync);
@@ -434,36 +861,35 @@ unsigned int __stdcall ThreadExecutor::threadProc(void *args)
     fileChecker.settings() = threadExecutor->_settings;
 
     for (;;) {
-        if (itFile == threadExecutor->_files.end() && itFileSettings == threadExecutor->_settings.project.fileSettings.end()) {
+        // The jobs are sorted by cost, each idle thread takes the next one
+        if (threadExecutor->_nextJob >= threadExecutor->_jobs.size()) {
             LeaveCriticalSection(&threadExecutor->_fileSync);
             break;
         }
 
-        std::size_t fileSize = 0;
-        if (itFile != threadExecutor->_files.end()) {
-            const std::string &file = itFile->first;
-            fileSize = itFile->second;
-            ++itFile;
+        const Job &job = threadExecutor->_jobs[threadExecutor->_nextJob++];
+        const std::size_t fileSize = job.size;
 
-            LeaveCriticalSection(&threadExecutor->_fileSync);
+        LeaveCriticalSection(&threadExecutor->_fileSync);
 
-            const std::map<std::string, std::string>::const_iterator fileContent = threadExecutor->_fileContents.find(file);
+        const std::chrono::steady_clock::time_point start = std::chrono::steady_clock::now();
+        if (job.fileSettings) {
+            result += fileChecker.check(*job.fileSettings);
+        } else {
+            const std::map<std::string, std::string>::const_iterator fileContent = threadExecutor->_fileContents.find(*job.file);
             if (fileContent != threadExecutor->_fileContents.end()) {
                 // File content was given as a string
-                result += fileChecker.check(file, fileContent->second);
+                result += fileChecker.check(*job.file, fileContent->second);
             } else {
                 // Read file from a file
-                result += fileChecker.check(file);
+                result += fileChecker.check(*job.file);
             }
-        } else { // file settings..
-            const ImportProject::FileSettings &fs = *itFileSettings;
-            ++itFileSettings;
-            LeaveCriticalSection(&threadExecutor->_fileSync);
-            result += fileChecker.check(fs);
         }
+        const std::chrono::duration<double> elapsed = std::chrono::steady_clock::now() - start;
 
         EnterCriticalSection(&threadExecutor->_fileSync);
 
+        threadExecutor->_timings[job.name()] = elapsed.count();
         threadExecutor->_processedSize += fileSize;
         threadExecutor->_processedFiles++;
         if (!threadExecutor->_settings.quiet) {
@@ -499,14 +925,10 @@ void ThreadExecutor::report(const ErrorLogger::ErrorMessage &msg, MessageType ms
         return;
 
     // Alert only about unique errors
-    bool reportError = false;
-    const std::string errmsg = msg.toString(_settings.verbose);
+    std::string errmsg = msg.uniqueKey(_settings.verbose);
 
     EnterCriticalSection(&_errorSync);
-    if (std::find(_errorList.begin(), _errorList.end(), errmsg) == _errorList.end()) {
-        _errorList.push_back(errmsg);
-        reportError = true;
-    }
+    const bool reportError = _errorList.insert(std::move(errmsg)).second;
     LeaveCriticalSection(&_errorSync);
 
     if (reportError) {
@@ -26,6 +26,8 @@
 #include <list>
 #include <map>
 #include <string>
+#include <unordered_set>
+#include <vector>
 
 #if (defined(__GNUC__) || defined(__sun)) && !defined(__MINGW32__) && !defined(__CYGWIN__)
 #define THREADING_MODEL_FORK
@@ -34,6 +36,7 @@
 #include <windows.h>
 #endif
 
+class CppCheck;
 class Settings;
 
 /// @addtogroup CLI
@@ -44,6 +47,7 @@ class Settings;
  * all files using threads.
  */
 class ThreadExecutor : public ErrorLogger {
+    friend class TestThreadExecutor; // For testing only
 public:
     ThreadExecutor(const std::map<std::string, std::size_t> &files, Settings &settings, ErrorLogger &errorLogger);
     virtual ~ThreadExecutor();
@@ -68,26 +72,114 @@ private:
     ErrorLogger &_errorLogger;
     unsigned int _fileCount;
 
+    /** @brief A source file, or project file settings, to be checked */
+    struct Job {
+        Job(const std::string &filename, std::size_t filesize)
+            : file(&filename), fileSettings(nullptr), size(filesize), cost(0) {
+        }
+        explicit Job(const ImportProject::FileSettings &fs)
+            : file(&fs.filename), fileSettings(&fs), size(0), cost(0) {
+        }
+
+        /** @brief name of the job, used in status and crash reports */
+        std::string name() const;
+
+        const std::string *file;
+        const ImportProject::FileSettings *fileSettings;
+        std::size_t size;
+
+        /** @brief predicted check time, jobs with the highest cost are started first */
+        double cost;
+    };
+
+    /** @brief All jobs, in the order they are handed out */
+    std::vector<Job> _jobs;
+
+    /**
+     * @brief Fill _jobs from the files and the project file settings.
+     * The jobs are sorted by predicted cost, so that the expensive
+     * files are started first and idle workers pick up the cheap ones
+     * at the end of the run.
+     */
+    void createJobs();
+
+    /** @brief Time in seconds it took to check each job, saved in the --cppcheck-build-dir */
+    std::map<std::string, double> _timings;
+
+    /** @brief Write _timings to the build dir so the next run can schedule by them */
+    void writeTimings();
+
 #if defined(THREADING_MODEL_FORK)
 
     /** @brief Key is file name, and value is the content of the file */
     std::map<std::string, std::string> _fileContents;
 private:
-    enum PipeSignal {REPORT_OUT='1',REPORT_ERROR='2', REPORT_INFO='3', CHILD_END='4'};
+    enum PipeSignal {REPORT_OUT='1',REPORT_ERROR='2', REPORT_INFO='3', CHILD_END='4', FILE_DONE='5', TIMER_RESULTS='6', TRACE_EVENTS='7'};
 
     /**
-     * Read from the pipe, parse and handle what ever is in there.
-     *@return -1 in case of error
+     * Read from the pipe, parse and handle the complete frames in there.
+     *@return -1 in case of error, or if the child has exited
      *         0 if there is nothing in the pipe to be read
      *         1 if we did read something
+     *         2 if a worker has finished its file and waits for another one
      */
     int handleRead(int rpipe, unsigned int &result);
+
+    /** Handle one frame read from a child. Returns like handleRead() */
+    int handleMessage(char type, const char *data, std::size_t len, unsigned int &result);
+
+    /** Add a frame to the pipe buffer of the child */
     void writeToPipe(PipeSignal type, const std::string &data);
+
+    /** Start a frame in _pipeBuffer, the payload is appended by the caller. Returns the start position */
+    std::size_t beginFrame(PipeSignal type);
+
+    /** Finish a frame started by beginFrame(), and flush the buffer if needed */
+    void endFrame(PipeSignal type, std::size_t start);
+
+    /** Write _pipeBuffer to the pipe */
+    void flushPipe();
+
+    /** Send the --trace events of the child to the parent after each checked file */
+    void sendTraceEvents();
+
+    /** Send the --showtime results and the --trace events of the child to the parent, that merges them with its own */
+    void writeTimerResults();
+
+    /**
+     * Frames that are not yet written to the pipe.
+     * Diagnostics are batched, other frames are written right away.
+     * Not used in master process.
+     */
+    std::string _pipeBuffer;
+
+    /** Data read from each child that is not yet a complete frame */
+    std::map<int, std::string> _readBuffers;
+
+    /** @brief Check a job in the current (child) process */
+    unsigned int checkJob(CppCheck &fileChecker, const Job &job);
+
+    /** @brief Fork one child process per file */
+    unsigned int checkForkPerFile();
+
+    /**
+     * @brief Start --worker-pool processes that each check many files.
+     * Files are handed out one at a time to idle workers.
+     */
+    unsigned int checkWorkerPool();
+
+    /** @brief Read job indexes from rpipe and check them, until told to stop. Never returns. */
+    void runWorker(int rpipe);
+
+    /** @brief Report that the child process checking childname was killed by a signal */
+    void reportChildCrash(const std::string &childname, int stat);
+    /** Keys of the reported errors, see ErrorLogger::ErrorMessage::uniqueKey() */
+    std::unordered_set<std::string> _errorList;
+
     /**
      * Write end of status pipe, different for each child.
      * Not used in master process.
      */
-    std::list<std::string> _errorList;
     int _wpipe;
 
     /**
@@ -111,15 +203,14 @@ private:
     enum MessageType {REPORT_ERROR, REPORT_INFO};
 
     std::map<std::string, std::string> _fileContents;
-    std::map<std::string, std::size_t>::const_iterator _itNextFile;
-    std::list<ImportProject::FileSettings>::const_iterator _itNextFileSettings;
+    std::size_t _nextJob;
     std::size_t _processedFiles;
     std::size_t _totalFiles;
     std::size_t _processedSize;
     std::size_t _totalFileSize;
     CRITICAL_SECTION _fileSync;
 
-    std::list<std::string> _errorList;
+    std::unordered_set<std::string> _errorList;
     CRITICAL_SECTION _errorSync;
 
     CRITICAL_SECTION _reportSync;
@@ -23,6 +23,7 @@
 #include "simplecpp.h"
 
 #include <algorithm>
+#include <cstdio>
 #include <cstdlib>
 #include <cstring>
 #include <exception>
@@ -290,7 +291,8 @@ std::string simplecpp::TokenList::stringify() const
     return ret.str();
 }
 
-static unsigned char readChar(std::istream &istr, unsigned int bom)
+template<class Stream>
+static unsigned char readChar(Stream &istr, unsigned int bom)
 {
     unsigned char ch = (unsigned char)istr.get();
 
@@ -321,7 +323,8 @@ static unsigned char readChar(std::istream &istr, unsigned int bom)
     return ch;
 }
 
-static unsigned char peekChar(std::istream &istr, unsigned int bom)
+template<class Stream>
+static unsigned char peekChar(Stream &istr, unsigned int bom)
 {
     unsigned char ch = (unsigned char)istr.peek();
 
@@ -342,14 +345,64 @@ static unsigned char peekChar(std::istream &istr, unsigned int bom)
     return ch;
 }
 
-static void ungetChar(std::istream &istr, unsigned int bom)
+template<class Stream>
+static void ungetChar(Stream &istr, unsigned int bom)
 {
     istr.unget();
     if (bom == 0xfeff || bom == 0xfffe)
         istr.unget();
 }
 
-static unsigned short getAndSkipBOM(std::istream &istr)
+/**
+ * Read-only stream over a buffer in memory. It has the get/peek/unget/good
+ * semantics of std::istream, without the overhead of a sentry per character.
+ */
+class MemoryStream {
+public:
+    MemoryStream(const char *data, std::size_t size) : mData(data), mSize(size), mPos(0), mEof(false), mFail(false) {}
+
+    int get() {
+        if (!good() || mPos >= mSize) {
+            mEof = mFail = true;
+            return EOF;
+        }
+        return (unsigned char)mData[mPos++];
+    }
+
+    int peek() {
+        if (!good()) {
+            mFail = true;
+            return EOF;
+        }
+        if (mPos >= mSize) {
+            mEof = true;
+            return EOF;
+        }
+        return (unsigned char)mData[mPos];
+    }
+
+    void unget() {
+        mEof = false;
+        if (mFail || mPos == 0)
+            mFail = true;
+        else
+            --mPos;
+    }
+
+    bool good() const {
+        return !mEof && !mFail;
+    }
+
+private:
+    const char * const mData;
+    const std::size_t mSize;
+    std::size_t mPos;
+    bool mEof;
+    bool mFail;
+};
+
+template<class Stream>
+static unsigned short getAndSkipBOM(Stream &istr)
 {
     const int ch1 = istr.peek();
 
@@ -430,6 +483,39 @@ void simplecpp::TokenList::lineDirective(unsigned int fileIndex, unsigned int li
 }
 
 void simplecpp::TokenList::readfile(std::istream &istr, const std::string &filename, OutputList *outputList)
+{
+    const unsigned short bom = getAndSkipBOM(istr);
+
+    // UTF-16 files are read character by character. Other files are read
+    // into one buffer and tokenized from memory, which is much faster.
+    if (bom != 0) {
+        readfile(istr, filename, outputList, bom);
+        return;
+    }
+
+    std::string data;
+    char buffer[65536];
+    while (istr.read(buffer, sizeof(buffer)) || istr.gcount() > 0)
+        data.append(buffer, static_cast<std::size_t>(istr.gcount()));
+    MemoryStream stream(data.data(), data.size());
+    readfile(stream, filename, outputList, bom);
+}
+
+simplecpp::TokenList::TokenList(const char *data, std::size_t size, std::vector<std::string> &filenames, const std::string &filename, OutputList *outputList)
+    : frontToken(NULL), backToken(NULL), files(filenames)
+{
+    readfile(data, size, filename, outputList);
+}
+
+void simplecpp::TokenList::readfile(const char *data, std::size_t size, const std::string &filename, OutputList *outputList)
+{
+    MemoryStream stream(data, size);
+    const unsigned short bom = getAndSkipBOM(stream);
+    readfile(stream, filename, outputList, bom);
+}
+
+template<class Stream>
+void simplecpp::TokenList::readfile(Stream &istr, const std::string &filename, OutputList *outputList, unsigned short bom)
 {
     std::stack<simplecpp::Location> loc;
 
@@ -437,8 +523,6 @@ void simplecpp::TokenList::readfile(std::istream &istr, const std::string &filen
 
     const Token *oldLastToken = NULL;
 
-    const unsigned short bom = getAndSkipBOM(istr);
-
     Location location(files);
     location.fileIndex = fileIndex(filename);
     location.line = 1U;
@@ -1101,7 +1185,8 @@ void simplecpp::TokenList::removeComments()
     }
 }
 
-std::string simplecpp::TokenList::readUntil(std::istream &istr, const Location &location, const char start, const char end, OutputList *outputList, unsigned int bom)
+template<class Stream>
+std::string simplecpp::TokenList::readUntil(Stream &istr, const Location &location, const char start, const char end, OutputList *outputList, unsigned int bom)
 {
     std::string ret;
     ret += start;
@@ -2388,7 +2473,152 @@ static bool hasFile(const std::map<std::string, simplecpp::TokenList *> &filedat
     return !getFileName(filedata, sourcefile, header, dui, systemheader).empty();
 }
 
-std::map<std::string, simplecpp::TokenList*> simplecpp::load(const simplecpp::TokenList &rawtokens, std::vector<std::string> &fileNumbers, const simplecpp::DUI &dui, simplecpp::OutputList *outputList)
+simplecpp::FileCache::~FileCache()
+{
+    clear();
+}
+
+void simplecpp::FileCache::clear()
+{
+    lock();
+    while (!entries.empty())
+        remove(entries.begin());
+    unlock();
+}
+
+std::size_t simplecpp::FileCache::size() const
+{
+    lock();
+    const std::size_t ret = entries.size();
+    unlock();
+    return ret;
+}
+
+void simplecpp::FileCache::remove(std::map<std::string, Entry *>::iterator it)
+{
+    Entry *entry = it->second;
+    entries.erase(it);
+    tokenCount -= entry->tokenCount;
+    entry->cached = false;
+    if (entry->users == 0)
+        delete entry;
+}
+
+void simplecpp::FileCache::release(Entry *entry)
+{
+    if (--entry->users == 0 && !entry->cached)
+        delete entry;
+}
+
+void simplecpp::FileCache::insert(const std::string &filename, Entry *entry)
+{
+    const std::map<std::string, Entry *>::iterator old = entries.find(filename);
+    if (old != entries.end())
+        remove(old);
+    if (maxTokens > 0 && entry->tokenCount > maxTokens)
+        return;
+
+    // Remove the least recently used files until the new file fits
+    while (maxTokens > 0 && tokenCount + entry->tokenCount > maxTokens) {
+        std::map<std::string, Entry *>::iterator oldest = entries.begin();
+        for (std::map<std::string, Entry *>::iterator it = entries.begin(); it != entries.end(); ++it) {
+            if (it->second->lastUse < oldest->second->lastUse)
+                oldest = it;
+        }
+        remove(oldest);
+    }
+
+    entries[filename] = entry;
+    entry->cached = true;
+    tokenCount += entry->tokenCount;
+}
+
+/** FNV-1a hash, used to detect that a cached file has been changed */
+static unsigned long long getChecksum(const std::string &data)
+{
+    unsigned long long checksum = 14695981039346656037ULL;
+    for (std::string::const_iterator it = data.begin(); it != data.end(); ++it) {
+        checksum ^= static_cast<unsigned char>(*it);
+        checksum *= 1099511628211ULL;
+    }
+    return checksum;
+}
+
+static simplecpp::Location copyLocation(const simplecpp::Location &location, std::vector<std::string> &filenames, std::vector<unsigned int> &fileIndexes)
+{
+    // Each file of the cached tokens is looked up in filenames only once
+    unsigned int &fileIndex = fileIndexes[location.fileIndex];
+    if (fileIndex == std::numeric_limits<unsigned int>::max()) {
+        fileIndex = static_cast<unsigned int>(std::find(filenames.begin(), filenames.end(), location.file()) - filenames.begin());
+        if (fileIndex == filenames.size())
+            filenames.push_back(location.file());
+    }
+
+    simplecpp::Location loc(filenames);
+    loc.fileIndex = fileIndex;
+    loc.line = location.line;
+    loc.col = location.col;
+    return loc;
+}
+
+simplecpp::TokenList *simplecpp::FileCache::get(std::istream &istr, std::vector<std::string> &filenames, const std::string &filename, OutputList *outputList)
+{
+    std::string data;
+    char buffer[65536];
+    while (istr.read(buffer, sizeof(buffer)) || istr.gcount() > 0)
+        data.append(buffer, static_cast<std::size_t>(istr.gcount()));
+    const unsigned long long checksum = getChecksum(data);
+
+    lock();
+    Entry *entry = NULL;
+    const std::map<std::string, Entry *>::const_iterator it = entries.find(filename);
+    if (it != entries.end() && it->second->size == data.size() && it->second->checksum == checksum) {
+        entry = it->second;
+        ++entry->users;
+        entry->lastUse = ++useCount;
+    }
+    unlock();
+
+    if (!entry) {
+        entry = new Entry;
+        entry->size = data.size();
+        entry->checksum = checksum;
+        entry->tokens.readfile(data.data(), data.size(), filename, &entry->outputList);
+        for (const Token *tok = entry->tokens.cfront(); tok; tok = tok->next)
+            ++entry->tokenCount;
+        entry->users = 1;
+
+        lock();
+        entry->lastUse = ++useCount;
+        insert(filename, entry);
+        unlock();
+    }
+
+    // The entry is not changed while it is used, so it is copied without the lock
+    std::vector<unsigned int> fileIndexes(entry->files.size(), std::numeric_limits<unsigned int>::max());
+
+    TokenList *tokens = new TokenList(filenames);
+    for (const Token *tok = entry->tokens.cfront(); tok; tok = tok->next)
+        tokens->push_back(new Token(tok->str(), copyLocation(tok->location, filenames, fileIndexes)));
+
+    if (outputList) {
+        for (OutputList::const_iterator output = entry->outputList.begin(); output != entry->outputList.end(); ++output) {
+            Output copy(filenames);
+            copy.type = output->type;
+            copy.location = copyLocation(output->location, filenames, fileIndexes);
+            copy.msg = output->msg;
+            outputList->push_back(copy);
+        }
+    }
+
+    lock();
+    release(entry);
+    unlock();
+
+    return tokens;
+}
+
+std::map<std::string, simplecpp::TokenList*> simplecpp::load(const simplecpp::TokenList &rawtokens, std::vector<std::string> &fileNumbers, const simplecpp::DUI &dui, simplecpp::OutputList *outputList, FileCache *cache)
 {
     std::map<std::string, simplecpp::TokenList*> ret;
 
@@ -2405,7 +2635,7 @@ std::map<std::string, simplecpp::TokenList*> simplecpp::load(const simplecpp::To
         if (!fin.is_open())
             continue;
 
-        TokenList *tokenlist = new TokenList(fin, fileNumbers, filename, outputList);
+        TokenList *tokenlist = cache ? cache->get(fin, fileNumbers, filename, outputList) : new TokenList(fin, fileNumbers, filename, outputList);
         if (!tokenlist->front()) {
             delete tokenlist;
             continue;
@@ -2445,7 +2675,7 @@ std::map<std::string, simplecpp::TokenList*> simplecpp::load(const simplecpp::To
         if (!f.is_open())
             continue;
 
-        TokenList *tokens = new TokenList(f, fileNumbers, header2, outputList);
+        TokenList *tokens = cache ? cache->get(f, fileNumbers, header2, outputList) : new TokenList(f, fileNumbers, header2, outputList);
         ret[header2] = tokens;
         if (tokens->front())
             filelist.push_back(tokens->front());
@@ -2481,7 +2711,37 @@ static bool preprocessToken(simplecpp::TokenList &output, const simplecpp::Token
     return true;
 }
 
-void simplecpp::preprocess(simplecpp::TokenList &output, const simplecpp::TokenList &rawtokens, std::vector<std::string> &files, std::map<std::string, simplecpp::TokenList *> &filedata, const simplecpp::DUI &dui, simplecpp::OutputList *outputList, std::list<simplecpp::MacroUsage> *macroUsage)
+static const char PASTED_NAMES[] = "##";
+
+/** Add the names in @p str to @p names */
+static void addNames(std::set<std::string> *names, const std::string &str)
+{
+    if (str.find(PASTED_NAMES) != std::string::npos)
+        names->insert(PASTED_NAMES);
+    for (std::string::size_type pos = 0; pos < str.size();) {
+        if (!isNameChar(str[pos]) || std::isdigit((unsigned char)str[pos])) {
+            ++pos;
+            continue;
+        }
+        const std::string::size_type start = pos;
+        while (pos < str.size() && isNameChar(str[pos]))
+            ++pos;
+        names->insert(str.substr(start, pos - start));
+    }
+}
+
+/** Add the names from @p tok until the end of its line to @p names */
+static void addNamesOnLine(std::set<std::string> *names, const simplecpp::Token *tok)
+{
+    for (const simplecpp::Token *linetok = tok; linetok && sameline(tok, linetok); linetok = linetok->next) {
+        if (linetok->name)
+            names->insert(linetok->str());
+        else if (linetok->op == '#' && linetok != tok && sameline(linetok, linetok->next) && linetok->next->op == '#')
+            names->insert(PASTED_NAMES);
+    }
+}
+
+void simplecpp::preprocess(simplecpp::TokenList &output, const simplecpp::TokenList &rawtokens, std::vector<std::string> &files, std::map<std::string, simplecpp::TokenList *> &filedata, const simplecpp::DUI &dui, simplecpp::OutputList *outputList, std::list<simplecpp::MacroUsage> *macroUsage, std::set<std::string> *macroNames)
 {
     std::map<std::string, std::size_t> sizeOfType(rawtokens.sizeOfType);
     sizeOfType.insert(std::pair<std::string, std::size_t>("char", sizeof(char)));
@@ -2517,6 +2777,8 @@ void simplecpp::preprocess(simplecpp::TokenList &output, const simplecpp::TokenL
         const std::string rhs(eq==std::string::npos ? std::string("1") : macrostr.substr(eq+1));
         const Macro macro(lhs, rhs, files);
         macros.insert(std::pair<TokenString,Macro>(macro.name(), macro));
+        if (macroNames)
+            addNames(macroNames, rhs);
     }
 
     macros.insert(std::pair<TokenString,Macro>("__FILE__", Macro("__FILE__", "__FILE__", files)));
@@ -2559,6 +2821,9 @@ void simplecpp::preprocess(simplecpp::TokenList &output, const simplecpp::TokenL
                 continue;
             }
 
+            if (macroNames && (ifstates.top() == TRUE || (ifstates.top() == ELSE_IS_TRUE && rawtok->str() == ELIF)))
+                addNamesOnLine(macroNames, rawtok);
+
             if (ifstates.size() <= 1U && (rawtok->str() == ELIF || rawtok->str() == ELSE || rawtok->str() == ENDIF)) {
                 if (outputList) {
                     simplecpp::Output err(files);
@@ -2818,11 +3083,19 @@ void simplecpp::preprocess(simplecpp::TokenList &output, const simplecpp::TokenL
         const Location loc(rawtok->location);
         TokenList tokens(files);
 
+        const Token * const firsttok = rawtok;
         if (!preprocessToken(tokens, &rawtok, macros, files, outputList)) {
             output.clear();
             return;
         }
 
+        if (macroNames) {
+            for (const Token *tok = firsttok; tok != rawtok; tok = tok->next) {
+                if (tok->name)
+                    macroNames->insert(tok->str());
+            }
+        }
+
         if (hash || hashhash) {
             std::string s;
             for (const Token *hashtok = tokens.cfront(); hashtok; hashtok = hashtok->next)
@@ -180,6 +180,8 @@ namespace simplecpp {
     public:
         explicit TokenList(std::vector<std::string> &filenames);
         TokenList(std::istream &istr, std::vector<std::string> &filenames, const std::string &filename=std::string(), OutputList *outputList = NULL);
+        /** Tokenize the @p size bytes at @p data, without copying them */
+        TokenList(const char *data, std::size_t size, std::vector<std::string> &filenames, const std::string &filename=std::string(), OutputList *outputList = NULL);
         TokenList(const TokenList &other);
 #if __cplusplus >= 201103L
         TokenList(TokenList &&other);
@@ -200,6 +202,8 @@ namespace simplecpp {
         std::string stringify() const;
 
         void readfile(std::istream &istr, const std::string &filename=std::string(), OutputList *outputList = NULL);
+        /** Read the @p size bytes at @p data, without copying them */
+        void readfile(const char *data, std::size_t size, const std::string &filename=std::string(), OutputList *outputList = NULL);
         void constFold();
 
         void removeComments();
@@ -264,7 +268,11 @@ namespace simplecpp {
         void constFoldLogicalOp(Token *tok);
         void constFoldQuestionOp(Token **tok1);
 
-        std::string readUntil(std::istream &istr, const Location &location, char start, char end, OutputList *outputList, unsigned int bom);
+        template<class Stream>
+        void readfile(Stream &istr, const std::string &filename, OutputList *outputList, unsigned short bom);
+
+        template<class Stream>
+        std::string readUntil(Stream &istr, const Location &location, char start, char end, OutputList *outputList, unsigned int bom);
         void lineDirective(unsigned int fileIndex, unsigned int line, Location *location);
 
         std::string lastLine(int maxsize=100000) const;
@@ -297,7 +305,68 @@ namespace simplecpp {
         std::list<std::string> includes;
     };
 
-    SIMPLECPP_LIB std::map<std::string, TokenList*> load(const TokenList &rawtokens, std::vector<std::string> &filenames, const DUI &dui, OutputList *outputList = NULL);
+    /**
+     * Cache of tokenized files. A header that is included by many source
+     * files is only read and tokenized once. The tokens are copied into the
+     * TokenList of each source file. A file is tokenized again when its size
+     * or content has changed.
+     */
+    class SIMPLECPP_LIB FileCache {
+    public:
+        /** @param maxTokens the least recently used files are removed when the cache holds more tokens, 0 means no limit */
+        explicit FileCache(std::size_t maxTokens = 0) : maxTokens(maxTokens), tokenCount(0), useCount(0) {}
+        virtual ~FileCache();
+
+        /** Tokens of @param filename, read from @p istr and tokenized unless they are cached */
+        TokenList *get(std::istream &istr, std::vector<std::string> &filenames, const std::string &filename, OutputList *outputList = NULL);
+
+        void clear();
+
+        std::size_t size() const;
+
+    protected:
+        /**
+         * Called around every access to the cached files. The tokens are
+         * read and copied without the lock. Override to share the cache
+         * between threads.
+         */
+        virtual void lock() const {}
+        virtual void unlock() const {}
+
+    private:
+        struct Entry {
+            Entry() : tokens(files), size(0), checksum(0), tokenCount(0), lastUse(0), users(0), cached(false) {}
+            std::vector<std::string> files;
+            TokenList tokens;
+            OutputList outputList;
+            std::size_t size;
+            unsigned long long checksum;
+            std::size_t tokenCount;
+            unsigned long long lastUse;
+            /** Number of get() calls that copy the tokens. An entry that is removed from the cache is deleted by its last user. */
+            unsigned int users;
+            bool cached;
+        };
+
+        void insert(const std::string &filename, Entry *entry);
+        void remove(std::map<std::string, Entry *>::iterator it);
+        static void release(Entry *entry);
+
+        std::map<std::string, Entry *> entries;
+        const std::size_t maxTokens;
+        std::size_t tokenCount;
+        unsigned long long useCount;
+
+        // Not implemented - prevent copying
+        FileCache(const FileCache &);
+        FileCache &operator=(const FileCache &);
+    };
+
+    /**
+     * Load the files that are included by @p rawtokens
+     * @param cache if given, files are taken from and added to this cache
+     */
+    SIMPLECPP_LIB std::map<std::string, TokenList*> load(const TokenList &rawtokens, std::vector<std::string> &filenames, const DUI &dui, OutputList *outputList = NULL, FileCache *cache = NULL);
 
     /**
      * Preprocess
@@ -309,8 +378,12 @@ namespace simplecpp {
      * @param dui defines, undefs, and include paths
      * @param outputList output: list that will receive output messages
      * @param macroUsage output: macro usage
+     * @param macroNames output: the names that may be looked up in the macro
+     *                   table. The output only depends on the macros in this
+     *                   set. It contains "##" if names are created by token
+     *                   pasting in macros, then the output can depend on any macro.
      */
-    SIMPLECPP_LIB void preprocess(TokenList &output, const TokenList &rawtokens, std::vector<std::string> &files, std::map<std::string, TokenList*> &filedata, const DUI &dui, OutputList *outputList = NULL, std::list<MacroUsage> *macroUsage = NULL);
+    SIMPLECPP_LIB void preprocess(TokenList &output, const TokenList &rawtokens, std::vector<std::string> &files, std::map<std::string, TokenList*> &filedata, const DUI &dui, OutputList *outputList = NULL, std::list<MacroUsage> *macroUsage = NULL, std::set<std::string> *macroNames = NULL);
 
     /**
      * Deallocate data
@@ -21,11 +21,14 @@
 #include <QString>
 #include <QByteArray>
 #include <sstream>
+#include <string>
 #include "benchmarksimple.h"
+#include "cppcheck.h"
 #include "tokenize.h"
 #include "token.h"
 #include "settings.h"
 #include "errorlogger.h"
+#include "symboldatabase.h"
 
 void BenchmarkSimple::tokenize()
 {
@@ -77,4 +80,77 @@ void BenchmarkSimple::tokenizeAndSimplify()
     }
 }
 
+void BenchmarkSimple::traverse()
+{
+    // many functions like the ones the checkers look at
+    std::string code;
+    for (int i = 0; i < 1000; ++i) {
+        code += "int f" + std::to_string(i) + "(const int *p, int n) {\n"
+                "    int sum = 0;\n"
+                "    for (int i = 0; i < n; i++) {\n"
+                "        if (p[i] > 0)\n"
+                "            sum += p[i] * 2;\n"
+                "    }\n"
+                "    return sum;\n"
+                "}\n";
+    }
+
+    Settings settings;
+
+    // tokenize..
+    Tokenizer tokenizer(&settings, this);
+    std::istringstream istr(code);
+    tokenizer.tokenize(istr, "test.cpp");
+
+    // read what the checkers read when they loop over the function bodies
+    QBENCHMARK {
+        unsigned int count = 0;
+        for (const Scope *scope : tokenizer.getSymbolDatabase()->functionScopes) {
+            for (const Token *tok = scope->bodyStart; tok != scope->bodyEnd; tok = tok->next()) {
+                if (tok->varId() && tok->variable())
+                    count += tok->linenr();
+                const Token *top = tok;
+                while (top->astParent())
+                    top = top->astParent();
+                if (Token::Match(top, "=|return") && top->astOperand1())
+                    ++count;
+            }
+        }
+        QVERIFY(count > 0);
+    }
+}
+
 QTEST_MAIN(BenchmarkSimple)
+
+void BenchmarkSimple::rules_data()
+{
+    QTest::addColumn<int>("rules");
+    QTest::newRow("1 rule") << 1;
+    QTest::newRow("10 rules") << 10;
+    QTest::newRow("100 rules") << 100;
+}
+
+void BenchmarkSimple::rules()
+{
+    // the rules are not executed unless cppcheck is built with HAVE_RULES
+    QFETCH(int, rules);
+
+    std::string code;
+    for (int i = 0; i < 2000; ++i)
+        code += "int f" + std::to_string(i) + "(int x) { return x + " + std::to_string(i) + "; }\n";
+
+    // rules without hits, so the whole token string is scanned
+    CppCheck cppCheck(*this, false);
+    for (int i = 0; i < rules; ++i) {
+        Settings::Rule rule;
+        rule.tokenlist = "normal";
+        rule.pattern = "\\bunknownFunction" + std::to_string(i) + " \\(";
+        rule.id = "rule" + std::to_string(i);
+        cppCheck.settings().rules.push_back(rule);
+    }
+    CppCheck::compileRules(cppCheck.settings());
+
+    QBENCHMARK {
+        cppCheck.check("test.c", code);
+    }
+}
@@ -27,6 +27,9 @@ private slots:
     void tokenize();
     void simplify();
     void tokenizeAndSimplify();
+    void traverse();
+    void rules_data();
+    void rules();
 
 private:
     // Empty implementations of ErrorLogger methods.
@@ -22,10 +22,39 @@
 #include "utils.h"
 
 #include <tinyxml2.h>
+#include <sys/stat.h>
+#include <cstdlib>
 #include <cstring>
+#include <ctime>
+#include <iterator>
 #include <map>
+#include <mutex>
 #include <sstream>
 
+/** Start of an analyzer info file in the binary format */
+static const char binaryMagic[] = "cppcheck-analyzerinfo\n";
+
+/** Version of the binary format, increase it when the format is changed */
+static const unsigned int binaryVersion = 3;
+
+/** Records of the binary format. Each record is followed by its data as a string. */
+enum BinaryRecord {
+    /** ErrorMessage::serializeBinary() */
+    ERROR_RECORD = 1,
+    /** Name of the check and its file info */
+    FILE_INFO_RECORD = 2,
+    /** End of the file, without data. Files without it are incomplete. */
+    END_RECORD = 3,
+    /** Inputs of the analysis: checksums and time, then name, size, mtime and checksum of each header */
+    INPUTS_RECORD = 4,
+    /** The missing headers of the inputs, a name for each header */
+    MISSING_HEADERS_RECORD = 5
+};
+
+AnalyzerInformation::AnalyzerInformation() : mXml(false)
+{
+}
+
 AnalyzerInformation::~AnalyzerInformation()
 {
     close();
@@ -60,20 +89,194 @@ void AnalyzerInformation::writeFilesTxt(const std::string &buildDir, const std::
     }
 }
 
+std::map<std::string, double> AnalyzerInformation::readTimings(const std::string &buildDir)
+{
+    std::map<std::string, double> timings;
+    std::ifstream fin(buildDir + "/timings.txt");
+    std::string line;
+    while (std::getline(fin, line)) {
+        // Example line: "1.25 src/main.cpp"
+        const std::string::size_type pos = line.find(' ');
+        if (pos == std::string::npos || pos + 1U >= line.size())
+            continue;
+        std::istringstream istr(line.substr(0, pos));
+        double seconds = 0;
+        if (istr >> seconds)
+            timings[line.substr(pos + 1U)] = seconds;
+    }
+    return timings;
+}
+
+void AnalyzerInformation::writeTimings(const std::string &buildDir, const std::map<std::string, double> &timings)
+{
+    std::map<std::string, double> allTimings(readTimings(buildDir));
+    for (std::map<std::string, double>::const_iterator it = timings.begin(); it != timings.end(); ++it)
+        allTimings[it->first] = it->second;
+
+    std::ofstream fout(buildDir + "/timings.txt");
+    for (std::map<std::string, double>::const_iterator it = allTimings.begin(); it != allTimings.end(); ++it)
+        fout << it->second << ' ' << it->first << '\n';
+}
+
 void AnalyzerInformation::close()
 {
     mAnalyzerInfoFile.clear();
     if (mOutputStream.is_open()) {
-        mOutputStream << "</analyzerinfo>\n";
+        if (mXml) {
+            mOutputStream << "</analyzerinfo>\n";
+        } else {
+            std::string data;
+            serializeNumber(data, END_RECORD);
+            mOutputStream << data;
+        }
         mOutputStream.close();
     }
 }
 
-static bool skipAnalysis(const std::string &analyzerInfoFile, unsigned long long checksum, std::list<ErrorLogger::ErrorMessage> *errors)
+static bool statFile(const std::string &filename, AnalyzerInformation::Dependency *dep)
+{
+    struct stat st;
+    if (stat(filename.c_str(), &st) != 0)
+        return false;
+    dep->filename = filename;
+    dep->size = st.st_size;
+    dep->mtime = st.st_mtime;
+    return true;
+}
+
+static std::mutex dependencyCacheMutex;
+
+/** Checksums of the headers that were hashed by this process */
+static std::map<std::string, AnalyzerInformation::Dependency> dependencyCache;
+
+/** The dependency cache is cleared when it has this many headers */
+static const std::size_t maxDependencyCacheSize = 100000;
+
+static bool getDependency(const std::string &filename, AnalyzerInformation::Dependency *dep)
+{
+    if (!statFile(filename, dep))
+        return false;
+    {
+        std::lock_guard<std::mutex> lock(dependencyCacheMutex);
+        const std::map<std::string, AnalyzerInformation::Dependency>::const_iterator it = dependencyCache.find(filename);
+        if (it != dependencyCache.end() && it->second.size == dep->size && it->second.mtime == dep->mtime) {
+            dep->checksum = it->second.checksum;
+            return true;
+        }
+    }
+
+    const std::time_t now = std::time(nullptr);
+    std::ifstream fin(filename, std::ios::binary);
+    if (!fin.is_open())
+        return false;
+    const std::string data((std::istreambuf_iterator<char>(fin)), std::istreambuf_iterator<char>());
+    dep->checksum = Checksum::calculate(data);
+
+    // The file might be modified again in the same second
+    if (dep->mtime < (unsigned long long)now) {
+        std::lock_guard<std::mutex> lock(dependencyCacheMutex);
+        if (dependencyCache.size() >= maxDependencyCacheSize)
+            dependencyCache.clear();
+        dependencyCache[filename] = *dep;
+    }
+    return true;
+}
+
+AnalyzerInformation::Inputs AnalyzerInformation::getInputs(unsigned long long settingsChecksum, unsigned long long sourceChecksum, const std::list<std::string> &headers, const std::set<std::string> &missingHeaders)
+{
+    Inputs inputs;
+    inputs.settingsChecksum = settingsChecksum;
+    inputs.sourceChecksum = sourceChecksum;
+    inputs.time = std::time(nullptr);
+    for (const std::string &header : headers) {
+        Dependency dep;
+        if (!getDependency(header, &dep))
+            return Inputs();
+        inputs.headers.push_back(dep);
+    }
+    inputs.missingHeaders.assign(missingHeaders.begin(), missingHeaders.end());
+    return inputs;
+}
+
+static bool sameInputs(const AnalyzerInformation::Inputs &inputs1, const AnalyzerInformation::Inputs &inputs2)
+{
+    if (inputs1.time == 0 || inputs2.time == 0)
+        return inputs1.time == inputs2.time;
+    if (inputs1.settingsChecksum != inputs2.settingsChecksum ||
+        inputs1.sourceChecksum != inputs2.sourceChecksum ||
+        inputs1.headers.size() != inputs2.headers.size() ||
+        inputs1.missingHeaders != inputs2.missingHeaders)
+        return false;
+    std::list<AnalyzerInformation::Dependency>::const_iterator it2 = inputs2.headers.begin();
+    for (const AnalyzerInformation::Dependency &dep1 : inputs1.headers) {
+        if (dep1.filename != it2->filename || dep1.size != it2->size || dep1.mtime != it2->mtime || dep1.checksum != it2->checksum)
+            return false;
+        ++it2;
+    }
+    return true;
+}
+
+static bool readBinaryFile(const std::string &data, AnalyzerInformation::Info *info)
+{
+    const std::size_t magicSize = sizeof(binaryMagic) - 1U;
+    BinaryReader reader(data.data() + magicSize, data.size() - magicSize);
+    if (reader.number() != binaryVersion)
+        return false;
+    info->checksum = reader.number();
+    while (!reader.error() && !reader.atEnd()) {
+        const unsigned long long record = reader.number();
+        if (record == END_RECORD)
+            return !reader.error() && reader.atEnd();
+        const std::string recordData = reader.string();
+        if (record == ERROR_RECORD) {
+            ErrorLogger::ErrorMessage errmsg;
+            if (!errmsg.deserializeBinary(recordData.data(), recordData.size()))
+                return false;
+            info->errors.push_back(errmsg);
+        } else if (record == FILE_INFO_RECORD) {
+            BinaryReader fileInfoReader(recordData.data(), recordData.size());
+            const std::string check = fileInfoReader.string();
+            const std::string fileInfo = fileInfoReader.string();
+            if (fileInfoReader.error())
+                return false;
+            info->fileInfo.emplace_back(check, fileInfo);
+        } else if (record == INPUTS_RECORD) {
+            BinaryReader inputsReader(recordData.data(), recordData.size());
+            AnalyzerInformation::Inputs &inputs = info->inputs;
+            inputs.settingsChecksum = inputsReader.number();
+            inputs.sourceChecksum = inputsReader.number();
+            inputs.time = inputsReader.number();
+            while (!inputsReader.error() && !inputsReader.atEnd()) {
+                AnalyzerInformation::Dependency dep;
+                dep.filename = inputsReader.string();
+                dep.size = inputsReader.number();
+                dep.mtime = inputsReader.number();
+                dep.checksum = inputsReader.number();
+                inputs.headers.push_back(dep);
+            }
+            if (inputsReader.error())
+                return false;
+        } else if (record == MISSING_HEADERS_RECORD) {
+            BinaryReader missingReader(recordData.data(), recordData.size());
+            while (!missingReader.error() && !missingReader.atEnd())
+                info->inputs.missingHeaders.push_back(missingReader.string());
+            if (missingReader.error())
+                return false;
+        }
+    }
+    return false;
+}
+
+static unsigned long long numberAttribute(const tinyxml2::XMLElement *e, const char name[])
+{
+    const char *attr = e->Attribute(name);
+    return attr ? std::strtoull(attr, nullptr, 10) : 0;
+}
+
+static bool readXmlFile(const std::string &data, AnalyzerInformation::Info *info)
 {
     tinyxml2::XMLDocument doc;
-    const tinyxml2::XMLError error = doc.LoadFile(analyzerInfoFile.c_str());
-    if (error != tinyxml2::XML_SUCCESS)
+    if (doc.Parse(data.data(), data.size()) != tinyxml2::XML_SUCCESS)
         return false;
 
     const tinyxml2::XMLElement * const rootNode = doc.FirstChildElement();
@@ -81,17 +284,57 @@ static bool skipAnalysis(const std::string &analyzerInfoFile, unsigned long long
         return false;
 
     const char *attr = rootNode->Attribute("checksum");
-    if (!attr || attr != std::to_string(checksum))
+    if (!attr)
         return false;
+    info->checksum = std::strtoull(attr, nullptr, 10);
+    info->xml = true;
 
     for (const tinyxml2::XMLElement *e = rootNode->FirstChildElement(); e; e = e->NextSiblingElement()) {
         if (std::strcmp(e->Name(), "error") == 0)
-            errors->emplace_back(e);
+            info->errors.emplace_back(e);
+        else if (std::strcmp(e->Name(), "FileInfo") == 0) {
+            const char *check = e->Attribute("check");
+            if (!check)
+                continue;
+            tinyxml2::XMLPrinter printer;
+            for (const tinyxml2::XMLElement *child = e->FirstChildElement(); child; child = child->NextSiblingElement())
+                child->Accept(&printer);
+            info->fileInfo.emplace_back(check, printer.CStr());
+        } else if (std::strcmp(e->Name(), "inputs") == 0) {
+            AnalyzerInformation::Inputs &inputs = info->inputs;
+            inputs.settingsChecksum = numberAttribute(e, "settings-checksum");
+            inputs.sourceChecksum = numberAttribute(e, "source-checksum");
+            inputs.time = numberAttribute(e, "time");
+            for (const tinyxml2::XMLElement *header = e->FirstChildElement("header"); header; header = header->NextSiblingElement("header")) {
+                AnalyzerInformation::Dependency dep;
+                const char *name = header->Attribute("name");
+                dep.filename = name ? name : "";
+                dep.size = numberAttribute(header, "size");
+                dep.mtime = numberAttribute(header, "mtime");
+                dep.checksum = numberAttribute(header, "checksum");
+                inputs.headers.push_back(dep);
+            }
+            for (const tinyxml2::XMLElement *missing = e->FirstChildElement("missing"); missing; missing = missing->NextSiblingElement("missing")) {
+                const char *name = missing->Attribute("name");
+                inputs.missingHeaders.push_back(name ? name : "");
+            }
+        }
     }
-
     return true;
 }
 
+bool AnalyzerInformation::readFile(const std::string &analyzerInfoFile, Info *info)
+{
+    std::ifstream fin(analyzerInfoFile, std::ios::binary);
+    if (!fin.is_open())
+        return false;
+    const std::string data((std::istreambuf_iterator<char>(fin)), std::istreambuf_iterator<char>());
+
+    if (data.compare(0, sizeof(binaryMagic) - 1U, binaryMagic) == 0)
+        return readBinaryFile(data, info);
+    return readXmlFile(data, info);
+}
+
 std::string AnalyzerInformation::getAnalyzerInfoFile(const std::string &buildDir, const std::string &sourcefile, const std::string &cfg)
 {
     const std::string files(buildDir + "/files.txt");
@@ -122,36 +365,154 @@ std::string AnalyzerInformation::getAnalyzerInfoFile(const std::string &buildDir
     return filename;
 }
 
-bool AnalyzerInformation::analyzeFile(const std::string &buildDir, const std::string &sourcefile, const std::string &cfg, unsigned long long checksum, std::list<ErrorLogger::ErrorMessage> *errors)
+bool AnalyzerInformation::isUpToDate(const std::string &buildDir, const std::string &sourcefile, const std::string &cfg, unsigned long long settingsChecksum, unsigned long long sourceChecksum, std::list<ErrorLogger::ErrorMessage> *errors)
+{
+    if (buildDir.empty() || sourcefile.empty())
+        return false;
+
+    Info info;
+    if (!readFile(getAnalyzerInfoFile(buildDir, sourcefile, cfg), &info))
+        return false;
+
+    const Inputs &inputs = info.inputs;
+    if (inputs.time == 0 || inputs.settingsChecksum != settingsChecksum || inputs.sourceChecksum != sourceChecksum)
+        return false;
+
+    for (const Dependency &header : inputs.headers) {
+        Dependency current;
+        if (!statFile(header.filename, &current))
+            return false;
+        // A header that was modified in the second it was hashed might have other contents
+        if (current.size == header.size && current.mtime == header.mtime && header.mtime < inputs.time)
+            continue;
+        if (!getDependency(header.filename, &current) || current.checksum != header.checksum)
+            return false;
+    }
+
+    for (const std::string &missing : inputs.missingHeaders) {
+        Dependency current;
+        if (statFile(missing, &current))
+            return false;
+    }
+
+    errors->splice(errors->end(), info.errors);
+    return true;
+}
+
+bool AnalyzerInformation::analyzeFile(const std::string &buildDir, const std::string &sourcefile, const std::string &cfg, unsigned long long checksum, std::list<ErrorLogger::ErrorMessage> *errors, bool xml, const Inputs *inputs)
 {
     if (buildDir.empty() || sourcefile.empty())
         return true;
     close();
 
     mAnalyzerInfoFile = AnalyzerInformation::getAnalyzerInfoFile(buildDir,sourcefile,cfg);
+    mXml = xml;
 
-    if (skipAnalysis(mAnalyzerInfoFile, checksum, errors))
+    Info info;
+    if (readFile(mAnalyzerInfoFile, &info) && info.checksum == checksum) {
+        // Record the new inputs so isUpToDate() can be used next time
+        if (inputs && !sameInputs(info.inputs, *inputs)) {
+            // The file info can't be converted, so the file keeps its format
+            mXml = info.xml;
+            open(checksum, inputs);
+            for (const ErrorLogger::ErrorMessage &errmsg : info.errors)
+                reportErr(errmsg, false);
+            for (const std::pair<std::string, std::string> &fileInfo : info.fileInfo)
+                setFileInfo(fileInfo.first, fileInfo.second);
+            close();
+        }
+        errors->splice(errors->end(), info.errors);
         return false;
+    }
 
-    mOutputStream.open(mAnalyzerInfoFile);
-    if (mOutputStream.is_open()) {
+    open(checksum, inputs);
+    return true;
+}
+
+void AnalyzerInformation::open(unsigned long long checksum, const Inputs *inputs)
+{
+    mOutputStream.open(mAnalyzerInfoFile, mXml ? std::ios::out : (std::ios::out | std::ios::binary));
+    if (!mOutputStream.is_open()) {
+        mAnalyzerInfoFile.clear();
+        return;
+    }
+
+    if (mXml) {
         mOutputStream << "<?xml version=\"1.0\"?>\n";
         mOutputStream << "<analyzerinfo checksum=\"" << checksum << "\">\n";
+        if (inputs && inputs->time != 0) {
+            mOutputStream << "  <inputs settings-checksum=\"" << inputs->settingsChecksum << '\"'
+                          << " source-checksum=\"" << inputs->sourceChecksum << '\"'
+                          << " time=\"" << inputs->time << "\">\n";
+            for (const Dependency &header : inputs->headers) {
+                mOutputStream << "    <header name=\"" << ErrorLogger::toxml(header.filename) << '\"'
+                              << " size=\"" << header.size << '\"'
+                              << " mtime=\"" << header.mtime << '\"'
+                              << " checksum=\"" << header.checksum << "\"/>\n";
+            }
+            for (const std::string &missing : inputs->missingHeaders)
+                mOutputStream << "    <missing name=\"" << ErrorLogger::toxml(missing) << "\"/>\n";
+            mOutputStream << "  </inputs>\n";
+        }
     } else {
-        mAnalyzerInfoFile.clear();
-    }
+        std::string data(binaryMagic);
+        serializeNumber(data, binaryVersion);
+        serializeNumber(data, checksum);
+        if (inputs && inputs->time != 0) {
+            std::string record;
+            serializeNumber(record, inputs->settingsChecksum);
+            serializeNumber(record, inputs->sourceChecksum);
+            serializeNumber(record, inputs->time);
+            for (const Dependency &header : inputs->headers) {
+                serializeString(record, header.filename);
+                serializeNumber(record, header.size);
+                serializeNumber(record, header.mtime);
+                serializeNumber(record, header.checksum);
+            }
+            serializeNumber(data, INPUTS_RECORD);
+            serializeString(data, record);
 
-    return true;
+            if (!inputs->missingHeaders.empty()) {
+                std::string missingRecord;
+                for (const std::string &missing : inputs->missingHeaders)
+                    serializeString(missingRecord, missing);
+                serializeNumber(data, MISSING_HEADERS_RECORD);
+                serializeString(data, missingRecord);
+            }
+        }
+        mOutputStream << data;
+    }
 }
 
 void AnalyzerInformation::reportErr(const ErrorLogger::ErrorMessage &msg, bool /*verbose*/)
 {
-    if (mOutputStream.is_open())
+    if (!mOutputStream.is_open())
+        return;
+    if (mXml) {
         mOutputStream << msg.toXML() << '\n';
+    } else {
+        std::string errmsg;
+        msg.serializeBinary(errmsg);
+        std::string data;
+        serializeNumber(data, ERROR_RECORD);
+        serializeString(data, errmsg);
+        mOutputStream << data;
+    }
 }
 
 void AnalyzerInformation::setFileInfo(const std::string &check, const std::string &fileInfo)
 {
-    if (mOutputStream.is_open() && !fileInfo.empty())
+    if (!mOutputStream.is_open() || fileInfo.empty())
+        return;
+    if (mXml) {
         mOutputStream << "  <FileInfo check=\"" << check << "\">\n" << fileInfo << "  </FileInfo>\n";
+    } else {
+        std::string record;
+        serializeString(record, check);
+        serializeString(record, fileInfo);
+        std::string data;
+        serializeNumber(data, FILE_INFO_RECORD);
+        serializeString(data, record);
+        mOutputStream << data;
+    }
 }
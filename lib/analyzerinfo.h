@@ -27,7 +27,10 @@
 
 #include <fstream>
 #include <list>
+#include <map>
+#include <set>
 #include <string>
+#include <utility>
 
 /// @addtogroup Core
 /// @{
@@ -40,6 +43,10 @@
 * - error messages
 * - whole program analysis data
 *
+* The information is written in a compact binary format that can be read
+* without parsing XML. With --analyzer-info-xml it is written in XML format
+* for tools that read it.
+*
 * The information can be used for various purposes. It allows:
 * - 'make' - only analyze TUs that are changed and generate full report
 * - should be possible to add distributed analysis later
@@ -47,19 +54,115 @@
 */
 class CPPCHECKLIB AnalyzerInformation {
 public:
+    AnalyzerInformation();
     ~AnalyzerInformation();
 
     static void writeFilesTxt(const std::string &buildDir, const std::list<std::string> &sourcefiles, const std::list<ImportProject::FileSettings> &fileSettings);
 
+    /** Read the time in seconds it took to check each file in earlier runs (timings.txt) */
+    static std::map<std::string, double> readTimings(const std::string &buildDir);
+
+    /** Add/update check times in timings.txt */
+    static void writeTimings(const std::string &buildDir, const std::map<std::string, double> &timings);
+
+    /** A header that was read when the source file was analyzed */
+    struct Dependency {
+        Dependency() : size(0), mtime(0), checksum(0) {}
+
+        std::string filename;
+        unsigned long long size;
+        unsigned long long mtime;
+        unsigned long long checksum;
+    };
+
+    /**
+     * The inputs of an analysis. They are compared by isUpToDate() before
+     * the source file is tokenized.
+     */
+    struct Inputs {
+        Inputs() : settingsChecksum(0), sourceChecksum(0), time(0) {}
+
+        /** Checksum of the settings that affect the results */
+        unsigned long long settingsChecksum;
+
+        /** Checksum of the contents of the source file */
+        unsigned long long sourceChecksum;
+
+        /** Time when the headers were hashed, 0 if no inputs are recorded */
+        unsigned long long time;
+
+        std::list<Dependency> headers;
+
+        /**
+         * Files that an \#include looked for and did not find. If one of
+         * them exists, the \#include finds another file than before.
+         */
+        std::list<std::string> missingHeaders;
+    };
+
+    /** Contents of a TU.analyzerinfo file */
+    struct Info {
+        Info() : checksum(0), xml(false) {}
+
+        unsigned long long checksum;
+        Inputs inputs;
+        std::list<ErrorLogger::ErrorMessage> errors;
+
+        /** Is the file in XML format */
+        bool xml;
+
+        /** Name of the check and the data that its Check::FileInfo::toBinary(), or toString() in XML format, returned */
+        std::list<std::pair<std::string, std::string>> fileInfo;
+    };
+
+    /**
+     * Get the inputs of an analysis. The checksums of the headers are
+     * cached by the process until their size or modification time changes.
+     */
+    static Inputs getInputs(unsigned long long settingsChecksum, unsigned long long sourceChecksum, const std::list<std::string> &headers, const std::set<std::string> &missingHeaders);
+
+    /**
+     * Check if the results of the previous analysis of the source file can
+     * be used, without tokenizing it. The settings and the source file must
+     * have the same checksums as before. A header is hashed only if its size
+     * or modification time has changed. The results are not up to date if
+     * a header is created where an \#include looked for it.
+     * @return true if the results are up to date, @p errors are the results
+     */
+    static bool isUpToDate(const std::string &buildDir, const std::string &sourcefile, const std::string &cfg, unsigned long long settingsChecksum, unsigned long long sourceChecksum, std::list<ErrorLogger::ErrorMessage> *errors);
+
+    /**
+     * Read a TU.analyzerinfo file. Files in the binary format and in the
+     * XML format are read.
+     * @return false if the file is missing or invalid
+     */
+    static bool readFile(const std::string &analyzerInfoFile, Info *info);
+
     /** Close current TU.analyzerinfo file */
     void close();
-    bool analyzeFile(const std::string &buildDir, const std::string &sourcefile, const std::string &cfg, unsigned long long checksum, std::list<ErrorLogger::ErrorMessage> *errors);
+
+    /**
+     * Open the TU.analyzerinfo file of the source file, unless its checksum
+     * shows that the results of the previous analysis can be used.
+     * @param xml write the file in XML format instead of the binary format
+     * @param inputs inputs that are recorded in the file for isUpToDate(). If
+     * the file does not need to be analyzed, its inputs are updated.
+     * @return false if the file does not need to be analyzed, @p errors are its results
+     */
+    bool analyzeFile(const std::string &buildDir, const std::string &sourcefile, const std::string &cfg, unsigned long long checksum, std::list<ErrorLogger::ErrorMessage> *errors, bool xml = false, const Inputs *inputs = nullptr);
     void reportErr(const ErrorLogger::ErrorMessage &msg, bool verbose);
+    /** @param fileInfo data of Check::FileInfo::toBinary(), or of toString() if the file is written in XML format */
     void setFileInfo(const std::string &check, const std::string &fileInfo);
     static std::string getAnalyzerInfoFile(const std::string &buildDir, const std::string &sourcefile, const std::string &cfg);
 private:
+    /** Open mAnalyzerInfoFile for writing */
+    void open(unsigned long long checksum, const Inputs *inputs);
+
     std::ofstream mOutputStream;
     std::string mAnalyzerInfoFile;
+
+    /** Is the file written in XML format */
+    bool mXml;
 };
 
 /// @}
@@ -96,6 +96,10 @@ public:
         virtual std::string toString() const {
             return std::string();
         }
+        /** Data for the binary analyzer info format, read by loadFileInfoFromBinary() */
+        virtual std::string toBinary() const {
+            return std::string();
+        }
     };
 
     virtual FileInfo * getFileInfo(const Tokenizer *tokenizer, const Settings *settings) const {
@@ -109,6 +113,11 @@ public:
         return nullptr;
     }
 
+    virtual FileInfo * loadFileInfoFromBinary(const std::string &data) const {
+        (void)data;
+        return nullptr;
+    }
+
     // Return true if an error is reported.
     virtual bool analyseWholeProgram(const CTU::FileInfo *ctu, const std::list<FileInfo*> &fileInfo, const Settings& settings, ErrorLogger &errorLogger) {
         (void)ctu;
@@ -64,7 +64,7 @@ static const CWE CWE_BUFFER_OVERRUN(788U);   // Access of Memory Location After
 
 static const ValueFlow::Value *getBufferSizeValue(const Token *tok)
 {
-    const std::list<ValueFlow::Value> &tokenValues = tok->values();
+    const ValueFlow::Values &tokenValues = tok->values();
     const auto it = std::find_if(tokenValues.begin(), tokenValues.end(), std::mem_fn(&ValueFlow::Value::isBufferSizeValue));
     return it == tokenValues.end() ? nullptr : &*it;
 }
@@ -744,6 +744,14 @@ std::string CheckBufferOverrun::MyFileInfo::toString() const
     return xml;
 }
 
+std::string CheckBufferOverrun::MyFileInfo::toBinary() const
+{
+    std::string data;
+    CTU::toBinary(data, unsafeArrayIndex);
+    CTU::toBinary(data, unsafePointerArith);
+    return data;
+}
+
 bool CheckBufferOverrun::isCtuUnsafeBufferUsage(const Check *check, const Token *argtok, MathLib::bigint *offset, int type)
 {
     const CheckBufferOverrun *c = dynamic_cast<const CheckBufferOverrun *>(check);
@@ -813,6 +821,21 @@ Check::FileInfo * CheckBufferOverrun::loadFileInfoFromXml(const tinyxml2::XMLEle
     return fileInfo;
 }
 
+Check::FileInfo * CheckBufferOverrun::loadFileInfoFromBinary(const std::string &data) const
+{
+    BinaryReader reader(data.data(), data.size());
+    MyFileInfo *fileInfo = new MyFileInfo;
+    fileInfo->unsafeArrayIndex = CTU::loadUnsafeUsageListFromBinary(reader);
+    fileInfo->unsafePointerArith = CTU::loadUnsafeUsageListFromBinary(reader);
+
+    if (fileInfo->unsafeArrayIndex.empty() && fileInfo->unsafePointerArith.empty()) {
+        delete fileInfo;
+        return nullptr;
+    }
+
+    return fileInfo;
+}
+
 /** @brief Analyse all file infos for all TU */
 bool CheckBufferOverrun::analyseWholeProgram(const CTU::FileInfo *ctu, const std::list<Check::FileInfo*> &fileInfo, const Settings& settings, ErrorLogger &errorLogger)
 {
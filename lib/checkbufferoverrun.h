@@ -119,6 +119,7 @@ private:
 
         /** Convert MyFileInfo data into xml string */
         std::string toString() const OVERRIDE;
+        std::string toBinary() const OVERRIDE;
     };
 
     static bool isCtuUnsafeBufferUsage(const Check *check, const Token *argtok, MathLib::bigint *value, int type);
@@ -126,6 +127,7 @@ private:
     static bool isCtuUnsafePointerArith(const Check *check, const Token *argtok, MathLib::bigint *value);
 
     Check::FileInfo * loadFileInfoFromXml(const tinyxml2::XMLElement *xmlElement) const OVERRIDE;
+    Check::FileInfo * loadFileInfoFromBinary(const std::string &data) const OVERRIDE;
     bool analyseWholeProgram1(const CTU::FileInfo *ctu, const std::map<std::string, std::list<const CTU::FileInfo::CallBase *>> &callsMap, const CTU::FileInfo::UnsafeUsage &unsafeUsage, int type, ErrorLogger &errorLogger);
 
 
@@ -597,6 +597,13 @@ std::string CheckNullPointer::MyFileInfo::toString() const
     return CTU::toString(unsafeUsage);
 }
 
+std::string CheckNullPointer::MyFileInfo::toBinary() const
+{
+    std::string data;
+    CTU::toBinary(data, unsafeUsage);
+    return data;
+}
+
 static bool isUnsafeUsage(const Check *check, const Token *vartok, MathLib::bigint *value)
 {
     (void)value;
@@ -628,6 +635,18 @@ Check::FileInfo * CheckNullPointer::loadFileInfoFromXml(const tinyxml2::XMLEleme
     return fileInfo;
 }
 
+Check::FileInfo * CheckNullPointer::loadFileInfoFromBinary(const std::string &data) const
+{
+    BinaryReader reader(data.data(), data.size());
+    const std::list<CTU::FileInfo::UnsafeUsage> &unsafeUsage = CTU::loadUnsafeUsageListFromBinary(reader);
+    if (unsafeUsage.empty())
+        return nullptr;
+
+    MyFileInfo *fileInfo = new MyFileInfo;
+    fileInfo->unsafeUsage = unsafeUsage;
+    return fileInfo;
+}
+
 bool CheckNullPointer::analyseWholeProgram(const CTU::FileInfo *ctu, const std::list<Check::FileInfo*> &fileInfo, const Settings& settings, ErrorLogger &errorLogger)
 {
     if (!ctu)
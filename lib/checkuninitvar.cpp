@@ -29,6 +29,7 @@
 #include "symboldatabase.h"
 #include "token.h"
 #include "tokenize.h"
+#include "utils.h"
 #include "valueflow.h"
 
 #include <tinyxml2.h>
@@ -1336,6 +1337,13 @@ std::string CheckUninitVar::MyFileInfo::toString() const
     return CTU::toString(unsafeUsage);
 }
 
+std::string CheckUninitVar::MyFileInfo::toBinary() const
+{
+    std::string data;
+    CTU::toBinary(data, unsafeUsage);
+    return data;
+}
+
 Check::FileInfo *CheckUninitVar::getFileInfo(const Tokenizer *tokenizer, const Settings *settings) const
 {
     const CheckUninitVar checker(tokenizer, settings, nullptr);
@@ -1371,6 +1379,18 @@ Check::FileInfo * CheckUninitVar::loadFileInfoFromXml(const tinyxml2::XMLElement
     return fileInfo;
 }
 
+Check::FileInfo * CheckUninitVar::loadFileInfoFromBinary(const std::string &data) const
+{
+    BinaryReader reader(data.data(), data.size());
+    const std::list<CTU::FileInfo::UnsafeUsage> &unsafeUsage = CTU::loadUnsafeUsageListFromBinary(reader);
+    if (unsafeUsage.empty())
+        return nullptr;
+
+    MyFileInfo *fileInfo = new MyFileInfo;
+    fileInfo->unsafeUsage = unsafeUsage;
+    return fileInfo;
+}
+
 bool CheckUninitVar::analyseWholeProgram(const CTU::FileInfo *ctu, const std::list<Check::FileInfo*> &fileInfo, const Settings& settings, ErrorLogger &errorLogger)
 {
     if (!ctu)
@@ -28,6 +28,7 @@
 #include "token.h"
 #include "tokenize.h"
 #include "tokenlist.h"
+#include "utils.h"
 
 #include <tinyxml2.h>
 #include <algorithm>
@@ -378,6 +379,20 @@ std::string CheckUnusedFunctions::analyzerInfo() const
     return ret.str();
 }
 
+std::string CheckUnusedFunctions::analyzerInfoBinary() const
+{
+    std::string ret;
+    serializeNumber(ret, mFunctionDecl.size());
+    for (const FunctionDecl &functionDecl : mFunctionDecl) {
+        serializeString(ret, functionDecl.functionName);
+        serializeNumber(ret, functionDecl.lineNumber);
+    }
+    serializeNumber(ret, mFunctionCalls.size());
+    for (const std::string &fc : mFunctionCalls)
+        serializeString(ret, fc);
+    return ret;
+}
+
 namespace {
     struct Location {
         Location() : lineNumber(0) {}
@@ -387,51 +402,46 @@ namespace {
     };
 }
 
-void CheckUnusedFunctions::analyseWholeProgram(ErrorLogger * const errorLogger, const std::string &buildDir)
+void CheckUnusedFunctions::analyseWholeProgram(ErrorLogger * const errorLogger, const std::list<AnalyzerInfo> &analyzerInfo)
 {
     std::map<std::string, Location> decls;
     std::set<std::string> calls;
 
-    const std::string filesTxt(buildDir + "/files.txt");
-    std::ifstream fin(filesTxt.c_str());
-    std::string filesTxtLine;
-    while (std::getline(fin, filesTxtLine)) {
-        const std::string::size_type firstColon = filesTxtLine.find(':');
-        if (firstColon == std::string::npos)
-            continue;
-        const std::string::size_type secondColon = filesTxtLine.find(':', firstColon+1);
-        if (secondColon == std::string::npos)
+    for (const AnalyzerInfo &info : analyzerInfo) {
+        const std::string &sourcefile = info.sourcefile;
+
+        if (!info.xml) {
+            BinaryReader reader(info.data.data(), info.data.size());
+            for (unsigned long long i = reader.number(); i > 0 && !reader.error(); --i) {
+                const std::string functionName = reader.string();
+                const int lineNumber = static_cast<int>(reader.number());
+                if (!reader.error())
+                    decls[functionName] = Location(sourcefile, lineNumber);
+            }
+            for (unsigned long long i = reader.number(); i > 0 && !reader.error(); --i) {
+                const std::string functionName = reader.string();
+                if (!reader.error())
+                    calls.insert(functionName);
+            }
             continue;
-        const std::string xmlfile = buildDir + '/' + filesTxtLine.substr(0,firstColon);
-        const std::string sourcefile = filesTxtLine.substr(secondColon+1);
+        }
 
         tinyxml2::XMLDocument doc;
-        const tinyxml2::XMLError error = doc.LoadFile(xmlfile.c_str());
+        const tinyxml2::XMLError error = doc.Parse(info.data.data(), info.data.size());
         if (error != tinyxml2::XML_SUCCESS)
             continue;
 
-        const tinyxml2::XMLElement * const rootNode = doc.FirstChildElement();
-        if (rootNode == nullptr)
-            continue;
-
-        for (const tinyxml2::XMLElement *e = rootNode->FirstChildElement(); e; e = e->NextSiblingElement()) {
-            if (std::strcmp(e->Name(), "FileInfo") != 0)
+        for (const tinyxml2::XMLElement *e2 = doc.FirstChildElement(); e2; e2 = e2->NextSiblingElement()) {
+            const char* functionName = e2->Attribute("functionName");
+            if (functionName == nullptr)
                 continue;
-            const char *checkattr = e->Attribute("check");
-            if (checkattr == nullptr || std::strcmp(checkattr,"CheckUnusedFunctions") != 0)
+            if (std::strcmp(e2->Name(),"functioncall") == 0) {
+                calls.insert(functionName);
                 continue;
-            for (const tinyxml2::XMLElement *e2 = e->FirstChildElement(); e2; e2 = e2->NextSiblingElement()) {
-                const char* functionName = e2->Attribute("functionName");
-                if (functionName == nullptr)
-                    continue;
-                if (std::strcmp(e2->Name(),"functioncall") == 0) {
-                    calls.insert(functionName);
-                    continue;
-                } else if (std::strcmp(e2->Name(),"functiondecl") == 0) {
-                    const char* lineNumber = e2->Attribute("lineNumber");
-                    if (lineNumber)
-                        decls[functionName] = Location(sourcefile, std::atoi(lineNumber));
-                }
+            } else if (std::strcmp(e2->Name(),"functiondecl") == 0) {
+                const char* lineNumber = e2->Attribute("lineNumber");
+                if (lineNumber)
+                    decls[functionName] = Location(sourcefile, std::atoi(lineNumber));
             }
         }
     }
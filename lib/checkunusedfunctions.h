@@ -29,6 +29,7 @@
 #include <map>
 #include <set>
 #include <string>
+#include <utility>
 
 class ErrorLogger;
 class Function;
@@ -72,9 +73,23 @@ public:
     static CheckUnusedFunctions instance;
 
     std::string analyzerInfo() const;
+    std::string analyzerInfoBinary() const;
+
+    /** The analyzer info of a TU */
+    struct AnalyzerInfo {
+        AnalyzerInfo(const std::string &sourcefile, const std::string &data, bool xml) : sourcefile(sourcefile), data(data), xml(xml) {}
+        std::string sourcefile;
+        /** The data of analyzerInfo() or analyzerInfoBinary() */
+        std::string data;
+        bool xml;
+    };
 
-    /** @brief Combine and analyze all analyzerInfos for all TUs */
-    static void analyseWholeProgram(ErrorLogger * const errorLogger, const std::string &buildDir);
+    /**
+     * @brief Combine and analyze all analyzerInfos for all TUs
+     * @param errorLogger error logger
+     * @param analyzerInfo the analyzer info of each TU
+     */
+    static void analyseWholeProgram(ErrorLogger * const errorLogger, const std::list<AnalyzerInfo> &analyzerInfo);
 
 private:
 
@@ -30,16 +30,30 @@
 #include "token.h"
 #include "tokenize.h" // Tokenizer
 #include "tokenlist.h"
+#include "utils.h"
 #include "version.h"
 
 #include <picojson.h>
 #include <simplecpp.h>
 #include <tinyxml2.h>
 #include <algorithm>
+#include <atomic>
+#include <cctype>
+#include <condition_variable>
+#include <cstdlib>
 #include <cstring>
+#include <deque>
+#include <exception>
+#include <functional>
+#include <iterator>
+#include <list>
+#include <mutex>
 #include <new>
 #include <set>
+#include <sstream>
 #include <stdexcept>
+#include <thread>
+#include <utility>
 #include <vector>
 #include <memory>
 #include <iostream> // <- TEMPORARY
@@ -122,17 +136,223 @@ static std::vector<std::string> split(const std::string &str, const std::string
     return ret;
 }
 
+/**
+ * Checksum of preprocessed code. Locations are ignored like in
+ * TokenList::calculateChecksum(), so code that only differs in line
+ * numbers has the same checksum.
+ */
+static unsigned long long calculateChecksum(const simplecpp::TokenList &tokens)
+{
+    Checksum checksum;
+    for (const simplecpp::Token *tok = tokens.cfront(); tok; tok = tok->next) {
+        checksum.update(tok->str());
+        checksum.update(tok->macro.empty() ? '\0' : '\1');
+    }
+    return checksum.digest();
+}
+
+/** Version and settings that affect the analysis results, for the checksums in the build dir */
+static std::string getToolInfo(const Settings &settings)
+{
+    std::ostringstream toolinfo;
+    toolinfo << CPPCHECK_VERSION_STRING;
+    toolinfo << (settings.isEnabled(Settings::WARNING) ? 'w' : ' ');
+    toolinfo << (settings.isEnabled(Settings::STYLE) ? 's' : ' ');
+    toolinfo << (settings.isEnabled(Settings::PERFORMANCE) ? 'p' : ' ');
+    toolinfo << (settings.isEnabled(Settings::PORTABILITY) ? 'p' : ' ');
+    toolinfo << (settings.isEnabled(Settings::INFORMATION) ? 'i' : ' ');
+    toolinfo << settings.userDefines;
+    return toolinfo.str();
+}
+
+namespace {
+    /** A configuration of the file that is checked, see --config-jobs */
+    struct ConfigCheck {
+        ConfigCheck(const Settings *settings, ErrorLogger *errorLogger, const std::string &c)
+            : tokenizer(settings, errorLogger), cfg(c), tokenized(false), finished(false), checked(false), checksum(0), reportsBeforeCheck(0) {}
+
+        /** An error or an output reported while the configuration is checked */
+        struct Report {
+            explicit Report(const ErrorLogger::ErrorMessage &msg) : isError(true), errmsg(msg) {}
+            explicit Report(const std::string &msg) : isError(false), outmsg(msg) {}
+            bool isError;
+            ErrorLogger::ErrorMessage errmsg;
+            std::string outmsg;
+        };
+
+        Tokenizer tokenizer;
+        std::string cfg;
+
+        /** Were the tokens created */
+        bool tokenized;
+
+        /** Was the configuration checked by a thread, see ConfigCheckQueue */
+        bool finished;
+
+        /** Were the normal tokens checked */
+        bool checked;
+
+        /** Checksum of the simplified token list */
+        unsigned long long checksum;
+
+        /** Reports, written in the order of the configurations when they are checked */
+        std::vector<Report> reports;
+
+        /** Number of reports before the normal tokens were checked */
+        std::size_t reportsBeforeCheck;
+
+        /** Exception thrown by the checks */
+        std::exception_ptr exception;
+    };
+}
+
+/** Configuration that collects the reports of the current thread. Null unless the configurations are checked in parallel. */
+static thread_local ConfigCheck *currentConfigCheck = nullptr;
+
+namespace {
+    /** Sets currentConfigCheck while it is in scope */
+    class CurrentConfigCheck {
+    public:
+        explicit CurrentConfigCheck(ConfigCheck *configCheck) {
+            currentConfigCheck = configCheck;
+        }
+        ~CurrentConfigCheck() {
+            currentConfigCheck = nullptr;
+        }
+    };
+
+    /**
+     * Checks configurations with several threads, see --config-jobs. The
+     * reports of a configuration are written, and its tokens are freed, as
+     * soon as it and all earlier configurations are checked.
+     */
+    class ConfigCheckQueue {
+    public:
+        ConfigCheckQueue(unsigned int numberOfThreads, const std::function<void(ConfigCheck &)> &check, const std::function<void(const ConfigCheck &)> &write)
+            : mCheck(check), mWrite(write), mStop(false) {
+            // The thread that adds the configurations also checks them when it waits
+            for (unsigned int i = 1; i < numberOfThreads; ++i)
+                mThreads.emplace_back([this]() {
+                work();
+            });
+        }
+
+        ~ConfigCheckQueue() {
+            {
+                std::lock_guard<std::mutex> lock(mMutex);
+                mStop = true;
+                mPending.clear();
+            }
+            mCondition.notify_all();
+            for (std::thread &thread : mThreads)
+                thread.join();
+        }
+
+        /** Create a configuration, it is checked when it is pushed */
+        ConfigCheck &emplace(const Settings *settings, ErrorLogger *errorLogger, const std::string &cfg) {
+            std::lock_guard<std::mutex> lock(mMutex);
+            mConfigChecks.emplace_back(settings, errorLogger, cfg);
+            return mConfigChecks.back();
+        }
+
+        void push(ConfigCheck &configCheck) {
+            {
+                std::lock_guard<std::mutex> lock(mMutex);
+                mPending.push_back(&configCheck);
+            }
+            mCondition.notify_one();
+        }
+
+        /** Write the checked configurations until at most maxConfigChecks configurations remain */
+        void write(std::size_t maxConfigChecks) {
+            std::unique_lock<std::mutex> lock(mMutex);
+            for (;;) {
+                if (!mConfigChecks.empty() && mConfigChecks.front().finished) {
+                    lock.unlock();
+                    mWrite(mConfigChecks.front());
+                    lock.lock();
+                    mConfigChecks.pop_front();
+                } else if (mConfigChecks.size() <= maxConfigChecks) {
+                    return;
+                } else if (!mPending.empty()) {
+                    ConfigCheck *configCheck = mPending.front();
+                    mPending.pop_front();
+                    lock.unlock();
+                    check(*configCheck);
+                    lock.lock();
+                } else {
+                    mCondition.wait(lock);
+                }
+            }
+        }
+
+    private:
+        void work() {
+            for (;;) {
+                ConfigCheck *configCheck;
+                {
+                    std::unique_lock<std::mutex> lock(mMutex);
+                    mCondition.wait(lock, [this]() {
+                        return mStop || !mPending.empty();
+                    });
+                    if (mPending.empty())
+                        return;
+                    configCheck = mPending.front();
+                    mPending.pop_front();
+                }
+                check(*configCheck);
+            }
+        }
+
+        void check(ConfigCheck &configCheck) {
+            {
+                const CurrentConfigCheck current(&configCheck);
+                try {
+                    mCheck(configCheck);
+                } catch (...) {
+                    configCheck.exception = std::current_exception();
+                }
+            }
+            {
+                std::lock_guard<std::mutex> lock(mMutex);
+                configCheck.finished = true;
+            }
+            mCondition.notify_all();
+        }
+
+        const std::function<void(ConfigCheck &)> mCheck;
+        const std::function<void(const ConfigCheck &)> mWrite;
+
+        std::mutex mMutex;
+        std::condition_variable mCondition;
+
+        /** The configurations that are not written yet, in order */
+        std::list<ConfigCheck> mConfigChecks;
+
+        /** The configurations that are not checked yet */
+        std::deque<ConfigCheck *> mPending;
+
+        bool mStop;
+        std::vector<std::thread> mThreads;
+    };
+}
+
+/** Progress is reported by all threads */
+static std::mutex reportProgressMutex;
+
 CppCheck::CppCheck(ErrorLogger &errorLogger, bool useGlobalSuppressions)
     : mErrorLogger(errorLogger), mExitCode(0), mSuppressInternalErrorFound(false), mUseGlobalSuppressions(useGlobalSuppressions), mTooManyConfigs(false), mSimplify(true)
 {
 }
 
+TimerResults &CppCheck::timerResults()
+{
+    return S_timerResults;
+}
+
 CppCheck::~CppCheck()
 {
-    while (!mFileInfo.empty()) {
-        delete mFileInfo.back();
-        mFileInfo.pop_back();
-    }
+    clearFileInfo();
     S_timerResults.ShowResults(mSettings.showtime);
 }
 
@@ -171,7 +391,10 @@ unsigned int CppCheck::check(const ImportProject::FileSettings &fs)
         temp.mSettings.platform(fs.platformType);
     }
     std::ifstream fin(fs.filename);
-    return temp.checkFile(Path::simplifyPath(fs.filename), fs.cfg, fin);
+    const unsigned int returnValue = temp.checkFile(Path::simplifyPath(fs.filename), fs.cfg, fin);
+    // The timing results are shown by this instance
+    temp.mSettings.showtime = SHOWTIME_NONE;
+    return returnValue;
 }
 
 unsigned int CppCheck::checkFile(const std::string& filename, const std::string &cfgname, std::istream& fileStream)
@@ -186,6 +409,8 @@ unsigned int CppCheck::checkFile(const std::string& filename, const std::string
     if (mSettings.terminated())
         return mExitCode;
 
+    Timer fileTimer(mSettings.showtime, &S_timerResults, filename);
+
     if (!mSettings.quiet) {
         std::string fixedpath = Path::simplifyPath(filename);
         fixedpath = Path::toNativeSeparators(fixedpath);
@@ -219,9 +444,58 @@ unsigned int CppCheck::checkFile(const std::string& filename, const std::string
         Preprocessor preprocessor(mSettings, this);
         std::set<std::string> configurations;
 
+        // Use the results in the build dir without tokenizing the file if
+        // the settings, the source file and its headers are unchanged
+        const bool useInputs = !mSettings.buildDir.empty() && !mSettings.preprocessOnly && !mSettings.dump && mSettings.addons.empty() && mSettings.plistOutput.empty();
+        unsigned long long settingsChecksum = 0;
+        unsigned long long sourceChecksum = 0;
+        std::string source;
+        if (useInputs) {
+            // Inline suppressions are not included, they are part of the source file and headers
+            std::ostringstream settingsInfo;
+            settingsInfo << getToolInfo(mSettings) << '\n';
+            for (const Suppressions::Suppression &suppression : mSettings.nomsg.getNonInlineSuppressions())
+                settingsInfo << suppression.getText() << '\n';
+            for (const std::string &I : mSettings.includePaths)
+                settingsInfo << " -I" << I;
+            for (const std::string &U : mSettings.userUndefs)
+                settingsInfo << " -U" << U;
+            for (const std::string &include : mSettings.userIncludes)
+                settingsInfo << " --include=" << include;
+            for (const std::string &library : mSettings.libraries)
+                settingsInfo << " --library=" << library;
+            settingsInfo << " --std=" << static_cast<int>(mSettings.standards.c) << ',' << static_cast<int>(mSettings.standards.cpp);
+            settingsInfo << " --platform=" << static_cast<int>(mSettings.platformType) << ','
+                         << mSettings.char_bit << ',' << mSettings.short_bit << ',' << mSettings.int_bit << ','
+                         << mSettings.long_bit << ',' << mSettings.long_long_bit << ','
+                         << mSettings.sizeof_bool << ',' << mSettings.sizeof_short << ',' << mSettings.sizeof_int << ','
+                         << mSettings.sizeof_long << ',' << mSettings.sizeof_long_long << ','
+                         << mSettings.sizeof_float << ',' << mSettings.sizeof_double << ',' << mSettings.sizeof_long_double << ','
+                         << mSettings.sizeof_wchar_t << ',' << mSettings.sizeof_size_t << ',' << mSettings.sizeof_pointer << ','
+                         << mSettings.defaultSign;
+            settingsChecksum = Checksum::calculate(settingsInfo.str());
+
+            source.assign((std::istreambuf_iterator<char>(fileStream)), std::istreambuf_iterator<char>());
+            sourceChecksum = Checksum::calculate(source);
+
+            std::list<ErrorLogger::ErrorMessage> errors;
+            if (AnalyzerInformation::isUpToDate(mSettings.buildDir, filename, cfgname, settingsChecksum, sourceChecksum, &errors)) {
+                while (!errors.empty()) {
+                    reportErr(errors.front());
+                    errors.pop_front();
+                }
+                return mExitCode;  // known results => no need to tokenize file
+            }
+        }
+
         simplecpp::OutputList outputList;
         std::vector<std::string> files;
-        simplecpp::TokenList tokens1(fileStream, files, filename, &outputList);
+        Timer timerRead("Preprocessor::readFile", mSettings.showtime, &S_timerResults);
+        // The source that was read for the checksum is tokenized without copying it
+        simplecpp::TokenList tokens1 = useInputs ?
+                                       simplecpp::TokenList(source.data(), source.size(), files, filename, &outputList) :
+                                       simplecpp::TokenList(fileStream, files, filename, &outputList);
+        timerRead.Stop();
 
         // If there is a syntax error, report it and stop
         for (const simplecpp::Output &output : outputList) {
@@ -255,7 +529,9 @@ unsigned int CppCheck::checkFile(const std::string& filename, const std::string
             }
         }
 
+        Timer timerLoad("Preprocessor::loadFiles", mSettings.showtime, &S_timerResults);
         preprocessor.loadFiles(tokens1, files);
+        timerLoad.Stop();
 
         if (!mSettings.plistOutput.empty()) {
             std::string filename2;
@@ -318,19 +594,18 @@ unsigned int CppCheck::checkFile(const std::string& filename, const std::string
         if (!mSettings.buildDir.empty()) {
             // Get toolinfo
             std::ostringstream toolinfo;
-            toolinfo << CPPCHECK_VERSION_STRING;
-            toolinfo << (mSettings.isEnabled(Settings::WARNING) ? 'w' : ' ');
-            toolinfo << (mSettings.isEnabled(Settings::STYLE) ? 's' : ' ');
-            toolinfo << (mSettings.isEnabled(Settings::PERFORMANCE) ? 'p' : ' ');
-            toolinfo << (mSettings.isEnabled(Settings::PORTABILITY) ? 'p' : ' ');
-            toolinfo << (mSettings.isEnabled(Settings::INFORMATION) ? 'i' : ' ');
-            toolinfo << mSettings.userDefines;
+            toolinfo << getToolInfo(mSettings);
             mSettings.nomsg.dump(toolinfo);
 
+            // Record the inputs so that the file is not tokenized next time if they are unchanged
+            AnalyzerInformation::Inputs inputs;
+            if (useInputs)
+                inputs = AnalyzerInformation::getInputs(settingsChecksum, sourceChecksum, preprocessor.getHeaders(), preprocessor.getMissingHeaders(tokens1));
+
             // Calculate checksum so it can be compared with old checksum / future checksums
-            const unsigned int checksum = preprocessor.calculateChecksum(tokens1, toolinfo.str());
+            const unsigned long long checksum = preprocessor.calculateChecksum(tokens1, toolinfo.str());
             std::list<ErrorLogger::ErrorMessage> errors;
-            if (!mAnalyzerInformation.analyzeFile(mSettings.buildDir, filename, cfgname, checksum, &errors)) {
+            if (!mAnalyzerInformation.analyzeFile(mSettings.buildDir, filename, cfgname, checksum, &errors, mSettings.analyzerInfoXml, useInputs ? &inputs : nullptr)) {
                 while (!errors.empty()) {
                     reportErr(errors.front());
                     errors.pop_front();
@@ -386,162 +661,224 @@ unsigned int CppCheck::checkFile(const std::string& filename, const std::string
             }
         }
 
+        // With --config-jobs the configurations are preprocessed and tokenized
+        // here and checked by several threads meanwhile. The reports of each
+        // configuration are written in the order of the configurations, so
+        // the results are the same as when they are checked one by one.
+        const bool checkInParallel = mSettings.configJobs > 1 &&
+                                     !mSettings.preprocessOnly &&
+                                     !mSettings.dump && mSettings.addons.empty() &&
+                                     !(mSimplify && hasRule("simple"));
+
+        std::set<unsigned long long> preprocessedChecksums;
         std::set<unsigned long long> checksums;
         unsigned int checkCount = 0;
         bool hasValidConfig = false;
         std::list<std::string> configurationError;
-        for (const std::string &currCfg : configurations) {
-            // bail out if terminated
-            if (mSettings.terminated())
-                break;
-
-            // Check only a few configurations (default 12), after that bail out, unless --force
-            // was used.
-            if (!mSettings.force && ++checkCount > mSettings.maxConfigs)
-                break;
-
-            if (!mSettings.userDefines.empty()) {
-                mCurrentConfig = mSettings.userDefines;
-                const std::vector<std::string> v1(split(mSettings.userDefines, ";"));
-                for (const std::string &cfg: split(currCfg, ";")) {
-                    if (std::find(v1.begin(), v1.end(), cfg) == v1.end()) {
-                        mCurrentConfig += ";" + cfg;
-                    }
-                }
-            } else {
-                mCurrentConfig = currCfg;
-            }
-
-            if (mSettings.preprocessOnly) {
-                Timer t("Preprocessor::getcode", mSettings.showtime, &S_timerResults);
-                std::string codeWithoutCfg = preprocessor.getcode(tokens1, mCurrentConfig, files, true);
-                t.Stop();
-
-                if (codeWithoutCfg.compare(0,5,"#file") == 0)
-                    codeWithoutCfg.insert(0U, "//");
-                std::string::size_type pos = 0;
-                while ((pos = codeWithoutCfg.find("\n#file",pos)) != std::string::npos)
-                    codeWithoutCfg.insert(pos+1U, "//");
-                pos = 0;
-                while ((pos = codeWithoutCfg.find("\n#endfile",pos)) != std::string::npos)
-                    codeWithoutCfg.insert(pos+1U, "//");
-                pos = 0;
-                while ((pos = codeWithoutCfg.find(Preprocessor::macroChar,pos)) != std::string::npos)
-                    codeWithoutCfg[pos] = ' ';
-                reportOut(codeWithoutCfg);
-                continue;
-            }
-
-            Tokenizer mTokenizer(&mSettings, this);
-            if (mSettings.showtime != SHOWTIME_NONE)
-                mTokenizer.setTimerResults(&S_timerResults);
 
+        // Check a configuration after its tokens are created. When the
+        // configurations are checked in parallel, the duplicates are skipped
+        // and the file info is collected when the reports are written.
+        const auto checkConfig = [&](ConfigCheck &configCheck) {
+            Tokenizer &tokenizer = configCheck.tokenizer;
             try {
-                bool result;
-
-                // Create tokens, skip rest of iteration if failed
-                Timer timer("Tokenizer::createTokens", mSettings.showtime, &S_timerResults);
-                const simplecpp::TokenList &tokensP = preprocessor.preprocess(tokens1, mCurrentConfig, files, true);
-                mTokenizer.createTokens(&tokensP);
-                timer.Stop();
-                hasValidConfig = true;
-
-                // If only errors are printed, print filename after the check
-                if (!mSettings.quiet && (!mCurrentConfig.empty() || checkCount > 1)) {
-                    std::string fixedpath = Path::simplifyPath(filename);
-                    fixedpath = Path::toNativeSeparators(fixedpath);
-                    mErrorLogger.reportOut("Checking " + fixedpath + ": " + mCurrentConfig + "...");
-                }
-
-                if (tokensP.empty())
-                    continue;
-
-                // skip rest of iteration if just checking configuration
-                if (mSettings.checkConfiguration)
-                    continue;
+                // skip rest of iteration if there are no tokens or just checking configuration
+                if (!configCheck.tokenized || !tokenizer.tokens() || mSettings.checkConfiguration)
+                    return;
 
                 // Check raw tokens
-                checkRawTokens(mTokenizer);
+                checkRawTokens(tokenizer);
 
                 // Simplify tokens into normal form, skip rest of iteration if failed
                 Timer timer2("Tokenizer::simplifyTokens1", mSettings.showtime, &S_timerResults);
-                result = mTokenizer.simplifyTokens1(mCurrentConfig);
+                const bool result = tokenizer.simplifyTokens1(configCheck.cfg);
                 timer2.Stop();
                 if (!result)
-                    continue;
+                    return;
 
                 // dump xml if --dump
                 if ((mSettings.dump || !mSettings.addons.empty()) && fdump.is_open()) {
-                    fdump << "<dump cfg=\"" << ErrorLogger::toxml(mCurrentConfig) << "\">" << std::endl;
+                    fdump << "<dump cfg=\"" << ErrorLogger::toxml(configCheck.cfg) << "\">" << std::endl;
                     preprocessor.dump(fdump);
-                    mTokenizer.dump(fdump);
+                    tokenizer.dump(fdump);
                     fdump << "</dump>" << std::endl;
                 }
 
                 // Skip if we already met the same simplified token list
                 if (mSettings.force || mSettings.maxConfigs > 1) {
-                    const unsigned long long checksum = mTokenizer.list.calculateChecksum();
-                    if (checksums.find(checksum) != checksums.end()) {
+                    configCheck.checksum = tokenizer.list.calculateChecksum();
+                    configCheck.reportsBeforeCheck = configCheck.reports.size();
+                    if (!checkInParallel && !checksums.insert(configCheck.checksum).second) {
                         if (mSettings.debugwarnings)
-                            purgedConfigurationMessage(filename, mCurrentConfig);
-                        continue;
+                            purgedConfigurationMessage(filename, configCheck.cfg);
+                        return;
                     }
-                    checksums.insert(checksum);
                 }
 
                 // Check normal tokens
-                checkNormalTokens(mTokenizer);
+                checkNormalTokens(tokenizer);
+                configCheck.checked = true;
 
                 // Analyze info..
-                if (!mSettings.buildDir.empty())
-                    checkUnusedFunctions.parseTokens(mTokenizer, filename.c_str(), &mSettings);
+                if (!checkInParallel) {
+                    getFileInfo(tokenizer);
+                    if (!mSettings.buildDir.empty())
+                        checkUnusedFunctions.parseTokens(tokenizer, filename.c_str(), &mSettings);
+                }
 
                 // simplify more if required, skip rest of iteration if failed
                 if (mSimplify && hasRule("simple")) {
                     // if further simplification fails then skip rest of iteration
                     Timer timer3("Tokenizer::simplifyTokenList2", mSettings.showtime, &S_timerResults);
-                    result = mTokenizer.simplifyTokenList2();
+                    const bool result2 = tokenizer.simplifyTokenList2();
                     timer3.Stop();
-                    if (!result)
-                        continue;
+                    if (!result2)
+                        return;
 
                     if (!mSettings.terminated())
-                        executeRules("simple", mTokenizer);
+                        executeRules("simple", tokenizer);
+                }
+            } catch (const InternalError &e) {
+                reportInternalError(filename, tokenizer, e);
+            }
+        };
+
+        // Write the reports of a configuration that was checked in parallel
+        const auto writeConfig = [&](const ConfigCheck &configCheck) {
+            const bool duplicate = configCheck.checked &&
+                                   (mSettings.force || mSettings.maxConfigs > 1) &&
+                                   !checksums.insert(configCheck.checksum).second;
+            const std::size_t numberOfReports = duplicate ? configCheck.reportsBeforeCheck : configCheck.reports.size();
+            for (std::size_t i = 0; i < numberOfReports; ++i) {
+                const ConfigCheck::Report &report = configCheck.reports[i];
+                if (report.isError)
+                    reportErr(report.errmsg);
+                else
+                    reportOut(report.outmsg);
+            }
+            if (duplicate && mSettings.debugwarnings)
+                purgedConfigurationMessage(filename, configCheck.cfg);
+            if (configCheck.exception)
+                std::rethrow_exception(configCheck.exception);
+            if (configCheck.checked && !duplicate) {
+                getFileInfo(configCheck.tokenizer);
+                if (!mSettings.buildDir.empty())
+                    checkUnusedFunctions.parseTokens(configCheck.tokenizer, filename.c_str(), &mSettings);
+            }
+        };
+
+        // Create the tokens of a configuration
+        const auto tokenizeConfig = [&](ConfigCheck &configCheck) {
+            Tokenizer &mTokenizer = configCheck.tokenizer;
+            if (mSettings.showtime != SHOWTIME_NONE || TraceEvents::enabled())
+                mTokenizer.setTimerResults(&S_timerResults);
+
+            // In parallel, the reports are written together with the reports of the checks
+            const CurrentConfigCheck current(checkInParallel ? &configCheck : nullptr);
+
+            try {
+                // Create tokens, skip rest of iteration if failed
+                Timer timer("Tokenizer::createTokens", mSettings.showtime, &S_timerResults);
+                bool duplicate = false;
+                const simplecpp::TokenList &tokensP = preprocessor.preprocess(tokens1, mCurrentConfig, files, true, &duplicate);
+                hasValidConfig = true;
+
+                // Skip if we already met the same preprocessed code
+                if (!duplicate && (mSettings.force || mSettings.maxConfigs > 1) && !tokensP.empty())
+                    duplicate = !preprocessedChecksums.insert(calculateChecksum(tokensP)).second;
+                if (duplicate) {
+                    if (mSettings.debugwarnings)
+                        purgedConfigurationMessage(filename, mCurrentConfig);
+                    if (mSettings.showtime != SHOWTIME_NONE)
+                        S_timerResults.AddCount("Skipped duplicate configurations");
+                    return;
                 }
 
+                mTokenizer.createTokens(&tokensP);
+                configCheck.tokenized = true;
+                timer.Stop();
+
+                // If only errors are printed, print filename after the check
+                if (!mSettings.quiet && (!mCurrentConfig.empty() || checkCount > 1)) {
+                    std::string fixedpath = Path::simplifyPath(filename);
+                    fixedpath = Path::toNativeSeparators(fixedpath);
+                    reportOut("Checking " + fixedpath + ": " + mCurrentConfig + "...");
+                }
             } catch (const simplecpp::Output &o) {
                 // #error etc during preprocessing
                 configurationError.push_back((mCurrentConfig.empty() ? "\'\'" : mCurrentConfig) + " : [" + o.location.file() + ':' + MathLib::toString(o.location.line) + "] " + o.msg);
                 --checkCount; // don't count invalid configurations
-                continue;
 
             } catch (const InternalError &e) {
-                std::list<ErrorLogger::ErrorMessage::FileLocation> locationList;
-                ErrorLogger::ErrorMessage::FileLocation loc;
-                if (e.token) {
-                    loc.line = e.token->linenr();
-                    loc.col = e.token->col();
-                    const std::string fixedpath = Path::toNativeSeparators(mTokenizer.list.file(e.token));
-                    loc.setfile(fixedpath);
-                } else {
-                    ErrorLogger::ErrorMessage::FileLocation loc2;
-                    loc2.setfile(Path::toNativeSeparators(filename));
-                    locationList.push_back(loc2);
-                    loc.setfile(mTokenizer.list.getSourceFilePath());
+                reportInternalError(filename, mTokenizer, e);
+            }
+        };
+
+        std::unique_ptr<ConfigCheckQueue> configCheckQueue;
+        if (checkInParallel) {
+            // The patterns are compiled before the threads share them
+            compileRules(mSettings);
+            configCheckQueue.reset(new ConfigCheckQueue(mSettings.configJobs, checkConfig, writeConfig));
+        }
+
+        for (const std::string &currCfg : configurations) {
+            // bail out if terminated
+            if (mSettings.terminated())
+                break;
+
+            // Check only a few configurations (default 12), after that bail out, unless --force
+            // was used.
+            if (!mSettings.force && ++checkCount > mSettings.maxConfigs)
+                break;
+
+            if (!mSettings.userDefines.empty()) {
+                mCurrentConfig = mSettings.userDefines;
+                const std::vector<std::string> v1(split(mSettings.userDefines, ";"));
+                for (const std::string &cfg: split(currCfg, ";")) {
+                    if (std::find(v1.begin(), v1.end(), cfg) == v1.end()) {
+                        mCurrentConfig += ";" + cfg;
+                    }
                 }
-                locationList.push_back(loc);
-                ErrorLogger::ErrorMessage errmsg(locationList,
-                                                 mTokenizer.list.getSourceFilePath(),
-                                                 Severity::error,
-                                                 e.errorMessage,
-                                                 e.id,
-                                                 false);
+            } else {
+                mCurrentConfig = currCfg;
+            }
 
-                if (errmsg._severity == Severity::error || mSettings.isEnabled(errmsg._severity))
-                    reportErr(errmsg);
+            if (mSettings.preprocessOnly) {
+                Timer t("Preprocessor::getcode", mSettings.showtime, &S_timerResults);
+                std::string codeWithoutCfg = preprocessor.getcode(tokens1, mCurrentConfig, files, true);
+                t.Stop();
+
+                if (codeWithoutCfg.compare(0,5,"#file") == 0)
+                    codeWithoutCfg.insert(0U, "//");
+                std::string::size_type pos = 0;
+                while ((pos = codeWithoutCfg.find("\n#file",pos)) != std::string::npos)
+                    codeWithoutCfg.insert(pos+1U, "//");
+                pos = 0;
+                while ((pos = codeWithoutCfg.find("\n#endfile",pos)) != std::string::npos)
+                    codeWithoutCfg.insert(pos+1U, "//");
+                pos = 0;
+                while ((pos = codeWithoutCfg.find(Preprocessor::macroChar,pos)) != std::string::npos)
+                    codeWithoutCfg[pos] = ' ';
+                reportOut(codeWithoutCfg);
+                continue;
+            }
+
+            if (checkInParallel) {
+                // At most configJobs configurations are kept
+                configCheckQueue->write(mSettings.configJobs - 1U);
+                ConfigCheck &configCheck = configCheckQueue->emplace(&mSettings, static_cast<ErrorLogger *>(this), mCurrentConfig);
+                tokenizeConfig(configCheck);
+                configCheckQueue->push(configCheck);
+            } else {
+                ConfigCheck configCheck(&mSettings, static_cast<ErrorLogger *>(this), mCurrentConfig);
+                tokenizeConfig(configCheck);
+                checkConfig(configCheck);
             }
         }
 
+        if (checkInParallel)
+            configCheckQueue->write(0);
+
         if (!hasValidConfig && configurations.size() > 1 && mSettings.isEnabled(Settings::INFORMATION)) {
             std::string msg;
             msg = "This file is not analyzed. Cppcheck failed to extract a valid configuration. Use -v for more details.";
@@ -576,7 +913,9 @@ unsigned int CppCheck::checkFile(const std::string& filename, const std::string
                     reportOut(failedToGetAddonInfo);
                     continue;
                 }
+                Timer timerAddon("CppCheck::executeAddon::" + addonInfo.name, mSettings.showtime, &S_timerResults);
                 const std::string &results = executeAddon(addonInfo, dumpFile);
+                timerAddon.Stop();
                 for (std::string::size_type pos = 0; pos < results.size();) {
                     const std::string::size_type pos2 = results.find("\n", pos);
                     if (pos2 == std::string::npos)
@@ -654,7 +993,7 @@ unsigned int CppCheck::checkFile(const std::string& filename, const std::string
         mExitCode=1; // e.g. reflect a syntax error
     }
 
-    mAnalyzerInformation.setFileInfo("CheckUnusedFunctions", checkUnusedFunctions.analyzerInfo());
+    mAnalyzerInformation.setFileInfo("CheckUnusedFunctions", mSettings.analyzerInfoXml ? checkUnusedFunctions.analyzerInfo() : checkUnusedFunctions.analyzerInfoBinary());
     mAnalyzerInformation.close();
 
     // In jointSuppressionReport mode, unmatched suppressions are
@@ -691,6 +1030,33 @@ void CppCheck::internalError(const std::string &filename, const std::string &msg
     }
 }
 
+void CppCheck::reportInternalError(const std::string &filename, const Tokenizer &tokenizer, const InternalError &e)
+{
+    std::list<ErrorLogger::ErrorMessage::FileLocation> locationList;
+    ErrorLogger::ErrorMessage::FileLocation loc;
+    if (e.token) {
+        loc.line = e.token->linenr();
+        loc.col = e.token->col();
+        const std::string fixedpath = Path::toNativeSeparators(tokenizer.list.file(e.token));
+        loc.setfile(fixedpath);
+    } else {
+        ErrorLogger::ErrorMessage::FileLocation loc2;
+        loc2.setfile(Path::toNativeSeparators(filename));
+        locationList.push_back(loc2);
+        loc.setfile(tokenizer.list.getSourceFilePath());
+    }
+    locationList.push_back(loc);
+    ErrorLogger::ErrorMessage errmsg(locationList,
+                                     tokenizer.list.getSourceFilePath(),
+                                     Severity::error,
+                                     e.errorMessage,
+                                     e.id,
+                                     false);
+
+    if (errmsg._severity == Severity::error || mSettings.isEnabled(errmsg._severity))
+        reportErr(errmsg);
+}
+
 //---------------------------------------------------------------------------
 // CppCheck - A function that checks a raw token list
 //---------------------------------------------------------------------------
@@ -718,23 +1084,36 @@ void CppCheck::checkNormalTokens(const Tokenizer &tokenizer)
         check->runChecks(&tokenizer, &mSettings, this);
     }
 
-    // Analyse the tokens..
+    executeRules("normal", tokenizer);
+}
 
+//---------------------------------------------------------------------------
+// CppCheck - Get the information for the whole program analysis
+//---------------------------------------------------------------------------
+
+void CppCheck::getFileInfo(const Tokenizer &tokenizer)
+{
     CTU::FileInfo *fi1 = CTU::getFileInfo(&tokenizer);
     if (fi1) {
         mFileInfo.push_back(fi1);
-        mAnalyzerInformation.setFileInfo("ctu", fi1->toString());
+        mAnalyzerInformation.setFileInfo("ctu", mSettings.analyzerInfoXml ? fi1->toString() : fi1->toBinary());
     }
 
     for (const Check *check : Check::instances()) {
         Check::FileInfo *fi = check->getFileInfo(&tokenizer, &mSettings);
         if (fi != nullptr) {
             mFileInfo.push_back(fi);
-            mAnalyzerInformation.setFileInfo(check->name(), fi->toString());
+            mAnalyzerInformation.setFileInfo(check->name(), mSettings.analyzerInfoXml ? fi->toString() : fi->toBinary());
         }
     }
+}
 
-    executeRules("normal", tokenizer);
+void CppCheck::clearFileInfo()
+{
+    while (!mFileInfo.empty()) {
+        delete mFileInfo.back();
+        mFileInfo.pop_back();
+    }
 }
 
 //---------------------------------------------------------------------------
@@ -884,9 +1263,189 @@ static const char * pcreErrorCodeToString(const int pcreExecRet)
     return "";
 }
 
+/** Compiled and studied --rule pattern */
+class CompiledRule {
+public:
+    explicit CompiledRule(const std::string &pattern)
+        : re(nullptr), extra(nullptr) {
+        const char *pcreCompileErrorStr = nullptr;
+        int erroffset = 0;
+        re = pcre_compile(pattern.c_str(),0,&pcreCompileErrorStr,&erroffset,nullptr);
+        if (!re) {
+            if (pcreCompileErrorStr) {
+                errorId = "pcre_compile";
+                errorMessage = "pcre_compile failed: " + std::string(pcreCompileErrorStr);
+            }
+            return;
+        }
+
+        // Optimize the regex, but only if PCRE_CONFIG_JIT is available
+#ifdef PCRE_CONFIG_JIT
+        const char *pcreStudyErrorStr = nullptr;
+        extra = pcre_study(re, PCRE_STUDY_JIT_COMPILE, &pcreStudyErrorStr);
+        // pcre_study() returns NULL for both errors and when it can not optimize the regex.
+        // The last argument is how one checks for errors.
+        // It is NULL if everything works, and points to an error string otherwise.
+        if (pcreStudyErrorStr) {
+            errorId = "pcre_study";
+            errorMessage = "pcre_study failed: " + std::string(pcreStudyErrorStr);
+            // pcre_compile() worked, but pcre_study() returned an error. Free the resources allocated by pcre_compile().
+            pcre_free(re);
+            re = nullptr;
+        }
+#endif
+    }
+
+    ~CompiledRule() {
+        if (re)
+            pcre_free(re);
+#ifdef PCRE_CONFIG_JIT
+        // Free up the EXTRA PCRE value (may be NULL at this point)
+        if (extra)
+            pcre_free_study(extra);
+#endif
+    }
+
+    /** Compiled pattern, null if the compilation failed */
+    pcre *re;
+
+    /** Result of pcre_study(), may be null */
+    pcre_extra *extra;
+
+    /** Set if the compilation failed, reported each time the rule is used */
+    std::string errorId;
+    std::string errorMessage;
+
+private:
+    CompiledRule(const CompiledRule &) = delete;
+    CompiledRule &operator=(const CompiledRule &) = delete;
+};
+
 #endif // HAVE_RULES
 
 
+bool CppCheck::isCombinable(const std::string &pattern)
+{
+    if (pattern.find("(*") != std::string::npos)
+        return false;
+    for (std::string::size_type pos = 0; pos + 1U < pattern.size(); ++pos) {
+        const char c = pattern[pos + 1U];
+        if (pattern[pos] == '\\') {
+            if (std::isdigit(static_cast<unsigned char>(c)) || c == 'g' || c == 'k' || c == 'G')
+                return false;
+            // skip the escaped character
+            ++pos;
+        } else if (pattern[pos] == '(' && c == '?' && pos + 2U < pattern.size()) {
+            if (std::strchr("PR&+-(0123456789C", pattern[pos + 2U]))
+                return false;
+            // In extended mode a # comment would swallow the rest of the combined pattern
+            const std::string::size_type end = pattern.find_first_not_of("imsxJU-", pos + 2U);
+            if (end != std::string::npos && (pattern[end] == ')' || pattern[end] == ':') && pattern.find('x', pos + 2U) < end)
+                return false;
+        }
+    }
+    return true;
+}
+
+std::string CppCheck::combinePatterns(const std::vector<std::string> &patterns)
+{
+    // The atomic group keeps the first match of the pattern at a position,
+    // which is the match that the pattern finds alone
+    std::string combined;
+    for (std::size_t i = 0; i < patterns.size(); ++i) {
+        if (i > 0)
+            combined += '|';
+        combined += "(?>(?:" + patterns[i] + "))(*MARK:" + std::to_string(i) + ")(?C)";
+    }
+    return combined;
+}
+
+#ifdef HAVE_RULES
+namespace {
+    /** The matches of the combined rules, collected by combinedRulesCallout() */
+    struct CombinedMatches {
+        explicit CombinedMatches(std::size_t numberOfRules) : nextStart(numberOfRules, 0) {}
+
+        struct Match {
+            Match(std::size_t r, int s, int e) : rule(r), start(s), end(e) {}
+            std::size_t rule;
+            int start;
+            int end;
+        };
+
+        /** Where the next match of each rule may start. A rule alone continues after its match. */
+        std::vector<int> nextStart;
+
+        /** The matches in the order they are found */
+        std::vector<Match> matches;
+    };
+}
+
+/** Record the match of a combined rule and reject it so the scan goes on */
+static int combinedRulesCallout(pcre_callout_block *block)
+{
+    // Callouts of the rules that are not combined are ignored
+    CombinedMatches *combinedMatches = static_cast<CombinedMatches *>(block->callout_data);
+    if (!combinedMatches || block->version < 2 || !block->mark)
+        return 0;
+    const std::size_t rule = std::strtoul(reinterpret_cast<const char *>(block->mark), nullptr, 10);
+    if (rule < combinedMatches->nextStart.size() && block->start_match >= combinedMatches->nextStart[rule]) {
+        combinedMatches->matches.emplace_back(rule, block->start_match, block->current_position);
+        combinedMatches->nextStart[rule] = std::max(block->current_position, block->start_match + 1);
+    }
+    return 1;
+}
+#endif
+
+void CppCheck::compileRules(Settings &settings)
+{
+#ifdef HAVE_RULES
+    bool compiled = false;
+    for (Settings::Rule &rule : settings.rules) {
+        if (!rule.compiled && !rule.pattern.empty()) {
+            rule.compiled = std::make_shared<CompiledRule>(rule.pattern);
+            compiled = true;
+        }
+    }
+    if (!compiled)
+        return;
+
+    // Combine the rules of each token list in one pattern
+    const auto isCombinableRule = [](const Settings::Rule &rule) {
+        return !rule.pattern.empty() && !rule.id.empty() && rule.severity != Severity::none &&
+               rule.compiled && rule.compiled->re && isCombinable(rule.pattern);
+    };
+    std::map<std::string, std::vector<std::string> > patterns;
+    for (const Settings::Rule &rule : settings.rules) {
+        if (isCombinableRule(rule))
+            patterns[rule.tokenlist].push_back(rule.pattern);
+    }
+
+    std::map<std::string, std::shared_ptr<const CompiledRule> > combined;
+    for (std::map<std::string, std::vector<std::string> >::const_iterator it = patterns.begin(); it != patterns.end(); ++it) {
+        if (it->second.size() < 2U)
+            continue;
+        const std::shared_ptr<const CompiledRule> compiledPattern = std::make_shared<CompiledRule>(combinePatterns(it->second));
+        if (compiledPattern->re)
+            combined[it->first] = compiledPattern;
+    }
+
+    for (Settings::Rule &rule : settings.rules) {
+        const std::map<std::string, std::shared_ptr<const CompiledRule> >::const_iterator it = combined.find(rule.tokenlist);
+        if (it != combined.end() && isCombinableRule(rule))
+            rule.combined = it->second;
+        else
+            rule.combined.reset();
+    }
+
+    // The callout records the matches of the combined patterns
+    if (!combined.empty())
+        pcre_callout = combinedRulesCallout;
+#else
+    (void)settings;
+#endif
+}
+
 void CppCheck::executeRules(const std::string &tokenlist, const Tokenizer &tokenizer)
 {
     (void)tokenlist;
@@ -897,75 +1456,114 @@ void CppCheck::executeRules(const std::string &tokenlist, const Tokenizer &token
     if (!hasRule(tokenlist))
         return;
 
-    // Write all tokens in a string that can be parsed by pcre
-    std::ostringstream ostr;
-    for (const Token *tok = tokenizer.tokens(); tok; tok = tok->next())
-        ostr << " " << tok->str();
-    const std::string str(ostr.str());
+    // Write all tokens in a string that can be parsed by pcre. Save the end
+    // offset of each token so matches can be mapped back to tokens.
+    std::string str;
+    std::vector<const Token *> tokens;
+    std::vector<std::size_t> tokenEnds;
+    for (const Token *tok = tokenizer.tokens(); tok; tok = tok->next()) {
+        str += ' ';
+        str += tok->str();
+        tokens.push_back(tok);
+        tokenEnds.push_back(str.size());
+    }
+
+    // Compile the patterns once, they are shared by all configurations and files
+    compileRules(mSettings);
+
+    const auto reportExecError = [&](int pcreExecRet) {
+        const std::string errorMessage = pcreErrorCodeToString(pcreExecRet);
+        if (!errorMessage.empty()) {
+            const ErrorLogger::ErrorMessage errmsg(std::list<ErrorLogger::ErrorMessage::FileLocation>(),
+                                                   emptyString,
+                                                   Severity::error,
+                                                   std::string("pcre_exec failed: ") + errorMessage,
+                                                   "pcre_exec",
+                                                   false);
+
+            reportErr(errmsg);
+        }
+    };
+
+    const auto reportMatch = [&](const Settings::Rule &rule, unsigned int pos1, unsigned int pos2) {
+        // determine location..
+        ErrorLogger::ErrorMessage::FileLocation loc;
+        loc.setfile(tokenizer.list.getSourceFilePath());
+        loc.line = 0;
+
+        // the match starts in the first token that ends after pos1
+        const std::vector<std::size_t>::const_iterator tokenEnd = std::upper_bound(tokenEnds.begin(), tokenEnds.end(), pos1);
+        if (tokenEnd != tokenEnds.end()) {
+            const Token *tok = tokens[tokenEnd - tokenEnds.begin()];
+            loc.setfile(tokenizer.list.getFiles().at(tok->fileIndex()));
+            loc.line = tok->linenr();
+        }
+
+        const std::list<ErrorLogger::ErrorMessage::FileLocation> callStack(1, loc);
+
+        // Create error message
+        std::string summary;
+        if (rule.summary.empty())
+            summary = "found '" + str.substr(pos1, pos2 - pos1) + "'";
+        else
+            summary = rule.summary;
+        const ErrorLogger::ErrorMessage errmsg(callStack, tokenizer.list.getSourceFilePath(), rule.severity, summary, rule.id, false);
+
+        // Report error
+        reportErr(errmsg);
+    };
+
+    // Scan the string once for all combined rules, in the order of their patterns
+    std::vector<const Settings::Rule *> combinedRules;
+    for (const Settings::Rule &rule : mSettings.rules) {
+        if (rule.combined && rule.tokenlist == tokenlist)
+            combinedRules.push_back(&rule);
+    }
+    if (!combinedRules.empty()) {
+        const CompiledRule &combined = *combinedRules.front()->combined;
+        CombinedMatches combinedMatches(combinedRules.size());
+        pcre_extra extra = pcre_extra();
+        if (combined.extra)
+            extra = *combined.extra;
+        extra.flags |= PCRE_EXTRA_CALLOUT_DATA;
+        extra.callout_data = &combinedMatches;
+
+        // The callout rejects every match, so there is no match when the scan is done
+        int ovector[30]= {0};
+        const int pcreExecRet = pcre_exec(combined.re, &extra, str.c_str(), (int)str.size(), 0, 0, ovector, 30);
+        if (pcreExecRet != PCRE_ERROR_NOMATCH)
+            reportExecError(pcreExecRet);
+        for (const CombinedMatches::Match &match : combinedMatches.matches)
+            reportMatch(*combinedRules[match.rule], (unsigned int)match.start, (unsigned int)match.end);
+    }
 
     for (const Settings::Rule &rule : mSettings.rules) {
-        if (rule.pattern.empty() || rule.id.empty() || rule.severity == Severity::none || rule.tokenlist != tokenlist)
+        if (rule.pattern.empty() || rule.id.empty() || rule.severity == Severity::none || rule.tokenlist != tokenlist || rule.combined)
             continue;
 
-        const char *pcreCompileErrorStr = nullptr;
-        int erroffset = 0;
-        pcre * const re = pcre_compile(rule.pattern.c_str(),0,&pcreCompileErrorStr,&erroffset,nullptr);
-        if (!re) {
-            if (pcreCompileErrorStr) {
-                const std::string msg = "pcre_compile failed: " + std::string(pcreCompileErrorStr);
+        const CompiledRule &compiled = *rule.compiled;
+        if (!compiled.re) {
+            if (!compiled.errorMessage.empty()) {
                 const ErrorLogger::ErrorMessage errmsg(std::list<ErrorLogger::ErrorMessage::FileLocation>(),
                                                        emptyString,
                                                        Severity::error,
-                                                       msg,
-                                                       "pcre_compile",
+                                                       compiled.errorMessage,
+                                                       compiled.errorId,
                                                        false);
 
                 reportErr(errmsg);
             }
             continue;
         }
-
-        // Optimize the regex, but only if PCRE_CONFIG_JIT is available
-#ifdef PCRE_CONFIG_JIT
-        const char *pcreStudyErrorStr = nullptr;
-        pcre_extra * const pcreExtra = pcre_study(re, PCRE_STUDY_JIT_COMPILE, &pcreStudyErrorStr);
-        // pcre_study() returns NULL for both errors and when it can not optimize the regex.
-        // The last argument is how one checks for errors.
-        // It is NULL if everything works, and points to an error string otherwise.
-        if (pcreStudyErrorStr) {
-            const std::string msg = "pcre_study failed: " + std::string(pcreStudyErrorStr);
-            const ErrorLogger::ErrorMessage errmsg(std::list<ErrorLogger::ErrorMessage::FileLocation>(),
-                                                   emptyString,
-                                                   Severity::error,
-                                                   msg,
-                                                   "pcre_study",
-                                                   false);
-
-            reportErr(errmsg);
-            // pcre_compile() worked, but pcre_study() returned an error. Free the resources allocated by pcre_compile().
-            pcre_free(re);
-            continue;
-        }
-#else
-        const pcre_extra * const pcreExtra = nullptr;
-#endif
+        pcre * const re = compiled.re;
+        pcre_extra * const pcreExtra = compiled.extra;
 
         int pos = 0;
         int ovector[30]= {0};
         while (pos < (int)str.size()) {
             const int pcreExecRet = pcre_exec(re, pcreExtra, str.c_str(), (int)str.size(), pos, 0, ovector, 30);
             if (pcreExecRet < 0) {
-                const std::string errorMessage = pcreErrorCodeToString(pcreExecRet);
-                if (!errorMessage.empty()) {
-                    const ErrorLogger::ErrorMessage errmsg(std::list<ErrorLogger::ErrorMessage::FileLocation>(),
-                                                           emptyString,
-                                                           Severity::error,
-                                                           std::string("pcre_exec failed: ") + errorMessage,
-                                                           "pcre_exec",
-                                                           false);
-
-                    reportErr(errmsg);
-                }
+                reportExecError(pcreExecRet);
                 break;
             }
             const unsigned int pos1 = (unsigned int)ovector[0];
@@ -974,42 +1572,8 @@ void CppCheck::executeRules(const std::string &tokenlist, const Tokenizer &token
             // jump to the end of the match for the next pcre_exec
             pos = (int)pos2;
 
-            // determine location..
-            ErrorLogger::ErrorMessage::FileLocation loc;
-            loc.setfile(tokenizer.list.getSourceFilePath());
-            loc.line = 0;
-
-            std::size_t len = 0;
-            for (const Token *tok = tokenizer.tokens(); tok; tok = tok->next()) {
-                len = len + 1U + tok->str().size();
-                if (len > pos1) {
-                    loc.setfile(tokenizer.list.getFiles().at(tok->fileIndex()));
-                    loc.line = tok->linenr();
-                    break;
-                }
-            }
-
-            const std::list<ErrorLogger::ErrorMessage::FileLocation> callStack(1, loc);
-
-            // Create error message
-            std::string summary;
-            if (rule.summary.empty())
-                summary = "found '" + str.substr(pos1, pos2 - pos1) + "'";
-            else
-                summary = rule.summary;
-            const ErrorLogger::ErrorMessage errmsg(callStack, tokenizer.list.getSourceFilePath(), rule.severity, summary, rule.id, false);
-
-            // Report error
-            reportErr(errmsg);
-        }
-
-        pcre_free(re);
-#ifdef PCRE_CONFIG_JIT
-        // Free up the EXTRA PCRE value (may be NULL at this point)
-        if (pcreExtra) {
-            pcre_free_study(pcreExtra);
+            reportMatch(rule, pos1, pos2);
         }
-#endif
     }
 #endif
 }
@@ -1088,17 +1652,23 @@ void CppCheck::purgedConfigurationMessage(const std::string &file, const std::st
 
 void CppCheck::reportErr(const ErrorLogger::ErrorMessage &msg)
 {
+    if (currentConfigCheck) {
+        currentConfigCheck->reports.emplace_back(msg);
+        return;
+    }
+
     mSuppressInternalErrorFound = false;
 
     if (!mSettings.library.reportErrors(msg.file0))
         return;
 
-    const std::string errmsg = msg.toString(mSettings.verbose);
-    if (errmsg.empty())
+    // Nothing to report
+    if (msg._callStack.empty() && msg._severity == Severity::none && (mSettings.verbose ? msg.verboseMessage() : msg.shortMessage()).empty())
         return;
 
     // Alert only about unique errors
-    if (std::find(mErrorList.begin(), mErrorList.end(), errmsg) != mErrorList.end())
+    std::string errmsg = msg.uniqueKey(mSettings.verbose);
+    if (mErrorList.find(errmsg) != mErrorList.end())
         return;
 
     const Suppressions::ErrorMessage errorMessage = msg.toSuppressionsErrorMessage();
@@ -1119,7 +1689,7 @@ void CppCheck::reportErr(const ErrorLogger::ErrorMessage &msg)
         mExitCode = 1;
     }
 
-    mErrorList.push_back(errmsg);
+    mErrorList.insert(std::move(errmsg));
 
     mErrorLogger.reportErr(msg);
     mAnalyzerInformation.reportErr(msg, mSettings.verbose);
@@ -1130,11 +1700,17 @@ void CppCheck::reportErr(const ErrorLogger::ErrorMessage &msg)
 
 void CppCheck::reportOut(const std::string &outmsg)
 {
+    if (currentConfigCheck) {
+        currentConfigCheck->reports.emplace_back(outmsg);
+        return;
+    }
+
     mErrorLogger.reportOut(outmsg);
 }
 
 void CppCheck::reportProgress(const std::string &filename, const char stage[], const std::size_t value)
 {
+    std::lock_guard<std::mutex> lock(reportProgressMutex);
     mErrorLogger.reportProgress(filename, stage, value);
 }
 
@@ -1190,17 +1766,73 @@ bool CppCheck::analyseWholeProgram()
     return errors && (mExitCode > 0);
 }
 
+namespace {
+    /** Whole program analysis data of a file in the build dir */
+    struct AnalyzerInfoData {
+        explicit AnalyzerInfoData(const std::string &f, const std::string &s) : analyzerInfoFile(f), sourcefile(s), xml(false) {}
+
+        std::string analyzerInfoFile;
+        std::string sourcefile;
+        CTU::FileInfo ctuFileInfo;
+        std::list<Check::FileInfo*> fileInfoList;
+
+        /** The data of CheckUnusedFunctions::analyzerInfo() or analyzerInfoBinary() */
+        std::string unusedFunctions;
+        bool xml;
+    };
+}
+
+static void loadAnalyzerInfo(AnalyzerInfoData &data)
+{
+    AnalyzerInformation::Info info;
+    if (!AnalyzerInformation::readFile(data.analyzerInfoFile, &info))
+        return;
+
+    data.xml = info.xml;
+    for (const std::pair<std::string, std::string> &fileInfo : info.fileInfo) {
+        if (fileInfo.first == "CheckUnusedFunctions") {
+            data.unusedFunctions = fileInfo.second;
+            continue;
+        }
+
+        if (!info.xml) {
+            if (fileInfo.first == "ctu") {
+                data.ctuFileInfo.loadFromBinary(fileInfo.second);
+                continue;
+            }
+            for (const Check *check : Check::instances()) {
+                if (fileInfo.first == check->name())
+                    data.fileInfoList.push_back(check->loadFileInfoFromBinary(fileInfo.second));
+            }
+            continue;
+        }
+
+        tinyxml2::XMLDocument doc;
+        const std::string xml("<FileInfo>" + fileInfo.second + "</FileInfo>");
+        if (doc.Parse(xml.data(), xml.size()) != tinyxml2::XML_SUCCESS)
+            continue;
+        const tinyxml2::XMLElement * const e = doc.FirstChildElement();
+        if (fileInfo.first == "ctu") {
+            data.ctuFileInfo.loadFromXml(e);
+            continue;
+        }
+        for (const Check *check : Check::instances()) {
+            if (fileInfo.first == check->name())
+                data.fileInfoList.push_back(check->loadFileInfoFromXml(e));
+        }
+    }
+}
+
 void CppCheck::analyseWholeProgram(const std::string &buildDir, const std::map<std::string, std::size_t> &files)
 {
     (void)files;
     if (buildDir.empty())
         return;
-    if (mSettings.isEnabled(Settings::UNUSED_FUNCTION))
-        CheckUnusedFunctions::analyseWholeProgram(this, buildDir);
-    std::list<Check::FileInfo*> fileInfoList;
-    CTU::FileInfo ctuFileInfo;
+
+    Timer timer("CppCheck::analyseWholeProgram", mSettings.showtime, &S_timerResults);
 
     // Load all analyzer info data..
+    std::vector<AnalyzerInfoData> analyzerInfo;
     const std::string filesTxt(buildDir + "/files.txt");
     std::ifstream fin(filesTxt);
     std::string filesTxtLine;
@@ -1208,38 +1840,40 @@ void CppCheck::analyseWholeProgram(const std::string &buildDir, const std::map<s
         const std::string::size_type firstColon = filesTxtLine.find(':');
         if (firstColon == std::string::npos)
             continue;
-        const std::string::size_type lastColon = filesTxtLine.rfind(':');
-        if (firstColon == lastColon)
-            continue;
-        const std::string xmlfile = buildDir + '/' + filesTxtLine.substr(0,firstColon);
-        //const std::string sourcefile = filesTxtLine.substr(lastColon+1);
-
-        tinyxml2::XMLDocument doc;
-        const tinyxml2::XMLError error = doc.LoadFile(xmlfile.c_str());
-        if (error != tinyxml2::XML_SUCCESS)
-            continue;
-
-        const tinyxml2::XMLElement * const rootNode = doc.FirstChildElement();
-        if (rootNode == nullptr)
+        const std::string::size_type secondColon = filesTxtLine.find(':', firstColon + 1);
+        if (secondColon == std::string::npos)
             continue;
+        analyzerInfo.emplace_back(buildDir + '/' + filesTxtLine.substr(0, firstColon), filesTxtLine.substr(secondColon + 1));
+    }
 
-        for (const tinyxml2::XMLElement *e = rootNode->FirstChildElement(); e; e = e->NextSiblingElement()) {
-            if (std::strcmp(e->Name(), "FileInfo") != 0)
-                continue;
-            const char *checkClassAttr = e->Attribute("check");
-            if (!checkClassAttr)
-                continue;
-            if (std::strcmp(checkClassAttr, "ctu") == 0) {
-                ctuFileInfo.loadFromXml(e);
-                continue;
-            }
-            for (Check *check : Check::instances()) {
-                if (checkClassAttr == check->name())
-                    fileInfoList.push_back(check->loadFileInfoFromXml(e));
-            }
-        }
+    // The files are loaded by the -j threads and combined in the order of files.txt
+    std::atomic<std::size_t> nextFile(0);
+    const auto work = [&]() {
+        for (std::size_t i = nextFile++; i < analyzerInfo.size(); i = nextFile++)
+            loadAnalyzerInfo(analyzerInfo[i]);
+    };
+    std::vector<std::thread> threads;
+    const std::size_t numberOfThreads = std::min<std::size_t>(mSettings.jobs, analyzerInfo.size());
+    for (std::size_t i = 1; i < numberOfThreads; ++i)
+        threads.emplace_back(work);
+    work();
+    for (std::thread &thread : threads)
+        thread.join();
+
+    std::list<CheckUnusedFunctions::AnalyzerInfo> unusedFunctions;
+    std::list<Check::FileInfo*> fileInfoList;
+    CTU::FileInfo ctuFileInfo;
+    for (AnalyzerInfoData &data : analyzerInfo) {
+        if (!data.unusedFunctions.empty())
+            unusedFunctions.emplace_back(data.sourcefile, data.unusedFunctions, data.xml);
+        ctuFileInfo.functionCalls.splice(ctuFileInfo.functionCalls.end(), data.ctuFileInfo.functionCalls);
+        ctuFileInfo.nestedCalls.splice(ctuFileInfo.nestedCalls.end(), data.ctuFileInfo.nestedCalls);
+        fileInfoList.splice(fileInfoList.end(), data.fileInfoList);
     }
 
+    if (mSettings.isEnabled(Settings::UNUSED_FUNCTION))
+        CheckUnusedFunctions::analyseWholeProgram(this, unusedFunctions);
+
     // Set CTU max depth
     CTU::maxCtuDepth = mSettings.maxCtuDepth;
 
@@ -33,8 +33,11 @@
 #include <list>
 #include <map>
 #include <string>
+#include <unordered_set>
+#include <vector>
 
 class Tokenizer;
+class TimerResults;
 
 /// @addtogroup Core
 /// @{
@@ -46,6 +49,7 @@ class Tokenizer;
  * Usage: See check() for more info.
  */
 class CPPCHECKLIB CppCheck : ErrorLogger {
+    friend class TestCppcheck; // For testing only
 public:
     /**
      * @brief Constructor.
@@ -136,6 +140,12 @@ public:
      */
     bool analyseWholeProgram();
 
+    /** Free the file info that was collected for the whole program analysis.
+     * A worker that checks many files for another process calls this after
+     * each file since it never runs the whole program analysis itself.
+     */
+    void clearFileInfo();
+
     /** analyse whole program use .analyzeinfo files */
     void analyseWholeProgram(const std::string &buildDir, const std::map<std::string, std::size_t> &files);
 
@@ -143,6 +153,19 @@ public:
      * and if it's possible at all */
     bool isUnusedFunctionCheckEnabled() const;
 
+    /**
+     * @brief Compile the patterns of the --rule options that are not compiled yet.
+     * Call this before the settings are copied to several CppCheck instances
+     * (threads or child processes) so they all use the same compiled patterns.
+     */
+    static void compileRules(Settings &settings);
+
+    /**
+     * @brief The --showtime results of this process. ThreadExecutor
+     * children send them to the parent process that shows them.
+     */
+    static TimerResults &timerResults();
+
 private:
 
     /** Are there "simple" rules */
@@ -151,6 +174,9 @@ private:
     /** @brief There has been an internal error => Report information message */
     void internalError(const std::string &filename, const std::string &msg);
 
+    /** @brief Report an InternalError that is thrown while a configuration is checked */
+    void reportInternalError(const std::string &filename, const Tokenizer &tokenizer, const InternalError &e);
+
     /**
      * @brief Check a file using stream
      * @param filename file name
@@ -172,6 +198,12 @@ private:
      */
     void checkNormalTokens(const Tokenizer &tokenizer);
 
+    /**
+     * @brief Get the information for the whole program analysis
+     * @param tokenizer tokenizer instance
+     */
+    void getFileInfo(const Tokenizer &tokenizer);
+
     /**
      * @brief Execute rules, if any
      * @param tokenlist token list to use (normal / simple)
@@ -179,6 +211,24 @@ private:
      */
     void executeRules(const std::string &tokenlist, const Tokenizer &tokenizer);
 
+    /**
+     * @brief Can the pattern of a rule be a part of a combined pattern? The
+     * group numbers and the start offset are different in the combined
+     * pattern, backtracking verbs and callouts could stop the other rules
+     * from matching, and in extended mode a comment would hide the end of
+     * the group that the pattern is put in.
+     */
+    static bool isCombinable(const std::string &pattern);
+
+    /**
+     * @brief Combine the patterns of the rules of a token list, so the token
+     * string is scanned once for all of them. Each match is tagged with
+     * (*MARK:n), n being the index of the pattern, and passed to a callout
+     * that records it and rejects it, so the scan goes on and finds the
+     * matches of all patterns.
+     */
+    static std::string combinePatterns(const std::vector<std::string> &patterns);
+
     /**
      * @brief Errors and warnings are directed here.
      *
@@ -195,7 +245,8 @@ private:
      */
     virtual void reportOut(const std::string &outmsg) OVERRIDE;
 
-    std::list<std::string> mErrorList;
+    /** Keys of the reported errors, see ErrorLogger::ErrorMessage::uniqueKey() */
+    std::unordered_set<std::string> mErrorList;
     Settings mSettings;
 
     void reportProgress(const std::string &filename, const char stage[], const std::size_t value) OVERRIDE;
@@ -21,6 +21,7 @@
 #include "ctu.h"
 #include "astutils.h"
 #include "symboldatabase.h"
+#include "utils.h"
 #include <tinyxml2.h>
 #include <iterator>  // back_inserter
 //---------------------------------------------------------------------------
@@ -257,6 +258,137 @@ std::list<CTU::FileInfo::UnsafeUsage> CTU::loadUnsafeUsageListFromXml(const tiny
     return ret;
 }
 
+// Signed numbers are written as their two's complement
+static long long readSigned(BinaryReader &reader)
+{
+    return static_cast<long long>(reader.number());
+}
+
+std::string CTU::FileInfo::toBinary() const
+{
+    std::string out;
+    serializeNumber(out, functionCalls.size());
+    for (const CTU::FileInfo::FunctionCall &functionCall : functionCalls)
+        functionCall.toBinary(out);
+    serializeNumber(out, nestedCalls.size());
+    for (const CTU::FileInfo::NestedCall &nestedCall : nestedCalls)
+        nestedCall.toBinary(out);
+    return out;
+}
+
+void CTU::FileInfo::CallBase::baseToBinary(std::string &out) const
+{
+    serializeString(out, callId);
+    serializeString(out, callFunctionName);
+    serializeNumber(out, static_cast<unsigned long long>(callArgNr));
+    serializeString(out, location.fileName);
+    serializeNumber(out, location.linenr);
+}
+
+void CTU::FileInfo::FunctionCall::toBinary(std::string &out) const
+{
+    baseToBinary(out);
+    serializeString(out, callArgumentExpression);
+    serializeNumber(out, callValueType);
+    serializeNumber(out, static_cast<unsigned long long>(callArgValue));
+    serializeNumber(out, warning ? 1 : 0);
+    serializeNumber(out, callValuePath.size());
+    for (const ErrorLogger::ErrorMessage::FileLocation &loc : callValuePath) {
+        serializeString(out, loc.getfile(false));
+        serializeNumber(out, loc.line);
+        serializeString(out, loc.getinfo());
+    }
+}
+
+void CTU::FileInfo::NestedCall::toBinary(std::string &out) const
+{
+    baseToBinary(out);
+    serializeString(out, myId);
+    serializeNumber(out, myArgNr);
+}
+
+void CTU::toBinary(std::string &out, const std::list<CTU::FileInfo::UnsafeUsage> &unsafeUsage)
+{
+    serializeNumber(out, unsafeUsage.size());
+    for (const CTU::FileInfo::UnsafeUsage &u : unsafeUsage) {
+        serializeString(out, u.myId);
+        serializeNumber(out, u.myArgNr);
+        serializeString(out, u.myArgumentName);
+        serializeString(out, u.location.fileName);
+        serializeNumber(out, u.location.linenr);
+        serializeNumber(out, static_cast<unsigned long long>(u.value));
+    }
+}
+
+bool CTU::FileInfo::CallBase::loadBaseFromBinary(BinaryReader &reader)
+{
+    callId = reader.string();
+    callFunctionName = reader.string();
+    callArgNr = static_cast<int>(readSigned(reader));
+    location.fileName = reader.string();
+    location.linenr = static_cast<unsigned int>(reader.number());
+    return !reader.error();
+}
+
+bool CTU::FileInfo::FunctionCall::loadFromBinary(BinaryReader &reader)
+{
+    if (!loadBaseFromBinary(reader))
+        return false;
+    callArgumentExpression = reader.string();
+    callValueType = (ValueFlow::Value::ValueType)reader.number();
+    callArgValue = readSigned(reader);
+    warning = reader.number() != 0;
+    for (unsigned long long i = reader.number(); i > 0 && !reader.error(); --i) {
+        ErrorLogger::ErrorMessage::FileLocation loc;
+        loc.setfile(reader.string());
+        loc.line = static_cast<unsigned int>(reader.number());
+        loc.setinfo(reader.string());
+        callValuePath.push_back(loc);
+    }
+    return !reader.error();
+}
+
+bool CTU::FileInfo::NestedCall::loadFromBinary(BinaryReader &reader)
+{
+    if (!loadBaseFromBinary(reader))
+        return false;
+    myId = reader.string();
+    myArgNr = static_cast<unsigned int>(reader.number());
+    return !reader.error();
+}
+
+void CTU::FileInfo::loadFromBinary(const std::string &data)
+{
+    BinaryReader reader(data.data(), data.size());
+    for (unsigned long long i = reader.number(); i > 0 && !reader.error(); --i) {
+        FunctionCall functionCall;
+        if (functionCall.loadFromBinary(reader))
+            functionCalls.push_back(functionCall);
+    }
+    for (unsigned long long i = reader.number(); i > 0 && !reader.error(); --i) {
+        NestedCall nestedCall;
+        if (nestedCall.loadFromBinary(reader))
+            nestedCalls.push_back(nestedCall);
+    }
+}
+
+std::list<CTU::FileInfo::UnsafeUsage> CTU::loadUnsafeUsageListFromBinary(BinaryReader &reader)
+{
+    std::list<CTU::FileInfo::UnsafeUsage> ret;
+    for (unsigned long long i = reader.number(); i > 0 && !reader.error(); --i) {
+        FileInfo::UnsafeUsage unsafeUsage;
+        unsafeUsage.myId = reader.string();
+        unsafeUsage.myArgNr = static_cast<unsigned int>(reader.number());
+        unsafeUsage.myArgumentName = reader.string();
+        unsafeUsage.location.fileName = reader.string();
+        unsafeUsage.location.linenr = static_cast<unsigned int>(reader.number());
+        unsafeUsage.value = readSigned(reader);
+        if (!reader.error())
+            ret.push_back(unsafeUsage);
+    }
+    return ret;
+}
+
 static int isCallFunction(const Scope *scope, int argnr, const Token **tok)
 {
     const Variable * const argvar = scope->function->getArgumentVar(argnr);
@@ -323,7 +455,7 @@ CTU::FileInfo *CTU::getFileInfo(const Tokenizer *tokenizer)
                     functionCall.callArgumentExpression = argtok->expressionString();
                     functionCall.callArgValue = value.intvalue;
                     functionCall.warning = !value.errorSeverity();
-                    for (const ErrorPathItem &i : value.errorPath) {
+                    for (const ErrorPathItem &i : ErrorPath(value.errorPath)) {
                         ErrorLogger::ErrorMessage::FileLocation loc;
                         loc.setfile(tokenizer->list.file(i.first));
                         loc.line = i.first->linenr();
@@ -25,6 +25,8 @@
 #include "check.h"
 #include "valueflow.h"
 
+class BinaryReader;
+
 /// @addtogroup Core
 /// @{
 
@@ -36,6 +38,7 @@ namespace CTU {
         enum InvalidValueType { null, uninit, bufferOverflow };
 
         std::string toString() const OVERRIDE;
+        std::string toBinary() const OVERRIDE;
 
         struct Location {
             Location() = default;
@@ -71,6 +74,8 @@ namespace CTU {
         protected:
             std::string toBaseXmlString() const;
             bool loadBaseFromXml(const tinyxml2::XMLElement *xmlElement);
+            void baseToBinary(std::string &out) const;
+            bool loadBaseFromBinary(BinaryReader &reader);
         };
 
         class FunctionCall : public CallBase {
@@ -83,6 +88,8 @@ namespace CTU {
 
             std::string toXmlString() const;
             bool loadFromXml(const tinyxml2::XMLElement *xmlElement);
+            void toBinary(std::string &out) const;
+            bool loadFromBinary(BinaryReader &reader);
         };
 
         class NestedCall : public CallBase {
@@ -99,6 +106,8 @@ namespace CTU {
 
             std::string toXmlString() const;
             bool loadFromXml(const tinyxml2::XMLElement *xmlElement);
+            void toBinary(std::string &out) const;
+            bool loadFromBinary(BinaryReader &reader);
 
             std::string myId;
             unsigned int myArgNr;
@@ -108,6 +117,7 @@ namespace CTU {
         std::list<NestedCall> nestedCalls;
 
         void loadFromXml(const tinyxml2::XMLElement *xmlElement);
+        void loadFromBinary(const std::string &data);
         std::map<std::string, std::list<const CallBase *>> getCallsMap() const;
 
         std::list<ErrorLogger::ErrorMessage::FileLocation> getErrorPath(InvalidValueType invalidValue,
@@ -121,6 +131,7 @@ namespace CTU {
     extern int maxCtuDepth;
 
     CPPCHECKLIB std::string toString(const std::list<FileInfo::UnsafeUsage> &unsafeUsage);
+    CPPCHECKLIB void toBinary(std::string &out, const std::list<FileInfo::UnsafeUsage> &unsafeUsage);
 
     CPPCHECKLIB std::string getFunctionId(const Tokenizer *tokenizer, const Function *function);
 
@@ -130,6 +141,7 @@ namespace CTU {
     CPPCHECKLIB std::list<FileInfo::UnsafeUsage> getUnsafeUsage(const Tokenizer *tokenizer, const Settings *settings, const Check *check, bool (*isUnsafeUsage)(const Check *check, const Token *argtok, MathLib::bigint *value));
 
     CPPCHECKLIB std::list<FileInfo::UnsafeUsage> loadUnsafeUsageListFromXml(const tinyxml2::XMLElement *xmlElement);
+    CPPCHECKLIB std::list<FileInfo::UnsafeUsage> loadUnsafeUsageListFromBinary(BinaryReader &reader);
 }
 
 /// @}
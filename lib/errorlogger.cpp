@@ -354,6 +354,78 @@ std::string ErrorLogger::ErrorMessage::getXMLFooter()
     return "    </errors>\n</results>";
 }
 
+void ErrorLogger::ErrorMessage::serializeBinary(std::string &out) const
+{
+    serializeString(out, _id);
+    serializeNumber(out, _severity);
+    serializeNumber(out, _cwe.id);
+    serializeNumber(out, _inconclusive ? 1U : 0U);
+    serializeString(out, mShortMessage);
+    serializeString(out, mVerboseMessage);
+    serializeString(out, mSymbolNames);
+    serializeString(out, file0);
+    serializeNumber(out, _callStack.size());
+    for (const FileLocation &loc : _callStack) {
+        // line is negative when there is no line
+        serializeNumber(out, static_cast<unsigned int>(loc.line + 1));
+        serializeNumber(out, loc.col);
+        serializeNumber(out, loc.fileIndex);
+        serializeString(out, loc.getfile(false));
+        serializeString(out, loc.getOrigFile(false));
+        serializeString(out, loc.getinfo());
+    }
+}
+
+bool ErrorLogger::ErrorMessage::deserializeBinary(const char *data, std::size_t size)
+{
+    BinaryReader reader(data, size);
+    _id = reader.string();
+    const unsigned long long severity = reader.number();
+    if (severity > Severity::debug)
+        return false;
+    _severity = static_cast<Severity::SeverityType>(severity);
+    _cwe.id = static_cast<unsigned short>(reader.number());
+    _inconclusive = reader.number() != 0;
+    mShortMessage = reader.string();
+    mVerboseMessage = reader.string();
+    mSymbolNames = reader.string();
+    file0 = reader.string();
+    const unsigned long long stackSize = reader.number();
+    _callStack.clear();
+    for (unsigned long long i = 0; i < stackSize && !reader.error(); ++i) {
+        const int line = static_cast<int>(reader.number()) - 1;
+        const unsigned int col = static_cast<unsigned int>(reader.number());
+        const unsigned int fileIndex = static_cast<unsigned int>(reader.number());
+        const std::string file = reader.string();
+        const std::string origFile = reader.string();
+        const std::string info = reader.string();
+        FileLocation loc(origFile, info, 0);
+        loc.setfile(file);
+        loc.line = line;
+        loc.col = col;
+        loc.fileIndex = fileIndex;
+        _callStack.push_back(loc);
+    }
+    return !reader.error() && reader.atEnd();
+}
+
+std::string ErrorLogger::ErrorMessage::uniqueKey(bool verbose) const
+{
+    // Same fields as the default format of toString()
+    const std::string &msg = verbose ? mVerboseMessage : mShortMessage;
+    std::string key;
+    key.reserve(msg.size() + 16U * (_callStack.size() + 1U));
+    serializeNumber(key, _severity);
+    serializeNumber(key, (_severity != Severity::none && _inconclusive) ? 1U : 0U);
+    serializeNumber(key, _callStack.size());
+    for (const FileLocation &loc : _callStack) {
+        serializeString(key, loc.getfile(false));
+        serializeNumber(key, static_cast<unsigned int>(loc.line + 1));
+    }
+    key += msg;
+    return key;
+}
+
 // There is no utf-8 support around but the strings should at least be safe for to tinyxml2.
 // See #5300 "Invalid encoding in XML output" and  #6431 "Invalid XML created - Invalid encoding of string literal "
 std::string ErrorLogger::ErrorMessage::fixInvalidChars(const std::string& raw)
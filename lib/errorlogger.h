@@ -271,6 +271,26 @@ public:
         std::string serialize() const;
         bool deserialize(const std::string &data);
 
+        /**
+         * Append a compact binary encoding of the message to @p out.
+         * Unlike serialize(), all fields are kept. It is used to pass
+         * messages between processes of the same cppcheck binary.
+         */
+        void serializeBinary(std::string &out) const;
+
+        /**
+         * Read a message written by serializeBinary().
+         * @return false if the data is truncated or invalid
+         */
+        bool deserializeBinary(const char *data, std::size_t size);
+
+        /**
+         * Key used to alert only about unique errors. Messages get the same
+         * key when toString(verbose) gives the same text, but the key is
+         * much cheaper to create than the formatted message.
+         */
+        std::string uniqueKey(bool verbose) const;
+
         std::list<FileLocation> _callStack;
         std::string _id;
 
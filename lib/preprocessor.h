@@ -98,8 +98,22 @@ public:
 
     std::set<std::string> getConfigs(const simplecpp::TokenList &tokens) const;
 
+    /**
+     * Load the headers that are included by @p rawtokens. Headers that were
+     * loaded before by this process are taken from a cache.
+     */
     void loadFiles(const simplecpp::TokenList &rawtokens, std::vector<std::string> &files);
 
+    /** The names of the headers that were loaded by loadFiles() */
+    std::list<std::string> getHeaders() const;
+
+    /**
+     * The files that an \#include in @p rawtokens or in the loaded headers
+     * looked for before the header was found, or all of them if it was not
+     * found. If one of them is created, the \#include finds another file.
+     */
+    std::set<std::string> getMissingHeaders(const simplecpp::TokenList &rawtokens) const;
+
     void removeComments();
 
     void setPlatformInfo(simplecpp::TokenList *tokens) const;
@@ -136,7 +150,14 @@ public:
      */
     void preprocess(std::istream &srcCodeStream, std::string &processedFile, std::list<std::string> &resultConfigurations, const std::string &filename, const std::list<std::string> &includePaths);
 
-    simplecpp::TokenList preprocess(const simplecpp::TokenList &tokens1, const std::string &cfg, std::vector<std::string> &files, bool throwError = false);
+    /**
+     * Preprocess @p tokens1 for the configuration @p cfg
+     * @param duplicate if given, @p tokens1 are the tokens given to loadFiles().
+     * A configuration that has the same output as an earlier configuration is
+     * then not preprocessed again. *duplicate is set to true and an empty list
+     * is returned.
+     */
+    simplecpp::TokenList preprocess(const simplecpp::TokenList &tokens1, const std::string &cfg, std::vector<std::string> &files, bool throwError = false, bool *duplicate = nullptr);
 
     std::string getcode(const simplecpp::TokenList &tokens1, const std::string &cfg, std::vector<std::string> &files, const bool writeLocations);
 
@@ -164,13 +185,13 @@ public:
     void validateCfgError(const std::string &file, const unsigned int line, const std::string &cfg, const std::string &macro);
 
     /**
-     * Calculate CRC32 checksum. Using toolinfo, tokens1, filedata.
+     * Calculate 64-bit checksum. Using toolinfo, tokens1, filedata.
      *
      * @param tokens1    Sourcefile tokens
      * @param toolinfo   Arbitrary extra toolinfo
-     * @return CRC32 checksum
+     * @return checksum
      */
-    unsigned int calculateChecksum(const simplecpp::TokenList &tokens1, const std::string &toolinfo) const;
+    unsigned long long calculateChecksum(const simplecpp::TokenList &tokens1, const std::string &toolinfo) const;
 
     void simplifyPragmaAsm(simplecpp::TokenList *tokenList);
 
@@ -214,6 +235,23 @@ private:
 
     std::map<std::string, simplecpp::TokenList *> mTokenLists;
 
+    /** A configuration that has been preprocessed, the tokens are not kept */
+    struct Preprocessed {
+        Preprocessed(const std::map<std::string, std::string> &d, const std::map<std::string, std::size_t> &s) : defines(d), sizeOfType(s), empty(false) {}
+        /** The defines, macro name => "name=value" */
+        std::map<std::string, std::string> defines;
+        std::map<std::string, std::size_t> sizeOfType;
+        /** The names that were looked up in the macro table */
+        std::set<std::string> macroNames;
+        /** Was the output empty? */
+        bool empty;
+        simplecpp::OutputList outputList;
+        std::list<simplecpp::MacroUsage> macroUsage;
+    };
+
+    /** The configurations of the file given to loadFiles() that have been preprocessed */
+    std::list<Preprocessed> mPreprocessed;
+
     /** filename for cpp/c file - useful when reporting errors */
     std::string mFile0;
 };
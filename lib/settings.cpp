@@ -24,10 +24,12 @@ bool Settings::mTerminated;
 
 Settings::Settings()
     : mEnabled(0),
+      analyzerInfoXml(false),
       checkConfiguration(false),
       checkLibrary(false),
       checkHeaders(true),
       checkUnusedTemplates(false),
+      configJobs(1),
       debugSimplified(false),
       debugnormal(false),
       debugwarnings(false),
@@ -50,7 +52,12 @@ Settings::Settings()
       relativePaths(false),
       reportProgress(false),
       showtime(SHOWTIME_NONE),
+      valueFlowJobs(1),
+      valueFlowMaxIterations(0),
+      valueFlowMaxForwardTokens(100000),
+      valueFlowMaxValues(10),
       verbose(false),
+      workerPool(false),
       xml(false),
       xml_version(2)
 {
@@ -31,6 +31,7 @@
 #include "timer.h"
 
 #include <list>
+#include <memory>
 #include <set>
 #include <string>
 #include <vector>
@@ -38,6 +39,7 @@
 namespace ValueFlow {
     class Value;
 }
+class CompiledRule;
 
 /// @addtogroup Core
 /// @{
@@ -72,6 +74,10 @@ public:
 
     std::list<std::string> addons;
 
+    /** @brief Write the files in the --cppcheck-build-dir in XML format
+        instead of the binary format (--analyzer-info-xml) */
+    bool analyzerInfoXml;
+
     /** @brief Paths used as base for conversion to relative paths. */
     std::vector<std::string> basePaths;
 
@@ -92,6 +98,10 @@ public:
     /** Check unused templates */
     bool checkUnusedTemplates;
 
+    /** @brief How many threads should check the configurations of a file
+        at the same time. Default is 1. (--config-jobs=N) */
+    unsigned int configJobs;
+
     /** @brief include paths excluded from checking the configuration */
     std::set<std::string> configExcludePaths;
 
@@ -214,6 +224,20 @@ public:
         std::string id;
         std::string summary;
         Severity::SeverityType severity;
+
+        /**
+         * Compiled pattern, shared by all copies of the rule so it is
+         * compiled once per run. See CppCheck::compileRules().
+         */
+        std::shared_ptr<const CompiledRule> compiled;
+
+        /**
+         * All rules of the token list combined in one pattern that finds
+         * the matches of all of them in one scan, see
+         * CppCheck::combinePatterns(). Null if the rule is not combined
+         * with other rules.
+         */
+        std::shared_ptr<const CompiledRule> combined;
     };
 
     /**
@@ -221,7 +245,7 @@ public:
      */
     std::list<Rule> rules;
 
-    /** @brief show timing information (--showtime=file|summary|top5) */
+    /** @brief show timing information (--showtime=file|summary|top5|json) */
     SHOWTIME_MODES showtime;
 
     /** Struct contains standards settings */
@@ -235,6 +259,9 @@ public:
      *  text mode, e.g. "{file}:{line} {info}" */
     std::string templateLocation;
 
+    /** @brief write trace events of the timers (--trace=&lt;file&gt;) */
+    std::string traceFile;
+
     /** @brief defines given by the user */
     std::string userDefines;
 
@@ -244,9 +271,30 @@ public:
     /** @brief forced includes given by the user */
     std::list<std::string> userIncludes;
 
+    /** @brief How many threads should analyse the functions of a file in
+        ValueFlow at the same time. Default is 1. (--valueflow-jobs=N) */
+    unsigned int valueFlowJobs;
+
+    /** @brief How many times ValueFlow repeats its analysis to find more
+        values. Default is 0, no limit: the analysis is repeated until no
+        values are added. (--valueflow-max-iterations=N) */
+    unsigned int valueFlowMaxIterations;
+
+    /** @brief How many tokens ValueFlow follows forward from one assignment
+        or condition. Default is 100000. (--valueflow-max-forward-tokens=N) */
+    unsigned int valueFlowMaxForwardTokens;
+
+    /** @brief How many values a token can have. Default is 10.
+        (--valueflow-max-values=N) */
+    unsigned int valueFlowMaxValues;
+
     /** @brief Is --verbose given? */
     bool verbose;
 
+    /** @brief Use long-lived worker processes that check many files each
+        instead of one process per file (--worker-pool) */
+    bool workerPool;
+
     /** @brief write XML results (--xml) */
     bool xml;
 
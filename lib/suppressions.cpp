@@ -355,6 +355,16 @@ std::list<Suppressions::Suppression> Suppressions::getUnmatchedGlobalSuppression
     return result;
 }
 
+std::list<Suppressions::Suppression> Suppressions::getNonInlineSuppressions() const
+{
+    std::list<Suppression> result;
+    for (const Suppression &s : mSuppressions) {
+        if (!s.isInline)
+            result.push_back(s);
+    }
+    return result;
+}
+
 bool Suppressions::matchglob(const std::string &pattern, const std::string &name)
 {
     const char *p = pattern.c_str();
@@ -48,11 +48,11 @@ public:
     };
 
     struct CPPCHECKLIB Suppression {
-        Suppression() : lineNumber(NO_LINE), matched(false) {}
+        Suppression() : lineNumber(NO_LINE), matched(false), isInline(false) {}
         Suppression(const Suppression &other) {
             *this = other;
         }
-        Suppression(const std::string &id, const std::string &file, int line=NO_LINE) : errorId(id), fileName(file), lineNumber(line), matched(false) {}
+        Suppression(const std::string &id, const std::string &file, int line=NO_LINE) : errorId(id), fileName(file), lineNumber(line), matched(false), isInline(false) {}
 
         Suppression & operator=(const Suppression &other) {
             errorId = other.errorId;
@@ -60,6 +60,7 @@ public:
             lineNumber = other.lineNumber;
             symbolName = other.symbolName;
             matched = other.matched;
+            isInline = other.isInline;
             return *this;
         }
 
@@ -98,6 +99,9 @@ public:
         std::string symbolName;
         bool matched;
 
+        /** Is this an inline suppression in the code */
+        bool isInline;
+
         enum { NO_LINE = -1 };
     };
 
@@ -162,6 +166,12 @@ public:
      */
     std::list<Suppression> getUnmatchedGlobalSuppressions(const bool unusedFunctionChecking) const;
 
+    /**
+     * @brief Returns list of suppressions that are not inline suppressions.
+     * @return list of suppressions
+     */
+    std::list<Suppression> getNonInlineSuppressions() const;
+
     static bool matchglob(const std::string &pattern, const std::string &name);
 private:
     /** @brief List of error which the user doesn't want to see. */
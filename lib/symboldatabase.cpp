@@ -4876,7 +4876,7 @@ static void setAutoTokenProperties(Token * const autoTok)
 
 void SymbolDatabase::setValueType(Token *tok, const ValueType &valuetype)
 {
-    tok->setValueType(new ValueType(valuetype));
+    tok->setValueType(&valuetype);
     Token *parent = const_cast<Token *>(tok->astParent());
     if (!parent || parent->valueType())
         return;
@@ -149,7 +149,7 @@ TemplateSimplifier::TokenAndName::TokenAndName(const TokenAndName& otherTok) :
 TemplateSimplifier::TokenAndName::~TokenAndName()
 {
     if (token)
-        token->templateSimplifierPointers().erase(this);
+        token->removeTemplateSimplifierPointer(this);
 }
 
 TemplateSimplifier::TemplateSimplifier(Tokenizer *tokenizer)
@@ -2649,7 +2649,7 @@ void TemplateSimplifier::replaceTemplateUsage(
             Token::Match(nameTok, "template|const_cast|dynamic_cast|reinterpret_cast|static_cast"))
             continue;
 
-        std::set<TemplateSimplifier::TokenAndName*> & pointers = nameTok->templateSimplifierPointers();
+        const std::set<TemplateSimplifier::TokenAndName*> & pointers = nameTok->templateSimplifierPointers();
 
         // check if instantiation matches token instantiation from pointer
         if (pointers.size()) {
@@ -18,25 +18,87 @@
 
 #include "timer.h"
 
+#include "utils.h"
+
 #include <algorithm>
+#include <atomic>
+#include <fstream>
 #include <iostream>
 #include <utility>
-#include <vector>
+
+#ifdef _WIN32
+#include <windows.h>
+#else
+#include <unistd.h>
+#endif
 /*
     TODO:
     - rename "file" to "single"
-    - synchronise map access in multithreaded mode or disable timing
     - add unit tests
         - for --showtime (needs input file)
-        - for Timer* classes
 */
 
 namespace {
-    typedef std::pair<std::string, struct TimerResultsData> dataElementType;
+    typedef std::pair<std::vector<std::string>, struct TimerResultsData> dataElementType;
     bool more_second_sec(const dataElementType& lhs, const dataElementType& rhs)
     {
         return lhs.second.seconds() > rhs.second.seconds();
     }
+
+    typedef std::pair<std::string, struct TimerResultsData> fileElementType;
+    bool more_wall(const fileElementType& lhs, const fileElementType& rhs)
+    {
+        return lhs.second.mWall > rhs.second.mWall;
+    }
+}
+
+/** CPU time of the calling thread */
+static std::clock_t threadClock()
+{
+#if defined(_WIN32)
+    FILETIME creationTime, exitTime, kernelTime, userTime;
+    if (GetThreadTimes(GetCurrentThread(), &creationTime, &exitTime, &kernelTime, &userTime)) {
+        const unsigned long long kernel = ((unsigned long long)kernelTime.dwHighDateTime << 32) | kernelTime.dwLowDateTime;
+        const unsigned long long user = ((unsigned long long)userTime.dwHighDateTime << 32) | userTime.dwLowDateTime;
+        // 100 ns units
+        return (std::clock_t)((kernel + user) / (10000000ULL / CLOCKS_PER_SEC));
+    }
+#elif defined(CLOCK_THREAD_CPUTIME_ID)
+    struct timespec ts;
+    if (clock_gettime(CLOCK_THREAD_CPUTIME_ID, &ts) == 0)
+        return static_cast<std::clock_t>(ts.tv_sec) * CLOCKS_PER_SEC + static_cast<std::clock_t>(ts.tv_nsec / (1000000000L / CLOCKS_PER_SEC));
+#endif
+    return std::clock();
+}
+
+/** The innermost running timer of the thread */
+static thread_local Timer *currentTimer = nullptr;
+
+/** Timers that are nested in the timer @p path, sorted by time */
+static std::vector<dataElementType> getChildren(const std::map<std::vector<std::string>, struct TimerResultsData> &results, const std::vector<std::string> &path)
+{
+    std::vector<dataElementType> children;
+    for (std::map<std::vector<std::string>, struct TimerResultsData>::const_iterator iter = results.begin(); iter != results.end(); ++iter) {
+        if (iter->first.size() == path.size() + 1 && std::equal(path.begin(), path.end(), iter->first.begin()))
+            children.push_back(*iter);
+    }
+    std::sort(children.begin(), children.end(), more_second_sec);
+    return children;
+}
+
+static void showResult(const std::string &name, const TimerResultsData &data, std::size_t indent)
+{
+    const double sec = data.seconds();
+    const double secAverage = sec / (double)(data.mNumberOfResults);
+    std::cout << std::string(indent, ' ') << name << ": " << sec << "s (avg. " << secAverage << "s - " << data.mNumberOfResults << " result(s), wall " << data.mWall << "s)" << std::endl;
+}
+
+static void showTree(const std::map<std::vector<std::string>, struct TimerResultsData> &results, const std::vector<std::string> &path)
+{
+    for (const dataElementType &child : getChildren(results, path)) {
+        showResult(child.first.back(), child.second, 2 * path.size());
+        showTree(results, child.first);
+    }
 }
 
 void TimerResults::ShowResults(SHOWTIME_MODES mode) const
@@ -44,31 +106,338 @@ void TimerResults::ShowResults(SHOWTIME_MODES mode) const
     if (mode == SHOWTIME_NONE)
         return;
 
+    std::lock_guard<std::mutex> lock(mMutex);
+
+    if (mode == SHOWTIME_JSON) {
+        ShowJson();
+        return;
+    }
+
     std::cout << std::endl;
     TimerResultsData overallData;
 
-    std::vector<dataElementType> data(mResults.begin(), mResults.end());
-    std::sort(data.begin(), data.end(), more_second_sec);
+    // The timers of each thread are nested in the timers that are not nested
+    for (const dataElementType &timer : getChildren(mResults, std::vector<std::string>()))
+        overallData.add(timer.second);
 
-    size_t ordinal = 1; // maybe it would be nice to have an ordinal in output later!
-    for (std::vector<dataElementType>::const_iterator iter=data.begin() ; iter!=data.end(); ++iter) {
-        const double sec = iter->second.seconds();
-        const double secAverage = sec / (double)(iter->second.mNumberOfResults);
-        overallData.mClocks += iter->second.mClocks;
-        if ((mode != SHOWTIME_TOP5) || (ordinal<=5)) {
-            std::cout << iter->first << ": " << sec << "s (avg. " << secAverage << "s - " << iter->second.mNumberOfResults  << " result(s))" << std::endl;
+    if (mode == SHOWTIME_SUMMARY) {
+        showTree(mResults, std::vector<std::string>());
+    } else {
+        // Rank the time that is not spent in nested timers, so that a
+        // timer is not counted again in the timers it is nested in
+        std::vector<dataElementType> data;
+        for (std::map<std::vector<std::string>, struct TimerResultsData>::const_iterator iter = mResults.begin(); iter != mResults.end(); ++iter) {
+            TimerResultsData self = iter->second;
+            for (const dataElementType &child : getChildren(mResults, iter->first)) {
+                self.mClocks -= child.second.mClocks;
+                self.mWall -= child.second.mWall;
+            }
+            if (self.mClocks > 0)
+                data.emplace_back(iter->first, self);
         }
-        ++ordinal;
+        std::stable_sort(data.begin(), data.end(), more_second_sec);
+        for (std::size_t i = 0; i < data.size() && i < 5; ++i)
+            showResult(data[i].first.back(), data[i].second, 0);
     }
 
     const double secOverall = overallData.seconds();
     std::cout << "Overall time: " << secOverall << "s" << std::endl;
+
+    for (std::map<std::string, long>::const_iterator iter = mCounts.begin(); iter != mCounts.end(); ++iter)
+        std::cout << iter->first << ": " << iter->second << std::endl;
+
+    if (mode == SHOWTIME_SUMMARY && !mFileResults.empty()) {
+        std::vector<fileElementType> files(mFileResults.begin(), mFileResults.end());
+        std::sort(files.begin(), files.end(), more_wall);
+        std::cout << "Slowest files:" << std::endl;
+        for (std::size_t i = 0; i < files.size() && i < 10; ++i)
+            std::cout << "  " << files[i].first << ": " << files[i].second.mWall << "s (cpu " << files[i].second.seconds() << "s)" << std::endl;
+    }
+}
+
+static std::string toJsonString(const std::string &str)
+{
+    std::string ret("\"");
+    for (const char c : str) {
+        if (c == '\"' || c == '\\') {
+            ret += '\\';
+            ret += c;
+        } else if ((unsigned char)c < 0x20) {
+            const char hex[] = "0123456789abcdef";
+            ret += "\\u00";
+            ret += hex[(c >> 4) & 0xf];
+            ret += hex[c & 0xf];
+        } else {
+            ret += c;
+        }
+    }
+    ret += '\"';
+    return ret;
+}
+
+static void showJsonData(const TimerResultsData &data)
+{
+    std::cout << "\"cpu\": " << data.seconds() << ", \"wall\": " << data.mWall << ", \"count\": " << data.mNumberOfResults;
+}
+
+static void showJsonTree(const std::map<std::vector<std::string>, struct TimerResultsData> &results, const std::vector<std::string> &path)
+{
+    const std::string indent(2 * path.size() + 4, ' ');
+    const std::vector<dataElementType> children = getChildren(results, path);
+    for (std::size_t i = 0; i < children.size(); ++i) {
+        std::cout << indent << "{\"name\": " << toJsonString(children[i].first.back()) << ", ";
+        showJsonData(children[i].second);
+        std::cout << ", \"children\": [";
+        if (!getChildren(results, children[i].first).empty()) {
+            std::cout << '\n';
+            showJsonTree(results, children[i].first);
+            std::cout << indent;
+        }
+        std::cout << "]}" << (i + 1 < children.size() ? "," : "") << '\n';
+    }
+}
+
+void TimerResults::ShowJson() const
+{
+    TimerResultsData overallData;
+    for (const dataElementType &timer : getChildren(mResults, std::vector<std::string>()))
+        overallData.add(timer.second);
+
+    std::cout << "{\n  \"overall\": {";
+    showJsonData(overallData);
+    std::cout << "},\n  \"timers\": [\n";
+    showJsonTree(mResults, std::vector<std::string>());
+    std::cout << "  ],\n  \"files\": [\n";
+    std::vector<fileElementType> files(mFileResults.begin(), mFileResults.end());
+    std::sort(files.begin(), files.end(), more_wall);
+    for (std::size_t i = 0; i < files.size(); ++i) {
+        std::cout << "    {\"file\": " << toJsonString(files[i].first) << ", ";
+        showJsonData(files[i].second);
+        std::cout << '}' << (i + 1 < files.size() ? "," : "") << '\n';
+    }
+    std::cout << "  ],\n  \"counts\": {";
+    for (std::map<std::string, long>::const_iterator iter = mCounts.begin(); iter != mCounts.end(); ++iter)
+        std::cout << (iter == mCounts.begin() ? "\n" : ",\n") << "    " << toJsonString(iter->first) << ": " << iter->second;
+    std::cout << (mCounts.empty() ? "}\n" : "\n  }\n") << '}' << std::endl;
+}
+
+void TimerResults::AddResults(const std::vector<std::string>& path, const TimerResultsData& data)
+{
+    std::lock_guard<std::mutex> lock(mMutex);
+    mResults[path].add(data);
+}
+
+void TimerResults::AddFileResults(const std::string& file, const TimerResultsData& data)
+{
+    std::lock_guard<std::mutex> lock(mMutex);
+    mFileResults[file].add(data);
+}
+
+void TimerResults::AddCount(const std::string& str, long count)
+{
+    std::lock_guard<std::mutex> lock(mMutex);
+    mCounts[str] += count;
+}
+
+/** Records of serialize(), each is followed by its data */
+enum TimerRecord {
+    /** Number of names, the names, then the data */
+    TIMER_RECORD = 1,
+    /** File name and data */
+    FILE_RECORD = 2,
+    /** Name and count */
+    COUNT_RECORD = 3
+};
+
+static void serializeData(std::string &out, const TimerResultsData &data)
+{
+    serializeNumber(out, (unsigned long long)data.mClocks);
+    // Wall time in microseconds
+    serializeNumber(out, (unsigned long long)(data.mWall * 1000000.0 + 0.5));
+    serializeNumber(out, (unsigned long long)data.mNumberOfResults);
+}
+
+static TimerResultsData deserializeData(BinaryReader &reader)
+{
+    TimerResultsData data;
+    data.mClocks = (std::clock_t)reader.number();
+    data.mWall = (double)reader.number() / 1000000.0;
+    data.mNumberOfResults = (long)reader.number();
+    return data;
+}
+
+std::string TimerResults::serialize() const
+{
+    std::lock_guard<std::mutex> lock(mMutex);
+    std::string out;
+    for (std::map<std::vector<std::string>, struct TimerResultsData>::const_iterator iter = mResults.begin(); iter != mResults.end(); ++iter) {
+        serializeNumber(out, TIMER_RECORD);
+        serializeNumber(out, iter->first.size());
+        for (const std::string &name : iter->first)
+            serializeString(out, name);
+        serializeData(out, iter->second);
+    }
+    for (std::map<std::string, struct TimerResultsData>::const_iterator iter = mFileResults.begin(); iter != mFileResults.end(); ++iter) {
+        serializeNumber(out, FILE_RECORD);
+        serializeString(out, iter->first);
+        serializeData(out, iter->second);
+    }
+    for (std::map<std::string, long>::const_iterator iter = mCounts.begin(); iter != mCounts.end(); ++iter) {
+        serializeNumber(out, COUNT_RECORD);
+        serializeString(out, iter->first);
+        serializeNumber(out, (unsigned long long)iter->second);
+    }
+    return out;
+}
+
+bool TimerResults::merge(const char *data, std::size_t size)
+{
+    BinaryReader reader(data, size);
+    while (!reader.error() && !reader.atEnd()) {
+        const unsigned long long record = reader.number();
+        if (record == TIMER_RECORD) {
+            std::vector<std::string> path((std::size_t)std::min<unsigned long long>(reader.number(), size));
+            for (std::string &name : path)
+                name = reader.string();
+            const TimerResultsData timerData = deserializeData(reader);
+            if (!reader.error())
+                AddResults(path, timerData);
+        } else if (record == FILE_RECORD) {
+            const std::string file = reader.string();
+            const TimerResultsData fileData = deserializeData(reader);
+            if (!reader.error())
+                AddFileResults(file, fileData);
+        } else if (record == COUNT_RECORD) {
+            const std::string str = reader.string();
+            const long count = (long)reader.number();
+            if (!reader.error())
+                AddCount(str, count);
+        } else {
+            return false;
+        }
+    }
+    return !reader.error();
+}
+
+void TimerResults::clear()
+{
+    std::lock_guard<std::mutex> lock(mMutex);
+    mResults.clear();
+    mFileResults.clear();
+    mCounts.clear();
 }
 
-void TimerResults::AddResults(const std::string& str, std::clock_t clocks)
+bool TraceEvents::mEnabled = false;
+
+/** The trace file and the events that are not written yet */
+static std::mutex traceMutex;
+static std::ofstream traceFile;
+static std::string traceEvents;
+
+/** Process that writes the trace file, the ThreadExecutor children send their events to it */
+static long traceProcess = 0;
+static std::function<void(const std::string &)> traceWriter;
+
+/** The events are written when this much text is buffered */
+static const std::size_t TRACE_BUFFER_SIZE = 1024 * 1024;
+
+static long processId()
+{
+#ifdef _WIN32
+    return (long)GetCurrentProcessId();
+#else
+    return (long)getpid();
+#endif
+}
+
+/** Small number that identifies the calling thread in the trace */
+static int threadId()
+{
+    static std::atomic<int> threads(0);
+    static thread_local int id = 0;
+    if (id == 0)
+        id = ++threads;
+    return id;
+}
+
+/** Write the buffered events, traceMutex must be locked */
+static void writeTraceEvents()
+{
+    if (!traceFile.is_open() || processId() != traceProcess)
+        return;
+    traceFile << traceEvents;
+    // Nothing is left in the stream buffer that forked children could write again
+    traceFile.flush();
+    traceEvents.clear();
+}
+
+bool TraceEvents::open(const std::string &filename)
 {
-    mResults[str].mClocks += clocks;
-    mResults[str].mNumberOfResults++;
+    std::lock_guard<std::mutex> lock(traceMutex);
+    traceFile.open(filename);
+    if (!traceFile.is_open())
+        return false;
+    traceFile << "{\"traceEvents\":[\n";
+    traceFile.flush();
+    traceProcess = processId();
+    mEnabled = true;
+    return true;
+}
+
+void TraceEvents::close()
+{
+    std::lock_guard<std::mutex> lock(traceMutex);
+    if (!traceFile.is_open())
+        return;
+    mEnabled = false;
+    // The last event is not followed by a comma
+    traceEvents += "{\"name\":\"process_name\",\"ph\":\"M\",\"pid\":" + std::to_string(traceProcess) + ",\"tid\":0,\"args\":{\"name\":\"cppcheck\"}}\n";
+    writeTraceEvents();
+    traceFile << "]}" << std::endl;
+    traceFile.close();
+}
+
+void TraceEvents::add(const std::string &name, const char category[], std::chrono::steady_clock::time_point start, std::chrono::steady_clock::time_point end)
+{
+    const long long ts = std::chrono::duration_cast<std::chrono::microseconds>(start.time_since_epoch()).count();
+    const long long dur = std::chrono::duration_cast<std::chrono::microseconds>(end - start).count();
+    const std::string event = "{\"name\":" + toJsonString(name) +
+                              ",\"cat\":\"" + category +
+                              "\",\"ph\":\"X\",\"ts\":" + std::to_string(ts) +
+                              ",\"dur\":" + std::to_string(dur) +
+                              ",\"pid\":" + std::to_string(processId()) +
+                              ",\"tid\":" + std::to_string(threadId()) + "},\n";
+
+    std::lock_guard<std::mutex> lock(traceMutex);
+    traceEvents += event;
+    if (traceEvents.size() >= TRACE_BUFFER_SIZE)
+        writeTraceEvents();
+}
+
+void TraceEvents::setWriter(const std::function<void(const std::string &events)> &writer)
+{
+    std::lock_guard<std::mutex> lock(traceMutex);
+    traceWriter = writer;
+    traceEvents.clear();
+}
+
+void TraceEvents::flush()
+{
+    std::lock_guard<std::mutex> lock(traceMutex);
+    if (!traceWriter) {
+        writeTraceEvents();
+    } else if (!traceEvents.empty()) {
+        traceWriter(traceEvents);
+        traceEvents.clear();
+    }
+}
+
+void TraceEvents::append(const std::string &events)
+{
+    std::lock_guard<std::mutex> lock(traceMutex);
+    traceEvents += events;
+    if (traceEvents.size() >= TRACE_BUFFER_SIZE)
+        writeTraceEvents();
 }
 
 Timer::Timer(const std::string& str, unsigned int showtimeMode, TimerResultsIntf* timerResults)
@@ -77,9 +446,32 @@ Timer::Timer(const std::string& str, unsigned int showtimeMode, TimerResultsIntf
     , mStart(0)
     , mShowTimeMode(showtimeMode)
     , mStopped(false)
+    , mTrace(TraceEvents::enabled())
+    , mParent(nullptr)
 {
-    if (showtimeMode != SHOWTIME_NONE)
-        mStart = std::clock();
+    if (showtimeMode != SHOWTIME_NONE || mTrace) {
+        mStart = threadClock();
+        mWallStart = std::chrono::steady_clock::now();
+    }
+    if (showtimeMode != SHOWTIME_NONE && mTimerResults) {
+        mParent = currentTimer;
+        currentTimer = this;
+    }
+}
+
+Timer::Timer(unsigned int showtimeMode, TimerResultsIntf* timerResults, const std::string& file)
+    : mFile(file)
+    , mTimerResults(timerResults)
+    , mStart(0)
+    , mShowTimeMode(showtimeMode)
+    , mStopped(false)
+    , mTrace(TraceEvents::enabled())
+    , mParent(nullptr)
+{
+    if (showtimeMode != SHOWTIME_NONE || mTrace) {
+        mStart = threadClock();
+        mWallStart = std::chrono::steady_clock::now();
+    }
 }
 
 Timer::~Timer()
@@ -89,16 +481,44 @@ Timer::~Timer()
 
 void Timer::Stop()
 {
+    if (mTrace && !mStopped) {
+        if (mFile.empty())
+            TraceEvents::add(mStr, "cppcheck", mWallStart, std::chrono::steady_clock::now());
+        else {
+            TraceEvents::add(mFile, "file", mWallStart, std::chrono::steady_clock::now());
+            TraceEvents::flush();
+        }
+    }
+
     if ((mShowTimeMode != SHOWTIME_NONE) && !mStopped) {
-        const std::clock_t end = std::clock();
-        const std::clock_t diff = end - mStart;
+        const std::clock_t end = threadClock();
+        TimerResultsData data;
+        data.mClocks = end - mStart;
+        data.mWall = std::chrono::duration<double>(std::chrono::steady_clock::now() - mWallStart).count();
+        data.mNumberOfResults = 1;
+
+        if (!mFile.empty()) {
+            if (mShowTimeMode != SHOWTIME_FILE && mTimerResults)
+                mTimerResults->AddFileResults(mFile, data);
+        } else if (mShowTimeMode == SHOWTIME_FILE) {
+            std::cout << mStr << ": " << data.seconds() << "s" << std::endl;
+        } else if (mTimerResults) {
+            std::vector<std::string> path(1, mStr);
+            for (const Timer *parent = mParent; parent; parent = parent->mParent)
+                path.insert(path.begin(), parent->mStr);
+            mTimerResults->AddResults(path, data);
+        }
 
-        if (mShowTimeMode == SHOWTIME_FILE) {
-            const double sec = (double)diff / CLOCKS_PER_SEC;
-            std::cout << mStr << ": " << sec << "s" << std::endl;
+        // Remove the timer from the timers of the thread, it might be stopped before the timers nested in it
+        if (currentTimer == this) {
+            currentTimer = mParent;
         } else {
-            if (mTimerResults)
-                mTimerResults->AddResults(mStr, diff);
+            for (Timer *timer = currentTimer; timer; timer = timer->mParent) {
+                if (timer->mParent == this) {
+                    timer->mParent = mParent;
+                    break;
+                }
+            }
         }
     }
 
@@ -22,30 +22,32 @@
 
 #include "config.h"
 
+#include <chrono>
 #include <ctime>
+#include <functional>
 #include <map>
+#include <mutex>
 #include <string>
+#include <vector>
 
 enum SHOWTIME_MODES {
     SHOWTIME_NONE = 0,
     SHOWTIME_FILE,
     SHOWTIME_SUMMARY,
-    SHOWTIME_TOP5
-};
-
-class CPPCHECKLIB TimerResultsIntf {
-public:
-    virtual ~TimerResultsIntf() { }
-
-    virtual void AddResults(const std::string& str, std::clock_t clocks) = 0;
+    SHOWTIME_TOP5,
+    SHOWTIME_JSON
 };
 
 struct TimerResultsData {
+    /** CPU time of the thread that ran the timer */
     std::clock_t mClocks;
+    /** Wall clock time in seconds */
+    double mWall;
     long mNumberOfResults;
 
     TimerResultsData()
         : mClocks(0)
+        , mWall(0)
         , mNumberOfResults(0) {
     }
 
@@ -53,6 +55,26 @@ struct TimerResultsData {
         const double ret = (double)((unsigned long)mClocks) / (double)CLOCKS_PER_SEC;
         return ret;
     }
+
+    void add(const TimerResultsData &other) {
+        mClocks += other.mClocks;
+        mWall += other.mWall;
+        mNumberOfResults += other.mNumberOfResults;
+    }
+};
+
+class CPPCHECKLIB TimerResultsIntf {
+public:
+    virtual ~TimerResultsIntf() { }
+
+    /**
+     * @param path names of the running timers of the thread, the outermost first
+     * @param data measured time
+     */
+    virtual void AddResults(const std::vector<std::string>& path, const TimerResultsData& data) = 0;
+
+    /** Add the time it took to check a file */
+    virtual void AddFileResults(const std::string& file, const TimerResultsData& data) = 0;
 };
 
 class CPPCHECKLIB TimerResults : public TimerResultsIntf {
@@ -61,15 +83,89 @@ public:
     }
 
     void ShowResults(SHOWTIME_MODES mode) const;
-    void AddResults(const std::string& str, std::clock_t clocks) OVERRIDE;
+    void AddResults(const std::vector<std::string>& path, const TimerResultsData& data) OVERRIDE;
+    void AddFileResults(const std::string& file, const TimerResultsData& data) OVERRIDE;
+
+    /** Count an event that is shown together with the times, e.g. skipped work */
+    void AddCount(const std::string& str, long count = 1);
+
+    /** Write the results in a binary format, for the ThreadExecutor children */
+    std::string serialize() const;
+
+    /**
+     * Add results that were written by serialize() in another process
+     * @return false if the data is invalid
+     */
+    bool merge(const char *data, std::size_t size);
+
+    void clear();
 
 private:
-    std::map<std::string, struct TimerResultsData> mResults;
+    void ShowJson() const;
+
+    /** Results of nested timers, key is the path of the timer */
+    std::map<std::vector<std::string>, struct TimerResultsData> mResults;
+    std::map<std::string, struct TimerResultsData> mFileResults;
+    std::map<std::string, long> mCounts;
+
+    /** Results are added by the threads of --config-jobs */
+    mutable std::mutex mMutex;
 };
 
+/**
+ * Trace events of the timers in the Chrome trace event format (--trace).
+ * The file can be loaded in chrome://tracing or Perfetto.
+ */
+class CPPCHECKLIB TraceEvents {
+public:
+    /**
+     * Start to write the events of all timers to @p filename
+     * @return false if the file can't be written
+     */
+    static bool open(const std::string &filename);
+
+    /** Write the remaining events and close the file */
+    static void close();
+
+    static bool enabled() {
+        return mEnabled;
+    }
+
+    /** Add a complete event of the calling thread */
+    static void add(const std::string &name, const char category[], std::chrono::steady_clock::time_point start, std::chrono::steady_clock::time_point end);
+
+    /**
+     * Give the events to @p writer instead of writing them to the file.
+     * The ThreadExecutor children send their events to the parent. The
+     * events that are buffered already are dropped, the parent has them.
+     */
+    static void setWriter(const std::function<void(const std::string &events)> &writer);
+
+    /** Write the buffered events, this is done after each checked file */
+    static void flush();
+
+    /** Add events that were taken in another process */
+    static void append(const std::string &events);
+
+private:
+    static bool mEnabled;
+};
+
+/**
+ * Measure the wall clock time and the CPU time of the thread while the
+ * timer is in scope. Timers that are created on the same thread while
+ * the timer runs are nested in it.
+ */
 class CPPCHECKLIB Timer {
 public:
     Timer(const std::string& str, unsigned int showtimeMode, TimerResultsIntf* timerResults = nullptr);
+
+    /**
+     * Measure the time it takes to check @p file. The timer is not nested
+     * in other timers and other timers are not nested in it.
+     */
+    Timer(unsigned int showtimeMode, TimerResultsIntf* timerResults, const std::string& file);
+
     ~Timer();
     void Stop();
 
@@ -78,10 +174,18 @@ private:
     Timer& operator=(const Timer&); // disallow assignments
 
     const std::string mStr;
+    const std::string mFile;
     TimerResultsIntf* mTimerResults;
     std::clock_t mStart;
+    std::chrono::steady_clock::time_point mWallStart;
     const unsigned int mShowTimeMode;
     bool mStopped;
+
+    /** A trace event is added when the timer stops */
+    const bool mTrace;
+
+    /** The timer that this timer is nested in */
+    Timer *mParent;
 };
 //---------------------------------------------------------------------------
 #endif // timerH
@@ -25,11 +25,16 @@
 #include "symboldatabase.h"
 #include "utils.h"
 
+#include <algorithm>
+#include <atomic>
 #include <cassert>
 #include <cctype>
+#include <cstdint>
 #include <cstring>
 #include <iostream>
+#include <iterator>
 #include <map>
+#include <new>
 #include <set>
 #include <stack>
 #include <utility>
@@ -50,22 +55,129 @@ static bool isStringCharLiteral(const std::string &str, char q)
     }
     return false;
 }
-const std::list<ValueFlow::Value> TokenImpl::mEmptyValueList;
+const ValueFlow::Values TokenImpl::mEmptyValueList;
+const std::set<TemplateSimplifier::TokenAndName*> TokenImpl::mEmptyTemplateSimplifierPointers;
+
+TokenArena::TokenArena() :
+    mFree(),
+    mPos(nullptr),
+    mEnd(nullptr),
+    mNextBlockSize(4096),
+    mSize(0),
+    mAllocations(0),
+    mReused(0),
+    mLive(0)
+{
+}
+
+TokenArena::~TokenArena()
+{
+    for (char *block : mBlocks)
+        ::operator delete(block);
+}
+
+void *TokenArena::allocate(std::size_t size)
+{
+    ++mAllocations;
+    ++mLive;
+    if (size > MAX_SMALL_SIZE) {
+        mSize += size;
+        return ::operator new(size);
+    }
+    size = (size + ALIGNMENT - 1) & ~(ALIGNMENT - 1);
+    FreeObject *&freeList = mFree[size / ALIGNMENT];
+    if (freeList) {
+        FreeObject *obj = freeList;
+        freeList = obj->next;
+        ++mReused;
+        return obj;
+    }
+    if (static_cast<std::size_t>(mEnd - mPos) < size) {
+        // Grow the blocks up to 1 MiB, token lists for small snippets stay small
+        char *block = static_cast<char *>(::operator new(mNextBlockSize));
+        mBlocks.push_back(block);
+        mPos = block;
+        mEnd = block + mNextBlockSize;
+        mSize += mNextBlockSize;
+        if (mNextBlockSize < (1U << 20))
+            mNextBlockSize *= 2;
+    }
+    void *p = mPos;
+    mPos += size;
+    return p;
+}
+
+void TokenArena::deallocate(void *p, std::size_t size)
+{
+    --mLive;
+    if (size > MAX_SMALL_SIZE) {
+        mSize -= size;
+        ::operator delete(p);
+        return;
+    }
+    size = (size + ALIGNMENT - 1) & ~(ALIGNMENT - 1);
+    FreeObject *obj = static_cast<FreeObject *>(p);
+    obj->next = mFree[size / ALIGNMENT];
+    mFree[size / ALIGNMENT] = obj;
+}
+
+void TokenArena::clear()
+{
+    if (mLive > 0)
+        return;
+    for (char *block : mBlocks)
+        ::operator delete(block);
+    mBlocks.clear();
+    std::fill(std::begin(mFree), std::end(mFree), nullptr);
+    mPos = mEnd = nullptr;
+    mNextBlockSize = 4096;
+    mSize = 0;
+}
+
+static TokenArena *getArena(const TokensFrontBack *tokensFrontBack)
+{
+    return tokensFrontBack ? tokensFrontBack->arena : nullptr;
+}
 
 Token::Token(TokensFrontBack *tokensFrontBack) :
-    mTokensFrontBack(tokensFrontBack),
     mNext(nullptr),
     mPrevious(nullptr),
     mLink(nullptr),
     mTokType(eNone),
-    mFlags(0)
-{
-    mImpl = new TokenImpl();
+    mInArena(false),
+    mFlags(0),
+    mVarId(0),
+    mFileIndex(0),
+    mLineNumber(0),
+    mColumn(0),
+    mAstOperand1(nullptr),
+    mAstOperand2(nullptr),
+    mAstParent(nullptr),
+    mFunction(nullptr), // Initialize whole union
+    mTokensFrontBack(tokensFrontBack)
+{
+    TokenArena *arena = getArena(tokensFrontBack);
+    mImpl = TokenArena::create<TokenImpl>(arena, arena);
 }
 
 Token::~Token()
 {
-    delete mImpl;
+    if (mImpl)
+        TokenArena::destroy(mImpl->mArena, mImpl);
+}
+
+Token *Token::create(TokensFrontBack *tokensFrontBack)
+{
+    TokenArena *arena = getArena(tokensFrontBack);
+    Token *tok = TokenArena::create<Token>(arena, tokensFrontBack);
+    tok->mInArena = (arena != nullptr);
+    return tok;
+}
+
+void Token::destroy(Token *tok)
+{
+    if (tok)
+        TokenArena::destroy(tok->mInArena ? getArena(tok->mTokensFrontBack) : nullptr, tok);
 }
 
 static const std::set<std::string> controlFlowKeywords = {
@@ -94,7 +206,7 @@ void Token::update_property_info()
         else if (isStringCharLiteral(mStr, '\''))
             tokType(eChar);
         else if (std::isalpha((unsigned char)mStr[0]) || mStr[0] == '_' || mStr[0] == '$') { // Name
-            if (mImpl->mVarId)
+            if (mVarId)
                 tokType(eVariable);
             else if (mTokType != eVariable && mTokType != eFunction && mTokType != eType && mTokType != eKeyword)
                 tokType(eName);
@@ -230,7 +342,7 @@ void Token::deleteNext(unsigned long index)
             n->mLink->link(nullptr);
 
         mNext = n->next();
-        delete n;
+        destroy(n);
         --index;
     }
 
@@ -250,7 +362,7 @@ void Token::deletePrevious(unsigned long index)
             p->mLink->link(nullptr);
 
         mPrevious = p->previous();
-        delete p;
+        destroy(p);
         --index;
     }
 
@@ -266,12 +378,20 @@ void Token::swapWithNext()
         std::swap(mStr, mNext->mStr);
         std::swap(mTokType, mNext->mTokType);
         std::swap(mFlags, mNext->mFlags);
+        std::swap(mVarId, mNext->mVarId);
+        std::swap(mFileIndex, mNext->mFileIndex);
+        std::swap(mLineNumber, mNext->mLineNumber);
+        std::swap(mColumn, mNext->mColumn);
+        std::swap(mAstOperand1, mNext->mAstOperand1);
+        std::swap(mAstOperand2, mNext->mAstOperand2);
+        std::swap(mAstParent, mNext->mAstParent);
+        std::swap(mFunction, mNext->mFunction);
         std::swap(mImpl, mNext->mImpl);
-        for (auto templateSimplifierPointer : mImpl->mTemplateSimplifierPointers) {
+        for (auto templateSimplifierPointer : templateSimplifierPointers()) {
             templateSimplifierPointer->token = this;
         }
 
-        for (auto templateSimplifierPointer : mNext->mImpl->mTemplateSimplifierPointers) {
+        for (auto templateSimplifierPointer : mNext->templateSimplifierPointers()) {
             templateSimplifierPointer->token = mNext;
         }
         if (mNext->mLink)
@@ -287,10 +407,18 @@ void Token::takeData(Token *fromToken)
     mStr = fromToken->mStr;
     tokType(fromToken->mTokType);
     mFlags = fromToken->mFlags;
-    delete mImpl;
+    mVarId = fromToken->mVarId;
+    mFileIndex = fromToken->mFileIndex;
+    mLineNumber = fromToken->mLineNumber;
+    mColumn = fromToken->mColumn;
+    mAstOperand1 = fromToken->mAstOperand1;
+    mAstOperand2 = fromToken->mAstOperand2;
+    mAstParent = fromToken->mAstParent;
+    mFunction = fromToken->mFunction;
+    TokenArena::destroy(mImpl->mArena, mImpl);
     mImpl = fromToken->mImpl;
     fromToken->mImpl = nullptr;
-    for (auto templateSimplifierPointer : mImpl->mTemplateSimplifierPointers) {
+    for (auto templateSimplifierPointer : templateSimplifierPointers()) {
         templateSimplifierPointer->token = this;
     }
     mLink = fromToken->mLink;
@@ -311,7 +439,7 @@ void Token::deleteThis()
         mPrevious = mPrevious->mPrevious;
         mPrevious->mNext = this;
 
-        delete toDelete;
+        destroy(toDelete);
     } else {
         // We are the last token in the list, we can't delete
         // ourselves, so just make us empty
@@ -349,7 +477,7 @@ void Token::replace(Token *replaceThis, Token *start, Token *end)
         tok->mImpl->mProgressValue = replaceThis->mImpl->mProgressValue;
 
     // Delete old token, which is replaced
-    delete replaceThis;
+    destroy(replaceThis);
 }
 
 const Token *Token::tokAt(int index) const
@@ -571,14 +699,14 @@ int Token::multiCompare(const Token *tok, const char *haystack, unsigned int var
     return -1;
 }
 
-bool Token::simpleMatch(const Token *tok, const char pattern[])
+bool Token::simpleMatch(const Token *tok, DynamicPattern pattern)
 {
     if (!tok)
         return false; // shortcut
-    const char *current  = pattern;
-    const char *next = std::strchr(pattern, ' ');
+    const char *current  = pattern.str;
+    const char *next = std::strchr(pattern.str, ' ');
     if (!next)
-        next = pattern + std::strlen(pattern);
+        next = pattern.str + std::strlen(pattern.str);
 
     while (*current) {
         const std::size_t length = next - current;
@@ -626,9 +754,9 @@ const char *Token::chrInFirstWord(const char *str, char c)
     }
 }
 
-bool Token::Match(const Token *tok, const char pattern[], unsigned int varid)
+bool Token::Match(const Token *tok, DynamicPattern pattern, unsigned int varid)
 {
-    const char *p = pattern;
+    const char *p = pattern.str;
     while (*p) {
         // Skip spaces in pattern..
         while (*p == ' ')
@@ -713,6 +841,385 @@ bool Token::Match(const Token *tok, const char pattern[], unsigned int varid)
     return true;
 }
 
+namespace {
+    /**
+     * A string literal pattern of simpleMatch() or Match() that is
+     * parsed once instead of each time it is used. It is stored in one
+     * block: this header, a copy of the pattern and the code of the
+     * pattern. Patterns that are not in the canonical form are
+     * interpreted, to get exactly the same results in all corner cases.
+     *
+     * The code of simpleMatch() is a length and the characters for each
+     * word. The code of Match() is a word type for each word, followed by:
+     * - CHARACTERS, NOT: a length and the characters
+     * - ALTERNATIVES, OPTIONAL: the number of alternatives and for each
+     *   alternative a command, literals are followed by a length and the
+     *   characters
+     */
+    class CompiledPattern {
+    public:
+        enum WordType {
+            /** "int|void|char" */
+            ALTERNATIVES,
+            /** "int|void|", the token is not used if no alternative matches */
+            OPTIONAL,
+            /** "[abc]" */
+            CHARACTERS,
+            /** "!!else" */
+            NOT
+        };
+
+        enum Command { LITERAL, ANY, ASSIGN, BOOL, CHAR, COMP, COP, NAME, NUM, OP, OR, OROR, STR, TYPE, VAR, VARID };
+
+        static const CompiledPattern *create(const char pattern[], std::size_t size, bool simple) {
+            const std::string text(pattern, size);
+            std::string code;
+            const bool compiled = simple ? compileSimpleMatch(text.c_str(), code) : compileMatch(text.c_str(), code);
+            if (!compiled)
+                code.clear();
+            CompiledPattern *ret = new (::operator new(sizeof(CompiledPattern) + size + code.size())) CompiledPattern(pattern, size, code.size(), !compiled);
+            std::memcpy(ret + 1, text.data(), size);
+            std::memcpy(reinterpret_cast<char *>(ret + 1) + size, code.data(), code.size());
+            return ret;
+        }
+
+        static void destroy(const CompiledPattern *compiled) {
+            ::operator delete(const_cast<CompiledPattern *>(compiled));
+        }
+
+        /**
+         * Is this the pattern at this address? A const local array can have
+         * the address of another pattern, so the content is compared too.
+         */
+        bool equals(const char pattern[], std::size_t size) const {
+            return mPattern == pattern && mSize == size && std::memcmp(this + 1, pattern, size) == 0;
+        }
+
+        bool interpret() const {
+            return mInterpret;
+        }
+
+        bool simpleMatch(const Token *tok) const {
+            const unsigned char *p = code();
+            const unsigned char * const end = p + mCodeSize;
+            while (p != end) {
+                const unsigned char len = *p++;
+                if (!tok || !equalsWord(tok->str(), p, len))
+                    return false;
+                p += len;
+                tok = tok->next();
+            }
+            return true;
+        }
+
+        bool match(const Token *tok, unsigned int varid) const {
+            const unsigned char *p = code();
+            const unsigned char * const end = p + mCodeSize;
+            while (p != end) {
+                const unsigned char type = *p++;
+                if (!tok) {
+                    // If we have no tokens, pattern "!!else" should return true
+                    if (type != NOT)
+                        return false;
+                    p += 1 + *p;
+                    continue;
+                }
+
+                if (type == CHARACTERS || type == NOT) {
+                    const unsigned char len = *p++;
+                    const bool found = (type == CHARACTERS) ?
+                                       (tok->str().size() == 1 && std::memchr(p, tok->str()[0], len)) :
+                                       !equalsWord(tok->str(), p, len);
+                    if (!found)
+                        return false;
+                    p += len;
+                } else {
+                    bool found = false;
+                    for (unsigned char count = *p++; count > 0; --count) {
+                        const unsigned char command = *p++;
+                        if (command == LITERAL) {
+                            const unsigned char len = *p++;
+                            found = found || equalsWord(tok->str(), p, len);
+                            p += len;
+                        } else {
+                            found = found || matchCommand(command, tok, varid);
+                        }
+                    }
+                    if (!found) {
+                        // Empty alternative matches, use the same token on next round
+                        if (type == OPTIONAL)
+                            continue;
+                        return false;
+                    }
+                }
+
+                tok = tok->next();
+            }
+            return true;
+        }
+
+    private:
+        CompiledPattern(const char pattern[], std::size_t size, std::size_t codeSize, bool interpret)
+            : mPattern(pattern), mSize(size), mCodeSize(codeSize), mInterpret(interpret) {}
+
+        const unsigned char *code() const {
+            return reinterpret_cast<const unsigned char *>(this + 1) + mSize;
+        }
+
+        /** Compare a token with a word, the words are short so this is faster than calling memcmp() */
+        static bool equalsWord(const std::string &str, const unsigned char *word, unsigned char len) {
+            if (str.size() != len)
+                return false;
+            const char *data = str.data();
+            for (unsigned char i = 0; i < len; ++i) {
+                if (data[i] != (char)word[i])
+                    return false;
+            }
+            return true;
+        }
+
+        static bool matchCommand(unsigned char command, const Token *tok, unsigned int varid) {
+            switch (command) {
+            case ANY:
+                return true;
+            case ASSIGN:
+                return tok->isAssignmentOp();
+            case BOOL:
+                return tok->isBoolean();
+            case CHAR:
+                return tok->tokType() == Token::eChar;
+            case COMP:
+                return tok->isComparisonOp();
+            case COP:
+                return tok->isConstOp();
+            case NAME:
+                return tok->isName();
+            case NUM:
+                return tok->isNumber();
+            case OP:
+                return tok->isOp();
+            case OR:
+                return tok->tokType() == Token::eBitOp && tok->str() == "|";
+            case OROR:
+                return tok->tokType() == Token::eLogicalOp && tok->str() == "||";
+            case STR:
+                return tok->tokType() == Token::eString;
+            case TYPE:
+                return tok->isName() && tok->varId() == 0 && !tok->isKeyword();
+            case VAR:
+                return tok->varId() != 0;
+            case VARID:
+                if (varid == 0)
+                    throw InternalError(tok, "Internal error. Token::Match called with varid 0. Please report this to Cppcheck developers");
+                return tok->varId() == varid;
+            }
+            return false;
+        }
+
+        /** Append a length and the characters, @return false if the string is too long */
+        static bool addString(std::string &code, const std::string &str) {
+            if (str.size() > 255)
+                return false;
+            code += (char)str.size();
+            code += str;
+            return true;
+        }
+
+        /** Split the pattern into words like Token::simpleMatch() does */
+        static bool compileSimpleMatch(const char pattern[], std::string &code) {
+            const char *current = pattern;
+            const char *next = std::strchr(pattern, ' ');
+            if (!next)
+                next = pattern + std::strlen(pattern);
+            while (*current) {
+                if (!addString(code, std::string(current, next - current)))
+                    return false;
+                current = next;
+                if (*next) {
+                    next = std::strchr(++current, ' ');
+                    if (!next)
+                        next = current + std::strlen(current);
+                }
+            }
+            return true;
+        }
+
+        /** Parse the words like Token::Match() does, @return false if the pattern must be interpreted */
+        static bool compileMatch(const char pattern[], std::string &code) {
+            static const std::map<std::string, Command> commands = {
+                { "%any%", ANY },
+                { "%assign%", ASSIGN },
+                { "%bool%", BOOL },
+                { "%char%", CHAR },
+                { "%comp%", COMP },
+                { "%cop%", COP },
+                { "%name%", NAME },
+                { "%num%", NUM },
+                { "%op%", OP },
+                { "%or%", OR },
+                { "%oror%", OROR },
+                { "%str%", STR },
+                { "%type%", TYPE },
+                { "%var%", VAR },
+                { "%varid%", VARID }
+            };
+
+            const char *p = pattern;
+            for (;;) {
+                while (*p == ' ')
+                    ++p;
+                if (*p == '\0')
+                    return true;
+                const char *end = p;
+                while (*end && *end != ' ')
+                    ++end;
+                const std::string str(p, end);
+                p = end;
+
+                // The interpreter compares a string literal token that contains spaces with several words
+                if (str.find_first_of("\"'") != std::string::npos)
+                    return false;
+
+                if (str[0] == '[' && str.find(']') != std::string::npos) {
+                    std::string characters;
+                    for (std::string::size_type i = 1; i < str.size(); ++i) {
+                        if (str[i] != ']')
+                            characters += str[i];
+                    }
+                    if (std::count(str.begin(), str.end(), ']') > 1)
+                        characters += ']';
+                    code += (char)CHARACTERS;
+                    if (!addString(code, characters))
+                        return false;
+                } else if (str.compare(0, 2, "!!") == 0 && (str.size() > 2 || *end != '\0')) {
+                    if (str.size() == 2)
+                        return false;
+                    code += (char)NOT;
+                    if (!addString(code, str.substr(2)))
+                        return false;
+                } else {
+                    std::string alternatives;
+                    unsigned int count = 0;
+                    bool optional = false;
+                    std::string::size_type start = 0;
+                    for (;;) {
+                        const std::string::size_type bar = str.find('|', start);
+                        const std::string alternative = str.substr(start, bar == std::string::npos ? std::string::npos : bar - start);
+                        if (bar == std::string::npos) {
+                            if (alternative.empty())
+                                optional = true;
+                        } else if (alternative.empty()) {
+                            // The interpreter skips empty alternatives that are not the last one
+                            return false;
+                        }
+                        if (alternative.size() > 1 && alternative[0] == '%') {
+                            const std::map<std::string, Command>::const_iterator command = commands.find(alternative);
+                            if (command == commands.end())
+                                return false;
+                            alternatives += (char)command->second;
+                            ++count;
+                        } else if (!alternative.empty()) {
+                            alternatives += (char)LITERAL;
+                            if (!addString(alternatives, alternative))
+                                return false;
+                            ++count;
+                        }
+                        if (bar == std::string::npos)
+                            break;
+                        start = bar + 1;
+                    }
+                    if (count > 255)
+                        return false;
+                    code += (char)(optional ? OPTIONAL : ALTERNATIVES);
+                    code += (char)count;
+                    code += alternatives;
+                }
+            }
+        }
+
+        const char *mPattern;
+        std::size_t mSize;
+        std::size_t mCodeSize;
+        bool mInterpret;
+    };
+}
+
+/**
+ * The compiled patterns, by address. Patterns are added by all threads and
+ * never removed. If the content at an address changes, the new content is
+ * compiled into the next slot.
+ */
+static const std::size_t COMPILED_PATTERNS = 1 << 14;
+static std::atomic<const CompiledPattern *> compiledSimpleMatchPatterns[COMPILED_PATTERNS];
+static std::atomic<const CompiledPattern *> compiledMatchPatterns[COMPILED_PATTERNS];
+
+static std::size_t hashPattern(const char pattern[])
+{
+    return (std::size_t)(((unsigned long long)reinterpret_cast<std::uintptr_t>(pattern) * 0x9E3779B97F4A7C15ULL) >> 50);
+}
+
+/** Find the pattern in the next slots or add it, @return the compiled pattern, null if the pattern is interpreted */
+static const CompiledPattern *addCompiledPattern(std::atomic<const CompiledPattern *> patterns[], const char pattern[], std::size_t size, bool simple)
+{
+    const std::size_t hash = hashPattern(pattern);
+    for (std::size_t i = 0; i < 8; ++i) {
+        std::atomic<const CompiledPattern *> &slot = patterns[(hash + i) % COMPILED_PATTERNS];
+        const CompiledPattern *compiled = slot.load(std::memory_order_acquire);
+        if (!compiled) {
+            const CompiledPattern *newPattern = CompiledPattern::create(pattern, size, simple);
+            if (slot.compare_exchange_strong(compiled, newPattern, std::memory_order_acq_rel))
+                compiled = newPattern;
+            else
+                CompiledPattern::destroy(newPattern); // added by another thread, compiled is set to its pattern
+        }
+        if (compiled->equals(pattern, size))
+            return compiled->interpret() ? nullptr : compiled;
+    }
+    // The slots are used by other patterns, the pattern is interpreted
+    return nullptr;
+}
+
+/** @return the compiled pattern, null if the pattern is interpreted */
+static inline const CompiledPattern *getCompiledPattern(std::atomic<const CompiledPattern *> patterns[], const char pattern[], std::size_t size, bool simple)
+{
+    const CompiledPattern *compiled = patterns[hashPattern(pattern)].load(std::memory_order_acquire);
+    if (compiled && compiled->equals(pattern, size))
+        return compiled->interpret() ? nullptr : compiled;
+    return addCompiledPattern(patterns, pattern, size, simple);
+}
+
+bool Token::simpleMatchCompiled(const Token *tok, const char pattern[], std::size_t size)
+{
+    const CompiledPattern *compiled = getCompiledPattern(compiledSimpleMatchPatterns, pattern, size, true);
+    return compiled ? compiled->simpleMatch(tok) : simpleMatch(tok, DynamicPattern(pattern));
+}
+
+bool Token::matchCompiled(const Token *tok, const char pattern[], std::size_t size, unsigned int varid)
+{
+    const CompiledPattern *compiled = getCompiledPattern(compiledMatchPatterns, pattern, size, false);
+    return compiled ? compiled->match(tok, varid) : Match(tok, DynamicPattern(pattern), varid);
+}
+
+const Token *Token::findsimplematchCompiled(const Token *startTok, const char pattern[], std::size_t size, const Token *end)
+{
+    const CompiledPattern *compiled = getCompiledPattern(compiledSimpleMatchPatterns, pattern, size, true);
+    for (const Token* tok = startTok; tok && tok != end; tok = tok->next()) {
+        if (compiled ? compiled->simpleMatch(tok) : simpleMatch(tok, DynamicPattern(pattern)))
+            return tok;
+    }
+    return nullptr;
+}
+
+const Token *Token::findmatchCompiled(const Token *startTok, const char pattern[], std::size_t size, const Token *end, unsigned int varid)
+{
+    const CompiledPattern *compiled = getCompiledPattern(compiledMatchPatterns, pattern, size, false);
+    for (const Token* tok = startTok; tok && tok != end; tok = tok->next()) {
+        if (compiled ? compiled->match(tok, varid) : Match(tok, DynamicPattern(pattern), varid))
+            return tok;
+    }
+    return nullptr;
+}
+
 std::size_t Token::getStrLength(const Token *tok)
 {
     assert(tok != nullptr);
@@ -919,7 +1426,7 @@ Token * Token::findOpeningBracket()
 
 //---------------------------------------------------------------------------
 
-const Token *Token::findsimplematch(const Token * const startTok, const char pattern[])
+const Token *Token::findsimplematch(const Token * const startTok, DynamicPattern pattern)
 {
     for (const Token* tok = startTok; tok; tok = tok->next()) {
         if (Token::simpleMatch(tok, pattern))
@@ -928,7 +1435,7 @@ const Token *Token::findsimplematch(const Token * const startTok, const char pat
     return nullptr;
 }
 
-const Token *Token::findsimplematch(const Token * const startTok, const char pattern[], const Token * const end)
+const Token *Token::findsimplematch(const Token * const startTok, DynamicPattern pattern, const Token * const end)
 {
     for (const Token* tok = startTok; tok && tok != end; tok = tok->next()) {
         if (Token::simpleMatch(tok, pattern))
@@ -937,7 +1444,7 @@ const Token *Token::findsimplematch(const Token * const startTok, const char pat
     return nullptr;
 }
 
-const Token *Token::findmatch(const Token * const startTok, const char pattern[], const unsigned int varId)
+const Token *Token::findmatch(const Token * const startTok, DynamicPattern pattern, const unsigned int varId)
 {
     for (const Token* tok = startTok; tok; tok = tok->next()) {
         if (Token::Match(tok, pattern, varId))
@@ -946,7 +1453,7 @@ const Token *Token::findmatch(const Token * const startTok, const char pattern[]
     return nullptr;
 }
 
-const Token *Token::findmatch(const Token * const startTok, const char pattern[], const Token * const end, const unsigned int varId)
+const Token *Token::findmatch(const Token * const startTok, DynamicPattern pattern, const Token * const end, const unsigned int varId)
 {
     for (const Token* tok = startTok; tok && tok != end; tok = tok->next()) {
         if (Token::Match(tok, pattern, varId))
@@ -961,14 +1468,14 @@ void Token::insertToken(const std::string &tokenStr, const std::string &original
     if (mStr.empty())
         newToken = this;
     else
-        newToken = new Token(mTokensFrontBack);
+        newToken = Token::create(mTokensFrontBack);
     newToken->str(tokenStr);
     if (!originalNameStr.empty())
         newToken->originalName(originalNameStr);
 
     if (newToken != this) {
-        newToken->mImpl->mLineNumber = mImpl->mLineNumber;
-        newToken->mImpl->mFileIndex = mImpl->mFileIndex;
+        newToken->mLineNumber = mLineNumber;
+        newToken->mFileIndex = mFileIndex;
         newToken->mImpl->mProgressValue = mImpl->mProgressValue;
 
         if (prepend) {
@@ -1059,8 +1566,8 @@ void Token::stringify(std::ostream& os, bool varid, bool attributes, bool macro)
                 os << mStr[i];
         }
     }
-    if (varid && mImpl->mVarId != 0)
-        os << '@' << mImpl->mVarId;
+    if (varid && mVarId != 0)
+        os << '@' << mVarId;
 }
 
 std::string Token::stringifyList(bool varid, bool attributes, bool linenumbers, bool linebreaks, bool files, const std::vector<std::string>* fileNames, const Token* end) const
@@ -1070,21 +1577,21 @@ std::string Token::stringifyList(bool varid, bool attributes, bool linenumbers,
 
     std::ostringstream ret;
 
-    unsigned int lineNumber = mImpl->mLineNumber - (linenumbers ? 1U : 0U);
-    unsigned int fileInd = files ? ~0U : mImpl->mFileIndex;
+    unsigned int lineNumber = mLineNumber - (linenumbers ? 1U : 0U);
+    unsigned int fileInd = files ? ~0U : mFileIndex;
     std::map<int, unsigned int> lineNumbers;
     for (const Token *tok = this; tok != end; tok = tok->next()) {
         bool fileChange = false;
-        if (tok->mImpl->mFileIndex != fileInd) {
+        if (tok->mFileIndex != fileInd) {
             if (fileInd != ~0U) {
-                lineNumbers[fileInd] = tok->mImpl->mFileIndex;
+                lineNumbers[fileInd] = tok->mFileIndex;
             }
 
-            fileInd = tok->mImpl->mFileIndex;
+            fileInd = tok->mFileIndex;
             if (files) {
                 ret << "\n\n##file ";
-                if (fileNames && fileNames->size() > tok->mImpl->mFileIndex)
-                    ret << fileNames->at(tok->mImpl->mFileIndex);
+                if (fileNames && fileNames->size() > tok->mFileIndex)
+                    ret << fileNames->at(tok->mFileIndex);
                 else
                     ret << fileInd;
                 ret << '\n';
@@ -1095,7 +1602,7 @@ std::string Token::stringifyList(bool varid, bool attributes, bool linenumbers,
         }
 
         if (linebreaks && (lineNumber != tok->linenr() || fileChange)) {
-            if (lineNumber+4 < tok->linenr() && fileInd == tok->mImpl->mFileIndex) {
+            if (lineNumber+4 < tok->linenr() && fileInd == tok->mFileIndex) {
                 ret << '\n' << lineNumber+1 << ":\n|\n";
                 ret << tok->linenr()-1 << ":\n";
                 ret << tok->linenr() << ": ";
@@ -1136,37 +1643,37 @@ std::string Token::stringifyList(bool varid) const
 
 void Token::astOperand1(Token *tok)
 {
-    if (mImpl->mAstOperand1)
-        mImpl->mAstOperand1->mImpl->mAstParent = nullptr;
+    if (mAstOperand1)
+        mAstOperand1->mAstParent = nullptr;
     // goto parent operator
     if (tok) {
         std::set<Token*> visitedParents;
-        while (tok->mImpl->mAstParent) {
-            if (!visitedParents.insert(tok->mImpl->mAstParent).second) // #6838/#6726/#8352 avoid hang on garbage code
+        while (tok->mAstParent) {
+            if (!visitedParents.insert(tok->mAstParent).second) // #6838/#6726/#8352 avoid hang on garbage code
                 throw InternalError(this, "Internal error. Token::astOperand1() cyclic dependency.");
-            tok = tok->mImpl->mAstParent;
+            tok = tok->mAstParent;
         }
-        tok->mImpl->mAstParent = this;
+        tok->mAstParent = this;
     }
-    mImpl->mAstOperand1 = tok;
+    mAstOperand1 = tok;
 }
 
 void Token::astOperand2(Token *tok)
 {
-    if (mImpl->mAstOperand2)
-        mImpl->mAstOperand2->mImpl->mAstParent = nullptr;
+    if (mAstOperand2)
+        mAstOperand2->mAstParent = nullptr;
     // goto parent operator
     if (tok) {
         std::set<Token*> visitedParents;
-        while (tok->mImpl->mAstParent) {
+        while (tok->mAstParent) {
             //std::cout << tok << " -> " << tok->mAstParent ;
-            if (!visitedParents.insert(tok->mImpl->mAstParent).second) // #6838/#6726 avoid hang on garbage code
+            if (!visitedParents.insert(tok->mAstParent).second) // #6838/#6726 avoid hang on garbage code
                 throw InternalError(this, "Internal error. Token::astOperand2() cyclic dependency.");
-            tok = tok->mImpl->mAstParent;
+            tok = tok->mAstParent;
         }
-        tok->mImpl->mAstParent = this;
+        tok->mAstParent = this;
     }
-    mImpl->mAstOperand2 = tok;
+    mAstOperand2 = tok;
 }
 
 static const Token* goToLeftParenthesis(const Token* start, const Token* end)
@@ -1285,9 +1792,9 @@ bool Token::isUnaryPreOp() const
     const Token *tokbefore = mPrevious;
     const Token *tokafter = mNext;
     for (int distance = 1; distance < 10 && tokbefore; distance++) {
-        if (tokbefore == mImpl->mAstOperand1)
+        if (tokbefore == mAstOperand1)
             return false;
-        if (tokafter == mImpl->mAstOperand1)
+        if (tokafter == mAstOperand1)
             return true;
         tokbefore = tokbefore->mPrevious;
         tokafter  = tokafter->mPrevious;
@@ -1353,7 +1860,7 @@ void Token::printAst(bool verbose, bool xml, std::ostream &out) const
 {
     std::set<const Token *> printed;
     for (const Token *tok = this; tok; tok = tok->next()) {
-        if (!tok->mImpl->mAstParent && tok->mImpl->mAstOperand1) {
+        if (!tok->mAstParent && tok->mAstOperand1) {
             if (printed.empty() && !xml)
                 out << "\n\n##AST" << std::endl;
             else if (printed.find(tok) != printed.end())
@@ -1392,21 +1899,21 @@ void Token::astStringVerboseRecursive(std::string& ret, const unsigned int inden
         ret += " \'" + mImpl->mValueType->str() + '\'';
     ret += '\n';
 
-    if (mImpl->mAstOperand1) {
+    if (mAstOperand1) {
         unsigned int i1 = indent1, i2 = indent2 + 2;
-        if (indent1 == indent2 && !mImpl->mAstOperand2)
+        if (indent1 == indent2 && !mAstOperand2)
             i1 += 2;
         indent(ret, indent1, indent2);
-        ret += mImpl->mAstOperand2 ? "|-" : "`-";
-        mImpl->mAstOperand1->astStringVerboseRecursive(ret, i1, i2);
+        ret += mAstOperand2 ? "|-" : "`-";
+        mAstOperand1->astStringVerboseRecursive(ret, i1, i2);
     }
-    if (mImpl->mAstOperand2) {
+    if (mAstOperand2) {
         unsigned int i1 = indent1, i2 = indent2 + 2;
         if (indent1 == indent2)
             i1 += 2;
         indent(ret, indent1, indent2);
         ret += "`-";
-        mImpl->mAstOperand2->astStringVerboseRecursive(ret, i1, i2);
+        mAstOperand2->astStringVerboseRecursive(ret, i1, i2);
     }
 }
 
@@ -1529,7 +2036,7 @@ const ValueFlow::Value * Token::getValueLE(const MathLib::bigint val, const Sett
     if (!mImpl->mValues)
         return nullptr;
     const ValueFlow::Value *ret = nullptr;
-    std::list<ValueFlow::Value>::const_iterator it;
+    ValueFlow::Values::const_iterator it;
     for (it = mImpl->mValues->begin(); it != mImpl->mValues->end(); ++it) {
         if (it->isIntValue() && it->intvalue <= val) {
             if (!ret || ret->isInconclusive() || (ret->condition && !it->isInconclusive()))
@@ -1552,7 +2059,7 @@ const ValueFlow::Value * Token::getValueGE(const MathLib::bigint val, const Sett
     if (!mImpl->mValues)
         return nullptr;
     const ValueFlow::Value *ret = nullptr;
-    std::list<ValueFlow::Value>::const_iterator it;
+    ValueFlow::Values::const_iterator it;
     for (it = mImpl->mValues->begin(); it != mImpl->mValues->end(); ++it) {
         if (it->isIntValue() && it->intvalue >= val) {
             if (!ret || ret->isInconclusive() || (ret->condition && !it->isInconclusive()))
@@ -1575,7 +2082,7 @@ const ValueFlow::Value * Token::getInvalidValue(const Token *ftok, unsigned int
     if (!mImpl->mValues || !settings)
         return nullptr;
     const ValueFlow::Value *ret = nullptr;
-    std::list<ValueFlow::Value>::const_iterator it;
+    ValueFlow::Values::const_iterator it;
     for (it = mImpl->mValues->begin(); it != mImpl->mValues->end(); ++it) {
         if ((it->isIntValue() && !settings->library.isIntArgValid(ftok, argnr, it->intvalue)) ||
             (it->isFloatValue() && !settings->library.isFloatArgValid(ftok, argnr, it->floatValue))) {
@@ -1600,7 +2107,7 @@ const Token *Token::getValueTokenMinStrSize() const
         return nullptr;
     const Token *ret = nullptr;
     std::size_t minsize = ~0U;
-    std::list<ValueFlow::Value>::const_iterator it;
+    ValueFlow::Values::const_iterator it;
     for (it = mImpl->mValues->begin(); it != mImpl->mValues->end(); ++it) {
         if (it->isTokValue() && it->tokvalue && it->tokvalue->tokType() == Token::eString) {
             const std::size_t size = getStrSize(it->tokvalue);
@@ -1619,7 +2126,7 @@ const Token *Token::getValueTokenMaxStrLength() const
         return nullptr;
     const Token *ret = nullptr;
     std::size_t maxlength = 0U;
-    std::list<ValueFlow::Value>::const_iterator it;
+    ValueFlow::Values::const_iterator it;
     for (it = mImpl->mValues->begin(); it != mImpl->mValues->end(); ++it) {
         if (it->isTokValue() && it->tokvalue && it->tokvalue->tokType() == Token::eString) {
             const std::size_t length = getStrLength(it->tokvalue);
@@ -1643,7 +2150,7 @@ const Token *Token::getValueTokenDeadPointer() const
 {
     const Scope * const functionscope = getfunctionscope(this->scope());
 
-    std::list<ValueFlow::Value>::const_iterator it;
+    ValueFlow::Values::const_iterator it;
     for (it = values().begin(); it != values().end(); ++it) {
         // Is this a pointer alias?
         if (!it->isTokValue() || (it->tokvalue && it->tokvalue->str() != "&"))
@@ -1676,19 +2183,24 @@ bool Token::addValue(const ValueFlow::Value &value)
 {
     if (value.isKnown() && mImpl->mValues) {
         // Clear all other values of the same type since value is known
-        mImpl->mValues->remove_if([&](const ValueFlow::Value & x) {
+        removeValues([&](const ValueFlow::Value & x) {
             return x.valueType == value.valueType;
         });
     }
 
+    ValueFlow::Changes * const changes = mTokensFrontBack ? mTokensFrontBack->valueFlowChanges : nullptr;
+    const Settings * const settings = mTokensFrontBack ? mTokensFrontBack->settings : nullptr;
+
     if (mImpl->mValues) {
-        // Don't handle more than 10 values for performance reasons
-        // TODO: add setting?
-        if (mImpl->mValues->size() >= 10U)
+        // Don't handle too many values for performance reasons
+        if (settings && mImpl->mValues->size() >= settings->valueFlowMaxValues) {
+            if (changes)
+                changes->dropValue();
             return false;
+        }
 
         // if value already exists, don't add it again
-        std::list<ValueFlow::Value>::iterator it;
+        ValueFlow::Values::iterator it;
         for (it = mImpl->mValues->begin(); it != mImpl->mValues->end(); ++it) {
             // different intvalue => continue
             if (it->intvalue != value.intvalue)
@@ -1704,7 +2216,9 @@ bool Token::addValue(const ValueFlow::Value &value)
             if (it->isInconclusive() && !value.isInconclusive()) {
                 *it = value;
                 if (it->varId == 0)
-                    it->varId = mImpl->mVarId;
+                    it->varId = mVarId;
+                if (changes)
+                    changes->changeValue(mImpl->mScope);
                 break;
             }
 
@@ -1716,17 +2230,22 @@ bool Token::addValue(const ValueFlow::Value &value)
         if (it == mImpl->mValues->end()) {
             ValueFlow::Value v(value);
             if (v.varId == 0)
-                v.varId = mImpl->mVarId;
+                v.varId = mVarId;
             if (v.isKnown() && v.isIntValue())
-                mImpl->mValues->push_front(v);
+                mImpl->mValues->insert(mImpl->mValues->begin(), v);
             else
                 mImpl->mValues->push_back(v);
+            if (changes)
+                changes->addValue(mImpl->mScope);
         }
     } else {
         ValueFlow::Value v(value);
         if (v.varId == 0)
-            v.varId = mImpl->mVarId;
-        mImpl->mValues = new std::list<ValueFlow::Value>(1, v);
+            v.varId = mVarId;
+        mImpl->mValues = new ValueFlow::Values;
+        mImpl->mValues->push_back(v);
+        if (changes)
+            changes->addValue(mImpl->mScope);
     }
 
     return true;
@@ -1742,20 +2261,21 @@ void Token::assignProgressValues(Token *tok)
         tok2->mImpl->mProgressValue = count++ * 100 / total_count;
 }
 
-void Token::setValueType(ValueType *vt)
+void Token::setValueType(const ValueType *vt)
 {
-    if (vt != mImpl->mValueType) {
-        delete mImpl->mValueType;
-        mImpl->mValueType = vt;
-    }
+    if (vt == mImpl->mValueType)
+        return;
+    ValueType *copy = vt ? TokenArena::create<ValueType>(mImpl->mArena, *vt) : nullptr;
+    TokenArena::destroy(mImpl->mArena, mImpl->mValueType);
+    mImpl->mValueType = copy;
 }
 
 void Token::type(const ::Type *t)
 {
-    mImpl->mType = t;
+    mType = t;
     if (t) {
         tokType(eType);
-        isEnumType(mImpl->mType->isEnumType());
+        isEnumType(mType->isEnumType());
     } else if (mTokType == eType)
         tokType(eName);
 }
@@ -1835,11 +2355,13 @@ std::string Token::typeStr(const Token* tok)
 
 TokenImpl::~TokenImpl()
 {
-    delete mOriginalName;
-    delete mValueType;
+    TokenArena::destroy(mArena, mValueType);
     delete mValues;
 
-    for (auto templateSimplifierPointer : mTemplateSimplifierPointers) {
-        templateSimplifierPointer->token = nullptr;
+    if (mRareData) {
+        for (auto templateSimplifierPointer : mRareData->mTemplateSimplifierPointers) {
+            templateSimplifierPointer->token = nullptr;
+        }
+        TokenArena::destroy(mArena, mRareData);
     }
 }
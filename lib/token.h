@@ -30,14 +30,18 @@
 #include <cstddef>
 #include <functional>
 #include <list>
+#include <new>
 #include <ostream>
 #include <string>
+#include <type_traits>
+#include <utility>
 #include <vector>
 
 class Enumerator;
 class Function;
 class Scope;
 class Settings;
+class TokenArena;
 class Type;
 class ValueType;
 class Variable;
@@ -48,43 +52,102 @@ class Variable;
 struct TokensFrontBack {
     Token *front;
     Token *back;
+
+    /** Where value changes are recorded, set while ValueFlow::setValues() runs */
+    ValueFlow::Changes *valueFlowChanges;
+
+    /** Memory for the tokens of the list, may be null */
+    TokenArena *arena;
+
+    /** Settings of the token list, may be null */
+    const Settings *settings;
 };
 
-struct TokenImpl {
-    unsigned int mVarId;
-    unsigned int mFileIndex;
-    unsigned int mLineNumber;
-    unsigned int mColumn;
+/**
+ * @brief Memory for the tokens of a token list and their side data.
+ *
+ * Objects are carved out of large blocks and freed objects are kept in a
+ * free list per size, so a token list does not need a malloc and a free
+ * per token. The blocks are released together.
+ */
+class CPPCHECKLIB TokenArena {
+public:
+    TokenArena();
+    ~TokenArena();
 
-    // AST..
-    Token *mAstOperand1;
-    Token *mAstOperand2;
-    Token *mAstParent;
+    /** Allocate size bytes */
+    void *allocate(std::size_t size);
 
-    // symbol database information
-    const Scope *mScope;
-    union {
-        const Function *mFunction;
-        const Variable *mVariable;
-        const ::Type* mType;
-        const Enumerator *mEnumerator;
-    };
+    /** Give back memory that allocate() returned for the same size */
+    void deallocate(void *p, std::size_t size);
 
-    /**
-     * A value from 0-100 that provides a rough idea about where in the token
-     * list this token is located.
-     */
-    unsigned int mProgressValue;
+    /** Release the blocks if nothing is allocated from them */
+    void clear();
 
-    // original name like size_t
-    std::string* mOriginalName;
+    /** Bytes taken from the heap */
+    std::size_t size() const {
+        return mSize;
+    }
 
-    // ValueType
-    ValueType *mValueType;
+    /** Number of allocations */
+    std::size_t allocations() const {
+        return mAllocations;
+    }
+
+    /** Number of allocations that reused freed memory */
+    std::size_t reused() const {
+        return mReused;
+    }
+
+    /** Create an object in the arena, or with new if there is no arena */
+    template<class T, class ... Args>
+    static T *create(TokenArena *arena, Args&& ... args) {
+        static_assert(alignof(T) <= ALIGNMENT, "type is aligned more strictly than the arena");
+        if (!arena)
+            return new T(std::forward<Args>(args)...);
+        return new (arena->allocate(sizeof(T))) T(std::forward<Args>(args)...);
+    }
+
+    /** Destroy an object that create() returned for the same arena */
+    template<class T>
+    static void destroy(TokenArena *arena, T *p) {
+        if (!arena) {
+            delete p;
+        } else if (p) {
+            p->~T();
+            arena->deallocate(p, sizeof(T));
+        }
+    }
+
+private:
+    // Not implemented..
+    TokenArena(const TokenArena &);
+    TokenArena &operator=(const TokenArena &);
 
-    // ValueFlow
-    std::list<ValueFlow::Value>* mValues;
-    static const std::list<ValueFlow::Value> mEmptyValueList;
+    static const std::size_t ALIGNMENT = 8;
+
+    /** Larger objects are allocated with operator new */
+    static const std::size_t MAX_SMALL_SIZE = 512;
+
+    struct FreeObject {
+        FreeObject *next;
+    };
+
+    FreeObject *mFree[MAX_SMALL_SIZE / ALIGNMENT + 1];
+    std::vector<char *> mBlocks;
+    char *mPos;
+    char *mEnd;
+    std::size_t mNextBlockSize;
+    std::size_t mSize;
+    std::size_t mAllocations;
+    std::size_t mReused;
+    std::size_t mLive;
+};
+
+/** Token data that few tokens have, see TokenImpl::mRareData */
+struct TokenRareData {
+    // original name like size_t
+    std::string mOriginalName;
 
     /** Bitfield bit count. */
     unsigned char mBits;
@@ -92,25 +155,54 @@ struct TokenImpl {
     // Pointer to a template in the template simplifier
     std::set<TemplateSimplifier::TokenAndName*> mTemplateSimplifierPointers;
 
-    TokenImpl()
-        : mVarId(0)
-        , mFileIndex(0)
-        , mLineNumber(0)
-        , mColumn(0)
-        , mAstOperand1(nullptr)
-        , mAstOperand2(nullptr)
-        , mAstParent(nullptr)
-        , mScope(nullptr)
-        , mFunction(nullptr) // Initialize whole union
-        , mProgressValue(0)
-        , mOriginalName(nullptr)
-        , mValueType(nullptr)
-        , mValues(nullptr)
+    TokenRareData()
+        : mOriginalName()
         , mBits(0)
         , mTemplateSimplifierPointers()
     {}
+};
+
+/** Token data that is not read in the loops over the tokens, see Token */
+struct TokenImpl {
+    // symbol database information
+    const Scope *mScope;
+
+    // ValueType
+    ValueType *mValueType;
+
+    // ValueFlow, always on the heap since ValueFlow threads add values
+    ValueFlow::Values* mValues;
+    static const ValueFlow::Values mEmptyValueList;
+
+    /** Original name, bits and template pointers, null if the token has none */
+    TokenRareData *mRareData;
+    static const std::set<TemplateSimplifier::TokenAndName*> mEmptyTemplateSimplifierPointers;
+
+    /** Where this, the value type and the rare data are allocated, may be null */
+    TokenArena *mArena;
+
+    /**
+     * A value from 0-100 that provides a rough idea about where in the token
+     * list this token is located.
+     */
+    unsigned int mProgressValue;
+
+    explicit TokenImpl(TokenArena *arena)
+        : mScope(nullptr)
+        , mValueType(nullptr)
+        , mValues(nullptr)
+        , mRareData(nullptr)
+        , mArena(arena)
+        , mProgressValue(0)
+    {}
 
     ~TokenImpl();
+
+    TokenRareData &rareData() {
+        if (!mRareData)
+            mRareData = TokenArena::create<TokenRareData>(mArena);
+        return *mRareData;
+    }
 };
 
 /// @addtogroup Core
@@ -128,14 +220,12 @@ struct TokenImpl {
  */
 class CPPCHECKLIB Token {
 private:
-    TokensFrontBack* mTokensFrontBack;
-
     // Not implemented..
     Token(const Token &);
     Token operator=(const Token &);
 
 public:
-    enum Type {
+    enum Type : unsigned char {
         eVariable, eType, eFunction, eKeyword, eName, // Names: Variable (varId), Type (typeId, later), Function (FuncId, later), Language keyword, Name (unknown identifier)
         eNumber, eString, eChar, eBoolean, eLiteral, eEnumerator, // Literals: Number, String, Character, Boolean, User defined literal (C++11), Enumerator
         eArithmeticalOp, eComparisonOp, eAssignmentOp, eLogicalOp, eBitOp, eIncDecOp, eExtendedOp, // Operators: Arithmetical, Comparison, Assignment, Logical, Bitwise, ++/--, Extended
@@ -147,10 +237,14 @@ public:
     explicit Token(TokensFrontBack *tokensFrontBack = nullptr);
     ~Token();
 
+    /** Create a token in the arena of the token list, delete it with destroy() */
+    static Token *create(TokensFrontBack *tokensFrontBack);
+    static void destroy(Token *tok);
+
     template<typename T>
     void str(T&& s) {
         mStr = s;
-        mImpl->mVarId = 0;
+        mVarId = 0;
 
         update_property_info();
     }
@@ -205,6 +299,19 @@ public:
      */
     const std::string &strAt(int index) const;
 
+    /**
+     * A pattern of simpleMatch(), Match() or findmatch() that is not a
+     * string literal, e.g. the result of std::string::c_str(). String
+     * literal patterns are compiled the first time they are used, these
+     * patterns and patterns in non-const arrays are interpreted each time.
+     * The compiled pattern is found by its address and its content, so a
+     * const local array is compiled again when it has new content.
+     */
+    struct DynamicPattern {
+        DynamicPattern(const char str[]) : str(str) {}
+        const char *str;
+    };
+
     /**
      * Match given token (or list of tokens) to a pattern list.
      *
@@ -224,7 +331,13 @@ public:
      * @return true if given token matches with given pattern
      *         false if given token does not match with given pattern
      */
-    static bool simpleMatch(const Token *tok, const char pattern[]);
+    static bool simpleMatch(const Token *tok, DynamicPattern pattern);
+    template<class T, std::size_t N>
+    static bool simpleMatch(const Token *tok, T (&pattern)[N]) {
+        if (!std::is_const<T>::value)
+            return simpleMatch(tok, DynamicPattern(pattern));
+        return tok && simpleMatchCompiled(tok, pattern, N);
+    }
 
     /**
      * Match given token (or list of tokens) to a pattern list.
@@ -269,7 +382,13 @@ public:
      * @return true if given token matches with given pattern
      *         false if given token does not match with given pattern
      */
-    static bool Match(const Token *tok, const char pattern[], unsigned int varid = 0);
+    static bool Match(const Token *tok, DynamicPattern pattern, unsigned int varid = 0);
+    template<class T, std::size_t N>
+    static bool Match(const Token *tok, T (&pattern)[N], unsigned int varid = 0) {
+        if (!std::is_const<T>::value)
+            return Match(tok, DynamicPattern(pattern), varid);
+        return matchCompiled(tok, pattern, N, varid);
+    }
 
     /**
      * @return length of C-string.
@@ -302,7 +421,8 @@ public:
     const ValueType *valueType() const {
         return mImpl->mValueType;
     }
-    void setValueType(ValueType *vt);
+    /** Set a copy of vt as value type, or remove the value type if vt is null */
+    void setValueType(const ValueType *vt);
 
     const ValueType *argumentType() const {
         const Token *top = this;
@@ -520,19 +640,23 @@ public:
     }
 
     bool isBitfield() const {
-        return mImpl->mBits > 0;
+        return mImpl->mRareData && mImpl->mRareData->mBits > 0;
     }
     unsigned char bits() const {
-        return mImpl->mBits;
+        return mImpl->mRareData ? mImpl->mRareData->mBits : 0;
     }
-    std::set<TemplateSimplifier::TokenAndName*> &templateSimplifierPointers() const {
-        return mImpl->mTemplateSimplifierPointers;
+    const std::set<TemplateSimplifier::TokenAndName*> &templateSimplifierPointers() const {
+        return mImpl->mRareData ? mImpl->mRareData->mTemplateSimplifierPointers : TokenImpl::mEmptyTemplateSimplifierPointers;
     }
     void templateSimplifierPointer(TemplateSimplifier::TokenAndName* tokenAndName) {
-        mImpl->mTemplateSimplifierPointers.insert(tokenAndName);
+        mImpl->rareData().mTemplateSimplifierPointers.insert(tokenAndName);
+    }
+    void removeTemplateSimplifierPointer(TemplateSimplifier::TokenAndName* tokenAndName) {
+        if (mImpl->mRareData)
+            mImpl->mRareData->mTemplateSimplifierPointers.erase(tokenAndName);
     }
     void setBits(const unsigned char b) {
-        mImpl->mBits = b;
+        mImpl->rareData().mBits = b;
     }
 
     /**
@@ -559,20 +683,48 @@ public:
         setFlag(fIsTemplateArg, value);
     }
 
-    static const Token *findsimplematch(const Token * const startTok, const char pattern[]);
-    static const Token *findsimplematch(const Token * const startTok, const char pattern[], const Token * const end);
-    static const Token *findmatch(const Token * const startTok, const char pattern[], const unsigned int varId = 0U);
-    static const Token *findmatch(const Token * const startTok, const char pattern[], const Token * const end, const unsigned int varId = 0U);
-    static Token *findsimplematch(Token * const startTok, const char pattern[]) {
+    static const Token *findsimplematch(const Token * const startTok, DynamicPattern pattern);
+    static const Token *findsimplematch(const Token * const startTok, DynamicPattern pattern, const Token * const end);
+    static const Token *findmatch(const Token * const startTok, DynamicPattern pattern, const unsigned int varId = 0U);
+    static const Token *findmatch(const Token * const startTok, DynamicPattern pattern, const Token * const end, const unsigned int varId = 0U);
+    template<class T, std::size_t N>
+    static const Token *findsimplematch(const Token * const startTok, T (&pattern)[N]) {
+        if (!std::is_const<T>::value)
+            return findsimplematch(startTok, DynamicPattern(pattern));
+        return findsimplematchCompiled(startTok, pattern, N, nullptr);
+    }
+    template<class T, std::size_t N>
+    static const Token *findsimplematch(const Token * const startTok, T (&pattern)[N], const Token * const end) {
+        if (!std::is_const<T>::value)
+            return findsimplematch(startTok, DynamicPattern(pattern), end);
+        return findsimplematchCompiled(startTok, pattern, N, end);
+    }
+    template<class T, std::size_t N>
+    static const Token *findmatch(const Token * const startTok, T (&pattern)[N], const unsigned int varId = 0U) {
+        if (!std::is_const<T>::value)
+            return findmatch(startTok, DynamicPattern(pattern), varId);
+        return findmatchCompiled(startTok, pattern, N, nullptr, varId);
+    }
+    template<class T, std::size_t N>
+    static const Token *findmatch(const Token * const startTok, T (&pattern)[N], const Token * const end, const unsigned int varId = 0U) {
+        if (!std::is_const<T>::value)
+            return findmatch(startTok, DynamicPattern(pattern), end, varId);
+        return findmatchCompiled(startTok, pattern, N, end, varId);
+    }
+    template<class T>
+    static Token *findsimplematch(Token * const startTok, T &&pattern) {
         return const_cast<Token *>(findsimplematch(const_cast<const Token *>(startTok), pattern));
     }
-    static Token *findsimplematch(Token * const startTok, const char pattern[], const Token * const end) {
+    template<class T>
+    static Token *findsimplematch(Token * const startTok, T &&pattern, const Token * const end) {
         return const_cast<Token *>(findsimplematch(const_cast<const Token *>(startTok), pattern, end));
     }
-    static Token *findmatch(Token * const startTok, const char pattern[], const unsigned int varId = 0U) {
+    template<class T>
+    static Token *findmatch(Token * const startTok, T &&pattern, const unsigned int varId = 0U) {
         return const_cast<Token *>(findmatch(const_cast<const Token *>(startTok), pattern, varId));
     }
-    static Token *findmatch(Token * const startTok, const char pattern[], const Token * const end, const unsigned int varId = 0U) {
+    template<class T>
+    static Token *findmatch(Token * const startTok, T &&pattern, const Token * const end, const unsigned int varId = 0U) {
         return const_cast<Token *>(findmatch(const_cast<const Token *>(startTok), pattern, end, varId));
     }
 
@@ -593,24 +745,24 @@ public:
     static int multiCompare(const Token *tok, const char *haystack, unsigned int varid);
 
     unsigned int fileIndex() const {
-        return mImpl->mFileIndex;
+        return mFileIndex;
     }
     void fileIndex(unsigned int indexOfFile) {
-        mImpl->mFileIndex = indexOfFile;
+        mFileIndex = indexOfFile;
     }
 
     unsigned int linenr() const {
-        return mImpl->mLineNumber;
+        return mLineNumber;
     }
     void linenr(unsigned int lineNumber) {
-        mImpl->mLineNumber = lineNumber;
+        mLineNumber = lineNumber;
     }
 
     unsigned int col() const {
-        return mImpl->mColumn;
+        return mColumn;
     }
     void col(unsigned int c) {
-        mImpl->mColumn = c;
+        mColumn = c;
     }
 
     Token *next() const {
@@ -643,10 +795,10 @@ public:
 
 
     unsigned int varId() const {
-        return mImpl->mVarId;
+        return mVarId;
     }
     void varId(unsigned int id) {
-        mImpl->mVarId = id;
+        mVarId = id;
         if (id != 0) {
             tokType(eVariable);
             isStandardType(false);
@@ -760,7 +912,7 @@ public:
      * @param f Function to be associated
      */
     void function(const Function *f) {
-        mImpl->mFunction = f;
+        mFunction = f;
         if (f)
             tokType(eFunction);
         else if (mTokType == eFunction)
@@ -771,7 +923,7 @@ public:
      * @return a pointer to the Function associated with this token.
      */
     const Function *function() const {
-        return mTokType == eFunction ? mImpl->mFunction : nullptr;
+        return mTokType == eFunction ? mFunction : nullptr;
     }
 
     /**
@@ -779,8 +931,8 @@ public:
      * @param v Variable to be associated
      */
     void variable(const Variable *v) {
-        mImpl->mVariable = v;
-        if (v || mImpl->mVarId)
+        mVariable = v;
+        if (v || mVarId)
             tokType(eVariable);
         else if (mTokType == eVariable)
             tokType(eName);
@@ -790,7 +942,7 @@ public:
      * @return a pointer to the variable associated with this token.
      */
     const Variable *variable() const {
-        return mTokType == eVariable ? mImpl->mVariable : nullptr;
+        return mTokType == eVariable ? mVariable : nullptr;
     }
 
     /**
@@ -803,7 +955,7 @@ public:
     * @return a pointer to the type associated with this token.
     */
     const ::Type *type() const {
-        return mTokType == eType ? mImpl->mType : nullptr;
+        return mTokType == eType ? mType : nullptr;
     }
 
     static const ::Type *typeOf(const Token *tok);
@@ -816,7 +968,7 @@ public:
     * @return a pointer to the Enumerator associated with this token.
     */
     const Enumerator *enumerator() const {
-        return mTokType == eEnumerator ? mImpl->mEnumerator : nullptr;
+        return mTokType == eEnumerator ? mEnumerator : nullptr;
     }
 
     /**
@@ -824,7 +976,7 @@ public:
      * @param e Enumerator to be associated
      */
     void enumerator(const Enumerator *e) {
-        mImpl->mEnumerator = e;
+        mEnumerator = e;
         if (e)
             tokType(eEnumerator);
         else if (mTokType == eEnumerator)
@@ -897,10 +1049,10 @@ public:
      * @return the original name.
      */
     const std::string & originalName() const {
-        return mImpl->mOriginalName ? *mImpl->mOriginalName : emptyString;
+        return mImpl->mRareData ? mImpl->mRareData->mOriginalName : emptyString;
     }
 
-    const std::list<ValueFlow::Value>& values() const {
+    const ValueFlow::Values& values() const {
         return mImpl->mValues ? *mImpl->mValues : mImpl->mEmptyValueList;
     }
 
@@ -909,10 +1061,7 @@ public:
      */
     template<typename T>
     void originalName(T&& name) {
-        if (!mImpl->mOriginalName)
-            mImpl->mOriginalName = new std::string(name);
-        else
-            *mImpl->mOriginalName = name;
+        mImpl->rareData().mOriginalName = name;
     }
 
     bool hasKnownIntValue() const {
@@ -978,13 +1127,20 @@ public:
 
     const Token *getValueTokenDeadPointer() const;
 
-    /** Add token value. Return true if value is added. */
+    /**
+     * Add token value. Return true if value is added. A token can have at
+     * most Settings::valueFlowMaxValues values, when the token list has settings.
+     */
     bool addValue(const ValueFlow::Value &value);
 
     template<class Predicate>
     void removeValues(Predicate pred) {
-        if (mImpl->mValues)
+        if (mImpl->mValues) {
+            const std::size_t size = mImpl->mValues->size();
             mImpl->mValues->remove_if(pred);
+            if (mTokensFrontBack && mTokensFrontBack->valueFlowChanges)
+                mTokensFrontBack->valueFlowChanges->removeValues(size - mImpl->mValues->size());
+        }
     }
 
 private:
@@ -1013,11 +1169,15 @@ private:
      */
     static const char *chrInFirstWord(const char *str, char c);
 
-    std::string mStr;
-
-    Token *mNext;
-    Token *mPrevious;
-    Token *mLink;
+    /**
+     * simpleMatch(), Match() and findmatch() with a string literal
+     * pattern of @p size characters, the pattern is compiled the first
+     * time it is used
+     */
+    static bool simpleMatchCompiled(const Token *tok, const char pattern[], std::size_t size);
+    static bool matchCompiled(const Token *tok, const char pattern[], std::size_t size, unsigned int varid);
+    static const Token *findsimplematchCompiled(const Token *startTok, const char pattern[], std::size_t size, const Token *end);
+    static const Token *findmatchCompiled(const Token *startTok, const char pattern[], std::size_t size, const Token *end, unsigned int varid);
 
     enum {
         fIsUnsigned             = (1 << 0),
@@ -1047,12 +1207,46 @@ private:
         fAtAddress              = (1 << 24), // @ 0x4000
     };
 
+    // The data that the loops over the tokens read is stored here and the
+    // rest in TokenImpl. With a 64-bit std::string of 32 bytes, what
+    // Token::Match() reads fills the first cache line and the location, the
+    // AST and the symbol database information fill the second one.
+
+    std::string mStr;
+
+    Token *mNext;
+    Token *mPrevious;
+    Token *mLink;
+
     Token::Type mTokType;
 
+    /** Was this token created in the arena of its list by create() */
+    bool mInArena;
+
     unsigned int mFlags;
 
+    unsigned int mVarId;
+    unsigned int mFileIndex;
+    unsigned int mLineNumber;
+    unsigned int mColumn;
+
+    // AST..
+    Token *mAstOperand1;
+    Token *mAstOperand2;
+    Token *mAstParent;
+
+    // symbol database information
+    union {
+        const Function *mFunction;
+        const Variable *mVariable;
+        const ::Type* mType;
+        const Enumerator *mEnumerator;
+    };
+
     TokenImpl *mImpl;
 
+    TokensFrontBack* mTokensFrontBack;
+
     /**
      * Get specified flag state.
      * @param flag_ flag to get state of
@@ -1089,18 +1283,18 @@ public:
     void astOperand2(Token *tok);
 
     const Token * astOperand1() const {
-        return mImpl->mAstOperand1;
+        return mAstOperand1;
     }
     const Token * astOperand2() const {
-        return mImpl->mAstOperand2;
+        return mAstOperand2;
     }
     const Token * astParent() const {
-        return mImpl->mAstParent;
+        return mAstParent;
     }
     const Token *astTop() const {
         const Token *ret = this;
-        while (ret->mImpl->mAstParent)
-            ret = ret->mImpl->mAstParent;
+        while (ret->mAstParent)
+            ret = ret->mAstParent;
         return ret;
     }
 
@@ -1116,7 +1310,7 @@ public:
     bool isCalculation() const;
 
     void clearAst() {
-        mImpl->mAstOperand1 = mImpl->mAstOperand2 = mImpl->mAstParent = nullptr;
+        mAstOperand1 = mAstOperand2 = mAstParent = nullptr;
     }
 
     void clearValueFlow() {
@@ -1126,10 +1320,10 @@ public:
 
     std::string astString(const char *sep = "") const {
         std::string ret;
-        if (mImpl->mAstOperand1)
-            ret = mImpl->mAstOperand1->astString(sep);
-        if (mImpl->mAstOperand2)
-            ret += mImpl->mAstOperand2->astString(sep);
+        if (mAstOperand1)
+            ret = mAstOperand1->astString(sep);
+        if (mAstOperand2)
+            ret += mAstOperand2->astString(sep);
         return ret + sep + mStr;
     }
 
@@ -182,6 +182,16 @@ Tokenizer::~Tokenizer()
 {
     delete mSymbolDatabase;
     delete mTemplateSimplifier;
+
+    if (mTimerResults) {
+        const TokenArena &arena = list.arena();
+        mTimerResults->AddCount("Token memory (KiB)", arena.size() / 1024);
+        mTimerResults->AddCount("Token allocations", arena.allocations());
+        mTimerResults->AddCount("Token allocations reused", arena.reused());
+
+        Timer t("Tokenizer::deallocateTokens", mSettings->showtime, mTimerResults);
+        list.deallocateTokens();
+    }
 }
 
 
@@ -2262,8 +2272,14 @@ bool Tokenizer::simplifyTokens1(const std::string &configuration)
 
     mConfiguration = configuration;
 
-    if (!simplifyTokenList1(list.getFiles().front().c_str()))
-        return false;
+    if (mTimerResults) {
+        Timer t("Tokenizer::simplifyTokens1::simplifyTokenList1", mSettings->showtime, mTimerResults);
+        if (!simplifyTokenList1(list.getFiles().front().c_str()))
+            return false;
+    } else {
+        if (!simplifyTokenList1(list.getFiles().front().c_str()))
+            return false;
+    }
 
     if (mTimerResults) {
         Timer t("Tokenizer::simplifyTokens1::createAst", mSettings->showtime, mTimerResults);
@@ -2302,7 +2318,7 @@ bool Tokenizer::simplifyTokens1(const std::string &configuration)
 
     if (mTimerResults) {
         Timer t("Tokenizer::simplifyTokens1::ValueFlow", mSettings->showtime, mTimerResults);
-        ValueFlow::setValues(&list, mSymbolDatabase, mErrorLogger, mSettings);
+        ValueFlow::setValues(&list, mSymbolDatabase, mErrorLogger, mSettings, mTimerResults);
     } else {
         ValueFlow::setValues(&list, mSymbolDatabase, mErrorLogger, mSettings);
     }
@@ -4331,8 +4347,14 @@ bool Tokenizer::simplifyTokenList1(const char FileName[])
     }
 
     // using A = B;
-    while (simplifyUsing())
-        ;
+    if (mTimerResults) {
+        Timer t("Tokenizer::tokenize::simplifyUsing", mSettings->showtime, mTimerResults);
+        while (simplifyUsing())
+            ;
+    } else {
+        while (simplifyUsing())
+            ;
+    }
 
     // Add parentheses to ternary operator where necessary
     // TODO: this is only necessary if one typedef simplification had a comma and was used within ?:
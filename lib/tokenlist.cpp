@@ -38,11 +38,14 @@ static const unsigned int AST_MAX_DEPTH = 50U;
 
 
 TokenList::TokenList(const Settings* settings) :
+    mArena(),
     mTokensFrontBack(),
     mSettings(settings),
     mIsC(false),
     mIsCpp(false)
 {
+    mTokensFrontBack.arena = &mArena;
+    mTokensFrontBack.settings = settings;
 }
 
 TokenList::~TokenList()
@@ -68,6 +71,7 @@ void TokenList::deallocateTokens()
     deleteTokens(mTokensFrontBack.front);
     mTokensFrontBack.front = nullptr;
     mTokensFrontBack.back = nullptr;
+    mArena.clear();
     mFiles.clear();
 }
 
@@ -98,7 +102,7 @@ void TokenList::deleteTokens(Token *tok)
 {
     while (tok) {
         Token *next = tok->next();
-        delete tok;
+        Token::destroy(tok);
         tok = next;
     }
 }
@@ -144,7 +148,7 @@ void TokenList::addtoken(std::string str, const unsigned int lineno, const unsig
     if (mTokensFrontBack.back) {
         mTokensFrontBack.back->insertToken(str);
     } else {
-        mTokensFrontBack.front = new Token(&mTokensFrontBack);
+        mTokensFrontBack.front = Token::create(&mTokensFrontBack);
         mTokensFrontBack.back = mTokensFrontBack.front;
         mTokensFrontBack.back->str(str);
     }
@@ -163,7 +167,7 @@ void TokenList::addtoken(const Token * tok, const unsigned int lineno, const uns
     if (mTokensFrontBack.back) {
         mTokensFrontBack.back->insertToken(tok->str(), tok->originalName());
     } else {
-        mTokensFrontBack.front = new Token(&mTokensFrontBack);
+        mTokensFrontBack.front = Token::create(&mTokensFrontBack);
         mTokensFrontBack.back = mTokensFrontBack.front;
         mTokensFrontBack.back->str(tok->str());
         if (!tok->originalName().empty())
@@ -307,7 +311,7 @@ void TokenList::createTokens(const simplecpp::TokenList *tokenList)
         if (mTokensFrontBack.back) {
             mTokensFrontBack.back->insertToken(str);
         } else {
-            mTokensFrontBack.front = new Token(&mTokensFrontBack);
+            mTokensFrontBack.front = Token::create(&mTokensFrontBack);
             mTokensFrontBack.back = mTokensFrontBack.front;
             mTokensFrontBack.back->str(str);
         }
@@ -44,6 +44,7 @@ public:
 
     void setSettings(const Settings *settings) {
         mSettings = settings;
+        mTokensFrontBack.settings = settings;
     }
 
     const Settings *getSettings() const {
@@ -100,9 +101,22 @@ public:
     /** Deallocate list */
     void deallocateTokens();
 
+    /** The memory of the tokens, for statistics */
+    const TokenArena &arena() const {
+        return mArena;
+    }
+
     /** append file name if seen the first time; return its index in any case */
     unsigned int appendFileIfNew(const std::string &fileName);
 
+    /**
+     * Record the changes of the token values in @p changes. Recording stops
+     * when it is null. Used by ValueFlow::setValues().
+     */
+    void setValueFlowChanges(ValueFlow::Changes *changes) {
+        mTokensFrontBack.valueFlowChanges = changes;
+    }
+
     /** get first token of list */
     const Token *front() const {
         return mTokensFrontBack.front;
@@ -190,6 +204,9 @@ private:
     /** Disable assignment operator, no implementation */
     TokenList &operator=(const TokenList &);
 
+    /** Memory for the tokens, released by deallocateTokens() */
+    TokenArena mArena;
+
     /** Token list */
     TokensFrontBack mTokensFrontBack;
 
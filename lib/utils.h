@@ -24,7 +24,11 @@
 #include <algorithm>
 #include <cctype>
 #include <cstddef>
+#include <cstring>
+#include <new>
 #include <string>
+#include <type_traits>
+#include <utility>
 
 inline bool endsWith(const std::string &str, char c)
 {
@@ -62,4 +66,368 @@ inline static int caseInsensitiveStringCompare(const std::string &lhs, const std
 
 #define UNUSED(x) (void)(x)
 
+// Numbers are written with 7 bits per byte, the high bit tells if there are more bytes
+inline void serializeNumber(std::string &out, unsigned long long value)
+{
+    while (value >= 0x80) {
+        out += static_cast<char>((value & 0x7f) | 0x80);
+        value >>= 7;
+    }
+    out += static_cast<char>(value);
+}
+
+inline void serializeString(std::string &out, const std::string &str)
+{
+    serializeNumber(out, str.size());
+    out += str;
+}
+
+/** Reads data written by serializeNumber() and serializeString() */
+class BinaryReader {
+public:
+    BinaryReader(const char *data, std::size_t size) : mPos(data), mEnd(data + size), mError(false) {
+    }
+
+    unsigned long long number() {
+        unsigned long long value = 0;
+        for (unsigned int shift = 0; shift < 64; shift += 7) {
+            if (mPos >= mEnd)
+                break;
+            const unsigned char c = static_cast<unsigned char>(*mPos++);
+            value |= static_cast<unsigned long long>(c & 0x7f) << shift;
+            if ((c & 0x80) == 0)
+                return value;
+        }
+        mError = true;
+        return 0;
+    }
+
+    std::string string() {
+        const unsigned long long size = number();
+        if (mError || size > static_cast<unsigned long long>(mEnd - mPos)) {
+            mError = true;
+            return std::string();
+        }
+        const char *start = mPos;
+        mPos += size;
+        return std::string(start, static_cast<std::size_t>(size));
+    }
+
+    bool error() const {
+        return mError;
+    }
+
+    bool atEnd() const {
+        return mPos == mEnd;
+    }
+
+private:
+    const char *mPos;
+    const char *mEnd;
+    bool mError;
+};
+
+/**
+ * Streaming 64-bit checksum. It uses the xxHash64 algorithm, data is
+ * processed in 32 byte stripes with four independent accumulators.
+ */
+class Checksum {
+public:
+    Checksum() : mTotalSize(0), mBufferSize(0) {
+        mAcc[0] = P1 + P2;
+        mAcc[1] = P2;
+        mAcc[2] = 0;
+        mAcc[3] = 0 - P1;
+    }
+
+    void update(const char *data, std::size_t size) {
+        mTotalSize += size;
+        if (mBufferSize + size < sizeof(mBuffer)) {
+            std::memcpy(mBuffer + mBufferSize, data, size);
+            mBufferSize += size;
+            return;
+        }
+        const char * const end = data + size;
+        if (mBufferSize > 0) {
+            const std::size_t fill = sizeof(mBuffer) - mBufferSize;
+            std::memcpy(mBuffer + mBufferSize, data, fill);
+            stripe(mBuffer);
+            data += fill;
+            mBufferSize = 0;
+        }
+        for (; end - data >= (std::ptrdiff_t)sizeof(mBuffer); data += sizeof(mBuffer))
+            stripe(data);
+        mBufferSize = end - data;
+        std::memcpy(mBuffer, data, mBufferSize);
+    }
+
+    void update(const std::string &str) {
+        update(str.data(), str.size());
+    }
+
+    void update(char c) {
+        update(&c, 1U);
+    }
+
+    unsigned long long digest() const {
+        unsigned long long h;
+        if (mTotalSize >= sizeof(mBuffer)) {
+            h = rotl(mAcc[0], 1) + rotl(mAcc[1], 7) + rotl(mAcc[2], 12) + rotl(mAcc[3], 18);
+            for (unsigned long long acc : mAcc)
+                h = (h ^ round(0, acc)) * P1 + P4;
+        } else {
+            h = P5;
+        }
+        h += mTotalSize;
+
+        const char *p = mBuffer;
+        const char * const end = mBuffer + mBufferSize;
+        for (; end - p >= 8; p += 8)
+            h = rotl(h ^ round(0, read64(p)), 27) * P1 + P4;
+        if (end - p >= 4) {
+            h = rotl(h ^ (read32(p) * P1), 23) * P2 + P3;
+            p += 4;
+        }
+        for (; p < end; ++p)
+            h = rotl(h ^ (static_cast<unsigned char>(*p) * P5), 11) * P1;
+
+        h ^= h >> 33;
+        h *= P2;
+        h ^= h >> 29;
+        h *= P3;
+        h ^= h >> 32;
+        return h;
+    }
+
+    static unsigned long long calculate(const std::string &data) {
+        Checksum checksum;
+        checksum.update(data);
+        return checksum.digest();
+    }
+
+private:
+    static const unsigned long long P1 = 11400714785074694791ULL;
+    static const unsigned long long P2 = 14029467366897019727ULL;
+    static const unsigned long long P3 = 1609587929392839161ULL;
+    static const unsigned long long P4 = 9650029242287828579ULL;
+    static const unsigned long long P5 = 2870177450012600261ULL;
+
+    static unsigned long long rotl(unsigned long long x, int r) {
+        return (x << r) | (x >> (64 - r));
+    }
+
+    static unsigned long long round(unsigned long long acc, unsigned long long input) {
+        return rotl(acc + input * P2, 31) * P1;
+    }
+
+    /** Little endian read, the compilers make it a single load */
+    static unsigned long long read64(const char *p) {
+        return read32(p) | (read32(p + 4) << 32);
+    }
+
+    static unsigned long long read32(const char *p) {
+        const unsigned char *u = reinterpret_cast<const unsigned char *>(p);
+        return (unsigned long long)u[0] | ((unsigned long long)u[1] << 8) | ((unsigned long long)u[2] << 16) | ((unsigned long long)u[3] << 24);
+    }
+
+    void stripe(const char *p) {
+        mAcc[0] = round(mAcc[0], read64(p));
+        mAcc[1] = round(mAcc[1], read64(p + 8));
+        mAcc[2] = round(mAcc[2], read64(p + 16));
+        mAcc[3] = round(mAcc[3], read64(p + 24));
+    }
+
+    unsigned long long mAcc[4];
+    unsigned long long mTotalSize;
+    char mBuffer[32];
+    std::size_t mBufferSize;
+};
+
+/**
+ * Vector that stores up to N elements inside the object and more on the
+ * heap. The elements are contiguous in both cases.
+ */
+template<class T, std::size_t N>
+class SmallVector {
+    static_assert(N > 0, "SmallVector needs inline capacity");
+
+public:
+    typedef T value_type;
+    typedef T *iterator;
+    typedef const T *const_iterator;
+    typedef std::size_t size_type;
+
+    SmallVector() : mData(inlineData()), mSize(0), mCapacity(N) {}
+
+    SmallVector(const SmallVector &other) : mData(inlineData()), mSize(0), mCapacity(N) {
+        reserve(other.mSize);
+        for (const T &x : other)
+            push_back(x);
+    }
+
+    SmallVector(SmallVector &&other) noexcept(std::is_nothrow_move_constructible<T>::value) : mData(inlineData()), mSize(0), mCapacity(N) {
+        moveFrom(other);
+    }
+
+    ~SmallVector() {
+        clear();
+        if (mData != inlineData())
+            ::operator delete(mData);
+    }
+
+    SmallVector &operator=(const SmallVector &other) {
+        if (this != &other) {
+            clear();
+            reserve(other.mSize);
+            for (const T &x : other)
+                push_back(x);
+        }
+        return *this;
+    }
+
+    SmallVector &operator=(SmallVector &&other) noexcept(std::is_nothrow_move_constructible<T>::value) {
+        if (this != &other) {
+            clear();
+            moveFrom(other);
+        }
+        return *this;
+    }
+
+    iterator begin() {
+        return mData;
+    }
+    iterator end() {
+        return mData + mSize;
+    }
+    const_iterator begin() const {
+        return mData;
+    }
+    const_iterator end() const {
+        return mData + mSize;
+    }
+    const_iterator cbegin() const {
+        return mData;
+    }
+    const_iterator cend() const {
+        return mData + mSize;
+    }
+
+    size_type size() const {
+        return mSize;
+    }
+    bool empty() const {
+        return mSize == 0;
+    }
+
+    T &operator[](size_type i) {
+        return mData[i];
+    }
+    const T &operator[](size_type i) const {
+        return mData[i];
+    }
+    T &front() {
+        return mData[0];
+    }
+    const T &front() const {
+        return mData[0];
+    }
+    T &back() {
+        return mData[mSize - 1];
+    }
+    const T &back() const {
+        return mData[mSize - 1];
+    }
+
+    void reserve(size_type n) {
+        if (n <= mCapacity)
+            return;
+        T *data = static_cast<T *>(::operator new(n * sizeof(T)));
+        for (size_type i = 0; i < mSize; ++i) {
+            new (data + i) T(std::move(mData[i]));
+            mData[i].~T();
+        }
+        if (mData != inlineData())
+            ::operator delete(mData);
+        mData = data;
+        mCapacity = n;
+    }
+
+    void push_back(const T &x) {
+        if (mSize == mCapacity) {
+            T copy(x); // x may be an element
+            reserve(2 * mCapacity);
+            new (mData + mSize) T(std::move(copy));
+        } else {
+            new (mData + mSize) T(x);
+        }
+        ++mSize;
+    }
+
+    iterator insert(iterator pos, const T &x) {
+        const size_type i = pos - mData;
+        push_back(x);
+        std::rotate(mData + i, mData + mSize - 1, mData + mSize);
+        return mData + i;
+    }
+
+    iterator erase(iterator first, iterator last) {
+        iterator newEnd = std::move(last, end(), first);
+        for (iterator it = newEnd; it != end(); ++it)
+            it->~T();
+        mSize -= end() - newEnd;
+        return first;
+    }
+
+    template<class Pred>
+    void remove_if(Pred pred) {
+        erase(std::remove_if(begin(), end(), pred), end());
+    }
+
+    void clear() {
+        for (T &x : *this)
+            x.~T();
+        mSize = 0;
+    }
+
+private:
+    T *inlineData() {
+        return reinterpret_cast<T *>(&mInline);
+    }
+
+    void moveFrom(SmallVector &other) {
+        if (other.mData != other.inlineData()) {
+            if (mData != inlineData())
+                ::operator delete(mData);
+            mData = other.mData;
+            mCapacity = other.mCapacity;
+            mSize = other.mSize;
+            other.mData = other.inlineData();
+            other.mCapacity = N;
+            other.mSize = 0;
+            return;
+        }
+        reserve(other.mSize);
+        for (T &x : other)
+            new (mData + mSize++) T(std::move(x));
+        other.clear();
+    }
+
+    T *mData;
+    size_type mSize;
+    size_type mCapacity;
+    typename std::aligned_storage<sizeof(T) * N, alignof(T)>::type mInline;
+};
+
+template<class T, std::size_t N>
+bool operator==(const SmallVector<T, N> &lhs, const SmallVector<T, N> &rhs)
+{
+    return lhs.size() == rhs.size() && std::equal(lhs.begin(), lhs.end(), rhs.begin());
+}
+
+template<class T, std::size_t N>
+bool operator!=(const SmallVector<T, N> &lhs, const SmallVector<T, N> &rhs)
+{
+    return !(lhs == rhs);
+}
+
 #endif
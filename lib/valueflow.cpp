@@ -85,22 +85,95 @@
 #include "settings.h"
 #include "standards.h"
 #include "symboldatabase.h"
+#include "timer.h"
 #include "token.h"
 #include "tokenlist.h"
 #include "utils.h"
 #include "path.h"
 
 #include <algorithm>
+#include <atomic>
 #include <cstddef>
+#include <exception>
 #include <functional>
 #include <iterator>
 #include <limits>
 #include <map>
 #include <set>
 #include <stack>
+#include <thread>
 #include <vector>
 
-static const int TIMEOUT = 10; // Do not repeat ValueFlow analysis more than 10 seconds
+/**
+ * The code that is analysed in an iteration of ValueFlow::setValues().
+ * The first iteration analyses all code, the next ones only the functions
+ * where values were added in the previous iteration.
+ */
+class ValueFlowScopes {
+public:
+    ValueFlowScopes() : mAll(true) {}
+
+    /** Is the code in the scope analysed? */
+    bool contains(const Scope *scope) const {
+        if (mAll)
+            return true;
+        const Scope * const functionScope = getFunctionScope(scope);
+        return !functionScope || mFunctionScopes.find(functionScope) != mFunctionScopes.end();
+    }
+
+    /** Analyse the functions with the changed scopes */
+    void select(const std::set<const Scope *> &changedScopes) {
+        mAll = false;
+        mFunctionScopes.clear();
+        for (const Scope *scope : changedScopes) {
+            const Scope * const functionScope = getFunctionScope(scope);
+            if (!functionScope) {
+                // Code outside functions was changed
+                mAll = true;
+                return;
+            }
+            mFunctionScopes.insert(functionScope);
+        }
+    }
+
+private:
+    static const Scope *getFunctionScope(const Scope *scope) {
+        while (scope && scope->type != Scope::eFunction)
+            scope = scope->nestedIn;
+        return scope;
+    }
+
+    bool mAll;
+    std::set<const Scope *> mFunctionScopes;
+};
+
+namespace {
+    /** Functions analysed by one thread, see forEachFunctionScope() */
+    struct ValueFlowTask {
+        explicit ValueFlowTask(const Scope *scope) : functionScope(scope) {}
+
+        /**
+         * Outermost function. A forward analysis that reaches its end is
+         * stopped and continued after all threads are done, see continuations.
+         */
+        const Scope *functionScope;
+
+        /** The function scopes to analyse: functionScope and the functions nested in it */
+        std::vector<const Scope *> scopes;
+
+        /** Bailout messages, reported when all threads are done */
+        std::list<ErrorLogger::ErrorMessage> messages;
+
+        /** Forward analyses that reached the end of functionScope, continued when all threads are done */
+        std::vector<std::function<void()>> continuations;
+
+        /** Exception thrown by the analysis */
+        std::exception_ptr exception;
+    };
+}
+
+/** Task of the current thread. Null unless the functions are analysed in parallel. */
+static thread_local ValueFlowTask *currentTask = nullptr;
 
 namespace {
     struct ProgramMemory {
@@ -158,7 +231,10 @@ static void bailoutInternal(TokenList *tokenlist, ErrorLogger *errorLogger, cons
     std::list<ErrorLogger::ErrorMessage::FileLocation> callstack(1, ErrorLogger::ErrorMessage::FileLocation(tok, tokenlist));
     ErrorLogger::ErrorMessage errmsg(callstack, tokenlist->getSourceFilePath(), Severity::debug,
                                      Path::stripDirectoryPart(file) + ":" + MathLib::toString(line) + ":" + function + " bailout: " + what, "valueFlowBailout", false);
-    errorLogger->reportErr(errmsg);
+    if (currentTask)
+        currentTask->messages.push_back(errmsg);
+    else
+        errorLogger->reportErr(errmsg);
 }
 
 #if (defined __cplusplus) && __cplusplus >= 201103L
@@ -169,6 +245,72 @@ static void bailoutInternal(TokenList *tokenlist, ErrorLogger *errorLogger, cons
 #define bailout(tokenlist, errorLogger, tok, what) bailoutInternal(tokenlist, errorLogger, tok, what, __FILE__, __LINE__, "(valueFlow)")
 #endif
 
+/**
+ * Call @p analyse for the function scopes of @p scopes. With --valueflow-jobs
+ * several functions are analysed at the same time. A thread analyses a
+ * function together with the functions nested in it, so each token is only
+ * changed by one thread. The result does not depend on the number of threads.
+ */
+static void forEachFunctionScope(const SymbolDatabase *symboldatabase, ErrorLogger *errorLogger, const Settings *settings, const ValueFlowScopes &scopes, const std::function<void(const Scope *)> &analyse)
+{
+    if (settings->valueFlowJobs <= 1) {
+        for (const Scope *scope : symboldatabase->functionScopes) {
+            if (scopes.contains(scope))
+                analyse(scope);
+        }
+        return;
+    }
+
+    std::vector<ValueFlowTask> tasks;
+    std::map<const Scope *, std::size_t> taskIndex;
+    for (const Scope *scope : symboldatabase->functionScopes) {
+        if (!scopes.contains(scope))
+            continue;
+        const Scope *functionScope = scope;
+        for (const Scope *outer = scope->nestedIn; outer; outer = outer->nestedIn) {
+            if (outer->type == Scope::eFunction)
+                functionScope = outer;
+        }
+        const std::pair<std::map<const Scope *, std::size_t>::iterator, bool> index = taskIndex.insert(std::make_pair(functionScope, tasks.size()));
+        if (index.second)
+            tasks.emplace_back(functionScope);
+        tasks[index.first->second].scopes.push_back(scope);
+    }
+
+    std::atomic<std::size_t> nextTask(0);
+    const auto work = [&]() {
+        for (std::size_t i = nextTask++; i < tasks.size(); i = nextTask++) {
+            ValueFlowTask &task = tasks[i];
+            currentTask = &task;
+            try {
+                for (const Scope *scope : task.scopes)
+                    analyse(scope);
+            } catch (...) {
+                task.exception = std::current_exception();
+            }
+            currentTask = nullptr;
+        }
+    };
+
+    std::vector<std::thread> threads;
+    const std::size_t numberOfThreads = std::min<std::size_t>(settings->valueFlowJobs, tasks.size());
+    for (std::size_t i = 1; i < numberOfThreads; ++i)
+        threads.emplace_back(work);
+    work();
+    for (std::thread &thread : threads)
+        thread.join();
+
+    // Merge the results in the order of the functions, as if they were analysed by one thread
+    for (const ValueFlowTask &task : tasks) {
+        for (const ErrorLogger::ErrorMessage &errmsg : task.messages)
+            errorLogger->reportErr(errmsg);
+        if (task.exception)
+            std::rethrow_exception(task.exception);
+        for (const std::function<void()> &continuation : task.continuations)
+            continuation();
+    }
+}
+
 static void changeKnownToPossible(std::list<ValueFlow::Value> &values)
 {
     std::list<ValueFlow::Value>::iterator it;
@@ -479,7 +621,7 @@ static void setTokenValue(Token* tok, const ValueFlow::Value &value, const Setti
                 const Token *op = cond ? tok->astOperand1() : tok->astOperand2();
                 if (!op) // #7769 segmentation fault at setTokenValue()
                     return;
-                const std::list<ValueFlow::Value> &values = op->values();
+                const ValueFlow::Values &values = op->values();
                 if (std::find(values.begin(), values.end(), value) != values.end())
                     setTokenValue(parent, value, settings);
             }
@@ -1097,7 +1239,7 @@ static void valueFlowArrayBool(TokenList *tokenlist)
             continue;
         const Variable *var = nullptr;
         bool known = false;
-        std::list<ValueFlow::Value>::const_iterator val =
+        ValueFlow::Values::const_iterator val =
             std::find_if(tok->values().begin(), tok->values().end(), std::mem_fn(&ValueFlow::Value::isTokValue));
         if (val == tok->values().end()) {
             var = tok->variable();
@@ -1215,7 +1357,9 @@ static void valueFlowSameExpressions(TokenList *tokenlist)
         if (!val.isKnown())
             continue;
 
-        if (isSameExpression(tokenlist->isCPP(), false, tok->astOperand1(), tok->astOperand2(), tokenlist->getSettings()->library, true, true, &val.errorPath)) {
+        ErrorPath errorPath = val.errorPath;
+        if (isSameExpression(tokenlist->isCPP(), false, tok->astOperand1(), tok->astOperand2(), tokenlist->getSettings()->library, true, true, &errorPath)) {
+            val.errorPath = errorPath;
             setTokenValue(tok, val, tokenlist->getSettings());
         }
     }
@@ -1430,10 +1574,10 @@ static void valueFlowRightShift(TokenList *tokenList, const Settings* settings)
     }
 }
 
-static void valueFlowOppositeCondition(SymbolDatabase *symboldatabase, const Settings *settings)
+static void valueFlowOppositeCondition(SymbolDatabase *symboldatabase, const Settings *settings, const ValueFlowScopes &scopes)
 {
     for (const Scope &scope : symboldatabase->scopeList) {
-        if (scope.type != Scope::eIf)
+        if (scope.type != Scope::eIf || !scopes.contains(&scope))
             continue;
         Token *tok = const_cast<Token *>(scope.classDef);
         if (!Token::simpleMatch(tok, "if ("))
@@ -1762,103 +1906,108 @@ static void valueFlowReverse(TokenList *tokenlist,
     }
 }
 
-static void valueFlowBeforeCondition(TokenList *tokenlist, SymbolDatabase *symboldatabase, ErrorLogger *errorLogger, const Settings *settings)
+static void valueFlowBeforeCondition(TokenList *tokenlist, const Scope *scope, ErrorLogger *errorLogger, const Settings *settings)
 {
-    for (const Scope * scope : symboldatabase->functionScopes) {
-        for (Token* tok = const_cast<Token*>(scope->bodyStart); tok != scope->bodyEnd; tok = tok->next()) {
-            MathLib::bigint num = 0;
-            const Token *vartok = nullptr;
-            if (tok->isComparisonOp() && tok->astOperand1() && tok->astOperand2()) {
-                if (tok->astOperand1()->isName() && tok->astOperand2()->hasKnownIntValue()) {
-                    vartok = tok->astOperand1();
-                    num = tok->astOperand2()->values().front().intvalue;
-                } else if (tok->astOperand1()->hasKnownIntValue() && tok->astOperand2()->isName()) {
-                    vartok = tok->astOperand2();
-                    num = tok->astOperand1()->values().front().intvalue;
-                } else {
-                    continue;
-                }
-            } else if (Token::Match(tok->previous(), "if|while ( %name% %oror%|&&|)") ||
-                       Token::Match(tok, "%oror%|&& %name% %oror%|&&|)")) {
-                vartok = tok->next();
-                num = 0;
-            } else if (Token::Match(tok, "[!?]") && Token::Match(tok->astOperand1(), "%name%")) {
+    for (Token* tok = const_cast<Token*>(scope->bodyStart); tok != scope->bodyEnd; tok = tok->next()) {
+        MathLib::bigint num = 0;
+        const Token *vartok = nullptr;
+        if (tok->isComparisonOp() && tok->astOperand1() && tok->astOperand2()) {
+            if (tok->astOperand1()->isName() && tok->astOperand2()->hasKnownIntValue()) {
                 vartok = tok->astOperand1();
-                num = 0;
+                num = tok->astOperand2()->values().front().intvalue;
+            } else if (tok->astOperand1()->hasKnownIntValue() && tok->astOperand2()->isName()) {
+                vartok = tok->astOperand2();
+                num = tok->astOperand1()->values().front().intvalue;
             } else {
                 continue;
             }
+        } else if (Token::Match(tok->previous(), "if|while ( %name% %oror%|&&|)") ||
+                   Token::Match(tok, "%oror%|&& %name% %oror%|&&|)")) {
+            vartok = tok->next();
+            num = 0;
+        } else if (Token::Match(tok, "[!?]") && Token::Match(tok->astOperand1(), "%name%")) {
+            vartok = tok->astOperand1();
+            num = 0;
+        } else {
+            continue;
+        }
 
-            unsigned int varid = vartok->varId();
-            const Variable * const var = vartok->variable();
+        unsigned int varid = vartok->varId();
+        const Variable * const var = vartok->variable();
 
-            if (varid == 0U || !var)
-                continue;
+        if (varid == 0U || !var)
+            continue;
 
-            // bailout: for/while-condition, variable is changed in while loop
-            for (const Token *tok2 = tok; tok2; tok2 = tok2->astParent()) {
-                if (tok2->astParent() || tok2->str() != "(" || !Token::simpleMatch(tok2->link(), ") {"))
-                    continue;
+        // bailout: for/while-condition, variable is changed in while loop
+        for (const Token *tok2 = tok; tok2; tok2 = tok2->astParent()) {
+            if (tok2->astParent() || tok2->str() != "(" || !Token::simpleMatch(tok2->link(), ") {"))
+                continue;
 
-                // Variable changed in 3rd for-expression
-                if (Token::simpleMatch(tok2->previous(), "for (")) {
-                    if (tok2->astOperand2() && tok2->astOperand2()->astOperand2() && isVariableChanged(tok2->astOperand2()->astOperand2(), tok2->link(), varid, var->isGlobal(), settings, tokenlist->isCPP())) {
-                        varid = 0U;
-                        if (settings->debugwarnings)
-                            bailout(tokenlist, errorLogger, tok, "variable " + var->name() + " used in loop");
-                    }
+            // Variable changed in 3rd for-expression
+            if (Token::simpleMatch(tok2->previous(), "for (")) {
+                if (tok2->astOperand2() && tok2->astOperand2()->astOperand2() && isVariableChanged(tok2->astOperand2()->astOperand2(), tok2->link(), varid, var->isGlobal(), settings, tokenlist->isCPP())) {
+                    varid = 0U;
+                    if (settings->debugwarnings)
+                        bailout(tokenlist, errorLogger, tok, "variable " + var->name() + " used in loop");
                 }
+            }
 
-                // Variable changed in loop code
-                if (Token::Match(tok2->previous(), "for|while (")) {
-                    const Token * const start = tok2->link()->next();
-                    const Token * const end   = start->link();
+            // Variable changed in loop code
+            if (Token::Match(tok2->previous(), "for|while (")) {
+                const Token * const start = tok2->link()->next();
+                const Token * const end   = start->link();
 
-                    if (isVariableChanged(start,end,varid,var->isGlobal(),settings, tokenlist->isCPP())) {
-                        varid = 0U;
-                        if (settings->debugwarnings)
-                            bailout(tokenlist, errorLogger, tok, "variable " + var->name() + " used in loop");
-                    }
-                }
-
-                // if,macro => bailout
-                else if (Token::simpleMatch(tok2->previous(), "if (") && tok2->previous()->isExpandedMacro()) {
+                if (isVariableChanged(start,end,varid,var->isGlobal(),settings, tokenlist->isCPP())) {
                     varid = 0U;
                     if (settings->debugwarnings)
-                        bailout(tokenlist, errorLogger, tok, "variable " + var->name() + ", condition is defined in macro");
+                        bailout(tokenlist, errorLogger, tok, "variable " + var->name() + " used in loop");
                 }
             }
-            if (varid == 0U)
-                continue;
 
-            // extra logic for unsigned variables 'i>=1' => possible value can also be 0
-            if (Token::Match(tok, "<|>")) {
-                if (num != 0)
-                    continue;
-                if (!var->typeStartToken()->isUnsigned())
-                    continue;
-            }
-            ValueFlow::Value val(tok, num);
-            val.varId = varid;
-            ValueFlow::Value val2;
-            if (num==1U && Token::Match(tok,"<=|>=")) {
-                if (var->typeStartToken()->isUnsigned()) {
-                    val2 = ValueFlow::Value(tok,0);
-                    val2.varId = varid;
-                }
+            // if,macro => bailout
+            else if (Token::simpleMatch(tok2->previous(), "if (") && tok2->previous()->isExpandedMacro()) {
+                varid = 0U;
+                if (settings->debugwarnings)
+                    bailout(tokenlist, errorLogger, tok, "variable " + var->name() + ", condition is defined in macro");
             }
-            valueFlowReverse(tokenlist,
-                             tok,
-                             vartok,
-                             val,
-                             val2,
-                             errorLogger,
-                             settings);
+        }
+        if (varid == 0U)
+            continue;
 
+        // extra logic for unsigned variables 'i>=1' => possible value can also be 0
+        if (Token::Match(tok, "<|>")) {
+            if (num != 0)
+                continue;
+            if (!var->typeStartToken()->isUnsigned())
+                continue;
         }
+        ValueFlow::Value val(tok, num);
+        val.varId = varid;
+        ValueFlow::Value val2;
+        if (num==1U && Token::Match(tok,"<=|>=")) {
+            if (var->typeStartToken()->isUnsigned()) {
+                val2 = ValueFlow::Value(tok,0);
+                val2.varId = varid;
+            }
+        }
+        valueFlowReverse(tokenlist,
+                         tok,
+                         vartok,
+                         val,
+                         val2,
+                         errorLogger,
+                         settings);
+
     }
 }
 
+static void valueFlowBeforeCondition(TokenList *tokenlist, SymbolDatabase *symboldatabase, ErrorLogger *errorLogger, const Settings *settings, const ValueFlowScopes &scopes)
+{
+    forEachFunctionScope(symboldatabase, errorLogger, settings, scopes, [&](const Scope *scope) {
+        valueFlowBeforeCondition(tokenlist, scope, errorLogger, settings);
+    });
+}
+
 static void removeValues(std::list<ValueFlow::Value> &values, const std::list<ValueFlow::Value> &valuesToRemove)
 {
     for (std::list<ValueFlow::Value>::iterator it = values.begin(); it != values.end();) {
@@ -1886,7 +2035,7 @@ static void valueFlowAST(Token *tok, unsigned int varid, const ValueFlow::Value
         if (conditionIsFalse(tok->astOperand1(), pm))
             return;
     } else if (tok->str() == "||" && tok->astOperand1()) {
-        const std::list<ValueFlow::Value> &values = tok->astOperand1()->values();
+        const ValueFlow::Values &values = tok->astOperand1()->values();
         const bool nonzero = std::any_of(values.cbegin(), values.cend(),
         [=](const ValueFlow::Value &v) {
             return v.intvalue != 0;
@@ -1967,6 +2116,20 @@ static bool evalAssignment(ValueFlow::Value &lhsValue, const std::string &assign
     return true;
 }
 
+namespace {
+    /** State of valueFlowForward(), kept when the analysis is continued later */
+    struct ValueFlowForwardState {
+        ValueFlowForwardState() : indentlevel(0), number_of_if(0), varusagelevel(-1), returnStatement(false), read(false), forwardedTokens(0) {}
+
+        int indentlevel;
+        unsigned int number_of_if;
+        int varusagelevel;
+        bool returnStatement;  // current statement is a return, stop analysis at the ";"
+        bool read;  // is variable value read?
+        unsigned int forwardedTokens;
+    };
+}
+
 static bool valueFlowForward(Token * const               startToken,
                              const Token * const         endToken,
                              const Variable * const      var,
@@ -1976,18 +2139,37 @@ static bool valueFlowForward(Token * const               startToken,
                              const bool                  subFunction,
                              TokenList * const           tokenlist,
                              ErrorLogger * const         errorLogger,
-                             const Settings * const      settings)
+                             const Settings * const      settings,
+                             ValueFlowForwardState       state = ValueFlowForwardState())
 {
-    int indentlevel = 0;
-    unsigned int number_of_if = 0;
-    int varusagelevel = -1;
-    bool returnStatement = false;  // current statement is a return, stop analysis at the ";"
-    bool read = false;  // is variable value read?
+    int &indentlevel = state.indentlevel;
+    unsigned int &number_of_if = state.number_of_if;
+    int &varusagelevel = state.varusagelevel;
+    bool &returnStatement = state.returnStatement;
+    bool &read = state.read;
 
     if (values.empty())
         return true;
 
+    // Other threads may analyse the code after the function
+    const Token * const functionEnd = currentTask ? currentTask->functionScope->bodyEnd : nullptr;
+
+    unsigned int &forwardedTokens = state.forwardedTokens;
     for (Token *tok2 = startToken; tok2 && tok2 != endToken; tok2 = tok2->next()) {
+        if (functionEnd && tok2 == functionEnd->next()) {
+            // Continue when the other threads are done, see forEachFunctionScope()
+            currentTask->continuations.push_back([=]() {
+                valueFlowForward(tok2, endToken, var, varid, values, constValue, subFunction, tokenlist, errorLogger, settings, state);
+            });
+            return true;
+        }
+
+        if (++forwardedTokens > settings->valueFlowMaxForwardTokens) {
+            if (settings->debugwarnings)
+                bailout(tokenlist, errorLogger, tok2, "max number of forwarded tokens (" + MathLib::toString(settings->valueFlowMaxForwardTokens) + ") reached");
+            return false;
+        }
+
         if (indentlevel >= 0 && tok2->str() == "{")
             ++indentlevel;
         else if (indentlevel >= 0 && tok2->str() == "}") {
@@ -2776,7 +2958,7 @@ static const Token *getLifetimeToken(const Token *tok, ValueFlow::Value::ErrorPa
             for (const ValueFlow::Value &v : vartok->values()) {
                 if (!v.isLocalLifetimeValue())
                     continue;
-                errorPath.insert(errorPath.end(), v.errorPath.begin(), v.errorPath.end());
+                errorPath.splice(errorPath.end(), ErrorPath(v.errorPath));
                 return getLifetimeToken(v.tokvalue, errorPath);
             }
         } else {
@@ -2934,7 +3116,7 @@ static void valueFlowForwardLifetime(Token * tok, TokenList *tokenlist, ErrorLog
         if (!isLifetimeBorrowed(parent->astOperand2(), settings))
             return;
 
-        std::list<ValueFlow::Value> values = parent->astOperand2()->values();
+        std::list<ValueFlow::Value> values(parent->astOperand2()->values().begin(), parent->astOperand2()->values().end());
 
         // Static variable initialisation?
         if (var->isStatic() && var->nameToken() == parent->astOperand1())
@@ -2983,7 +3165,7 @@ static void valueFlowForwardLifetime(Token * tok, TokenList *tokenlist, ErrorLog
             return;
         const Token *endOfVarScope = var->typeStartToken()->scope()->bodyEnd;
 
-        std::list<ValueFlow::Value> values = tok->values();
+        std::list<ValueFlow::Value> values(tok->values().begin(), tok->values().end());
         const Token *nextExpression = nextAfterAstRightmostLeaf(parent);
         // Only forward lifetime values
         values.remove_if(&isNotLifetimeValue);
@@ -3453,12 +3635,12 @@ static const Token * findEndOfFunctionCallForParameter(const Token * parameterTo
     return nextAfterAstRightmostLeaf(parent);
 }
 
-static void valueFlowAfterMove(TokenList *tokenlist, SymbolDatabase* symboldatabase, ErrorLogger *errorLogger, const Settings *settings)
+static void valueFlowAfterMove(TokenList *tokenlist, SymbolDatabase* symboldatabase, ErrorLogger *errorLogger, const Settings *settings, const ValueFlowScopes &scopes)
 {
     if (!tokenlist->isCPP() || settings->standards.cpp < Standards::CPP11)
         return;
     for (const Scope * scope : symboldatabase->functionScopes) {
-        if (!scope)
+        if (!scope || !scopes.contains(scope))
             continue;
         const Token * start = scope->bodyStart;
         if (scope->function) {
@@ -3611,43 +3793,49 @@ static std::list<ValueFlow::Value> truncateValues(std::list<ValueFlow::Value> va
     return values;
 }
 
-static void valueFlowAfterAssign(TokenList *tokenlist, SymbolDatabase* symboldatabase, ErrorLogger *errorLogger, const Settings *settings)
+static void valueFlowAfterAssign(TokenList *tokenlist, const Scope *scope, ErrorLogger *errorLogger, const Settings *settings)
 {
-    for (const Scope * scope : symboldatabase->functionScopes) {
-        std::set<unsigned int> aliased;
-        for (Token* tok = const_cast<Token*>(scope->bodyStart); tok != scope->bodyEnd; tok = tok->next()) {
-            // Alias
-            if (tok->isUnaryOp("&")) {
-                aliased.insert(tok->astOperand1()->varId());
-                continue;
-            }
+    std::set<unsigned int> aliased;
+    for (Token* tok = const_cast<Token*>(scope->bodyStart); tok != scope->bodyEnd; tok = tok->next()) {
+        // Alias
+        if (tok->isUnaryOp("&")) {
+            aliased.insert(tok->astOperand1()->varId());
+            continue;
+        }
 
-            // Assignment
-            if ((tok->str() != "=") || (tok->astParent()))
-                continue;
+        // Assignment
+        if ((tok->str() != "=") || (tok->astParent()))
+            continue;
 
-            // Lhs should be a variable
-            if (!tok->astOperand1() || !tok->astOperand1()->varId() || tok->astOperand1()->hasKnownValue())
-                continue;
-            const unsigned int varid = tok->astOperand1()->varId();
-            if (aliased.find(varid) != aliased.end())
-                continue;
-            const Variable *var = tok->astOperand1()->variable();
-            if (!var || (!var->isLocal() && !var->isGlobal() && !var->isArgument()))
-                continue;
+        // Lhs should be a variable
+        if (!tok->astOperand1() || !tok->astOperand1()->varId() || tok->astOperand1()->hasKnownValue())
+            continue;
+        const unsigned int varid = tok->astOperand1()->varId();
+        if (aliased.find(varid) != aliased.end())
+            continue;
+        const Variable *var = tok->astOperand1()->variable();
+        if (!var || (!var->isLocal() && !var->isGlobal() && !var->isArgument()))
+            continue;
 
-            // Rhs values..
-            if (!tok->astOperand2() || tok->astOperand2()->values().empty())
-                continue;
+        // Rhs values..
+        if (!tok->astOperand2() || tok->astOperand2()->values().empty())
+            continue;
 
-            std::list<ValueFlow::Value> values = truncateValues(tok->astOperand2()->values(), tok->astOperand1()->valueType(), settings);
-            const bool constValue = tok->astOperand2()->isNumber();
-            const bool init = var->nameToken() == tok->astOperand1();
-            valueFlowForwardAssign(const_cast<Token *>(tok->astOperand2()), var, values, constValue, init, tokenlist, errorLogger, settings);
-        }
+        const ValueFlow::Values &rhsValues = tok->astOperand2()->values();
+        std::list<ValueFlow::Value> values = truncateValues(std::list<ValueFlow::Value>(rhsValues.begin(), rhsValues.end()), tok->astOperand1()->valueType(), settings);
+        const bool constValue = tok->astOperand2()->isNumber();
+        const bool init = var->nameToken() == tok->astOperand1();
+        valueFlowForwardAssign(const_cast<Token *>(tok->astOperand2()), var, values, constValue, init, tokenlist, errorLogger, settings);
     }
 }
 
+static void valueFlowAfterAssign(TokenList *tokenlist, SymbolDatabase* symboldatabase, ErrorLogger *errorLogger, const Settings *settings, const ValueFlowScopes &scopes)
+{
+    forEachFunctionScope(symboldatabase, errorLogger, settings, scopes, [&](const Scope *scope) {
+        valueFlowAfterAssign(tokenlist, scope, errorLogger, settings);
+    });
+}
+
 struct ValueFlowConditionHandler {
     struct Condition {
         const Token *vartok;
@@ -3660,181 +3848,186 @@ struct ValueFlowConditionHandler {
     forward;
     std::function<Condition(Token *tok)> parse;
 
-    void afterCondition(TokenList *tokenlist,
-                        SymbolDatabase *symboldatabase,
-                        ErrorLogger *errorLogger,
-                        const Settings *settings) const {
-        for (const Scope *scope : symboldatabase->functionScopes) {
-            std::set<unsigned> aliased;
-            for (Token *tok = const_cast<Token *>(scope->bodyStart); tok != scope->bodyEnd; tok = tok->next()) {
-                if (Token::Match(tok, "= & %var% ;"))
-                    aliased.insert(tok->tokAt(2)->varId());
+    void afterCondition(TokenList *tokenlist, const Scope *scope, ErrorLogger *errorLogger, const Settings *settings) const {
+        std::set<unsigned> aliased;
+        for (Token *tok = const_cast<Token *>(scope->bodyStart); tok != scope->bodyEnd; tok = tok->next()) {
+            if (Token::Match(tok, "= & %var% ;"))
+                aliased.insert(tok->tokAt(2)->varId());
 
-                Condition cond = parse(tok);
-                if (!cond.vartok)
-                    continue;
-                if (cond.true_values.empty() || cond.false_values.empty())
-                    continue;
-                const unsigned int varid = cond.vartok->varId();
-                if (varid == 0U)
-                    continue;
-                const Variable *var = cond.vartok->variable();
-                if (!var || !(var->isLocal() || var->isGlobal() || var->isArgument()))
-                    continue;
-                if (aliased.find(varid) != aliased.end()) {
-                    if (settings->debugwarnings)
-                        bailout(tokenlist,
-                                errorLogger,
-                                cond.vartok,
-                                "variable is aliased so we just skip all valueflow after condition");
-                    continue;
-                }
+            Condition cond = parse(tok);
+            if (!cond.vartok)
+                continue;
+            if (cond.true_values.empty() || cond.false_values.empty())
+                continue;
+            const unsigned int varid = cond.vartok->varId();
+            if (varid == 0U)
+                continue;
+            const Variable *var = cond.vartok->variable();
+            if (!var || !(var->isLocal() || var->isGlobal() || var->isArgument()))
+                continue;
+            if (aliased.find(varid) != aliased.end()) {
+                if (settings->debugwarnings)
+                    bailout(tokenlist,
+                            errorLogger,
+                            cond.vartok,
+                            "variable is aliased so we just skip all valueflow after condition");
+                continue;
+            }
 
-                if (Token::Match(tok->astParent(), "%oror%|&&")) {
-                    Token *parent = const_cast<Token *>(tok->astParent());
-                    const std::string &op(parent->str());
-
-                    if (parent->astOperand1() == tok && ((op == "&&" && Token::Match(tok, "==|>=|<=|!")) ||
-                                                         (op == "||" && Token::Match(tok, "%name%|!=")))) {
-                        for (; parent && parent->str() == op; parent = const_cast<Token *>(parent->astParent())) {
-                            std::stack<Token *> tokens;
-                            tokens.push(const_cast<Token *>(parent->astOperand2()));
-                            bool assign = false;
-                            while (!tokens.empty()) {
-                                Token *rhstok = tokens.top();
-                                tokens.pop();
-                                if (!rhstok)
-                                    continue;
-                                tokens.push(const_cast<Token *>(rhstok->astOperand1()));
-                                tokens.push(const_cast<Token *>(rhstok->astOperand2()));
-                                if (rhstok->varId() == varid)
-                                    setTokenValue(rhstok, cond.true_values.front(), settings);
-                                else if (Token::Match(rhstok, "++|--|=") &&
-                                         Token::Match(rhstok->astOperand1(), "%varid%", varid)) {
-                                    assign = true;
-                                    break;
-                                }
-                            }
-                            if (assign)
+            if (Token::Match(tok->astParent(), "%oror%|&&")) {
+                Token *parent = const_cast<Token *>(tok->astParent());
+                const std::string &op(parent->str());
+
+                if (parent->astOperand1() == tok && ((op == "&&" && Token::Match(tok, "==|>=|<=|!")) ||
+                                                     (op == "||" && Token::Match(tok, "%name%|!=")))) {
+                    for (; parent && parent->str() == op; parent = const_cast<Token *>(parent->astParent())) {
+                        std::stack<Token *> tokens;
+                        tokens.push(const_cast<Token *>(parent->astOperand2()));
+                        bool assign = false;
+                        while (!tokens.empty()) {
+                            Token *rhstok = tokens.top();
+                            tokens.pop();
+                            if (!rhstok)
+                                continue;
+                            tokens.push(const_cast<Token *>(rhstok->astOperand1()));
+                            tokens.push(const_cast<Token *>(rhstok->astOperand2()));
+                            if (rhstok->varId() == varid)
+                                setTokenValue(rhstok, cond.true_values.front(), settings);
+                            else if (Token::Match(rhstok, "++|--|=") &&
+                                     Token::Match(rhstok->astOperand1(), "%varid%", varid)) {
+                                assign = true;
                                 break;
-                            while (parent->astParent() && parent == parent->astParent()->astOperand2())
-                                parent = const_cast<Token *>(parent->astParent());
+                            }
                         }
+                        if (assign)
+                            break;
+                        while (parent->astParent() && parent == parent->astParent()->astOperand2())
+                            parent = const_cast<Token *>(parent->astParent());
                     }
                 }
+            }
 
-                const Token *top = tok->astTop();
-                if (top && Token::Match(top->previous(), "if|while (") && !top->previous()->isExpandedMacro()) {
-                    // does condition reassign variable?
-                    if (tok != top->astOperand2() && Token::Match(top->astOperand2(), "%oror%|&&") &&
-                        isVariableChanged(top, top->link(), varid, var->isGlobal(), settings, tokenlist->isCPP())) {
-                        if (settings->debugwarnings)
-                            bailout(tokenlist, errorLogger, tok, "assignment in condition");
-                        continue;
+            const Token *top = tok->astTop();
+            if (top && Token::Match(top->previous(), "if|while (") && !top->previous()->isExpandedMacro()) {
+                // does condition reassign variable?
+                if (tok != top->astOperand2() && Token::Match(top->astOperand2(), "%oror%|&&") &&
+                    isVariableChanged(top, top->link(), varid, var->isGlobal(), settings, tokenlist->isCPP())) {
+                    if (settings->debugwarnings)
+                        bailout(tokenlist, errorLogger, tok, "assignment in condition");
+                    continue;
+                }
+
+                // start token of conditional code
+                Token *startTokens[] = {nullptr, nullptr};
+
+                // based on the comparison, should we check the if or while?
+                bool check_if = false;
+                bool check_else = false;
+                if (Token::Match(tok, "==|>=|<=|!|>|<|("))
+                    check_if = true;
+                if (Token::Match(tok, "%name%|!=|>|<"))
+                    check_else = true;
+
+                if (!check_if && !check_else)
+                    continue;
+
+                // if astParent is "!" we need to invert codeblock
+                {
+                    const Token *parent = tok->astParent();
+                    while (parent && parent->str() == "&&")
+                        parent = parent->astParent();
+                    if (parent && (parent->str() == "!" || Token::simpleMatch(parent, "== false"))) {
+                        check_if = !check_if;
+                        check_else = !check_else;
                     }
+                }
 
-                    // start token of conditional code
-                    Token *startTokens[] = {nullptr, nullptr};
+                // determine startToken(s)
+                if (check_if && Token::simpleMatch(top->link(), ") {"))
+                    startTokens[0] = top->link()->next();
+                if (check_else && Token::simpleMatch(top->link()->linkAt(1), "} else {"))
+                    startTokens[1] = top->link()->linkAt(1)->tokAt(2);
 
-                    // based on the comparison, should we check the if or while?
-                    bool check_if = false;
-                    bool check_else = false;
-                    if (Token::Match(tok, "==|>=|<=|!|>|<|("))
-                        check_if = true;
-                    if (Token::Match(tok, "%name%|!=|>|<"))
-                        check_else = true;
+                bool bail = false;
 
-                    if (!check_if && !check_else)
+                for (int i = 0; i < 2; i++) {
+                    const Token *const startToken = startTokens[i];
+                    if (!startToken)
                         continue;
-
-                    // if astParent is "!" we need to invert codeblock
-                    {
+                    std::list<ValueFlow::Value> &values = (i == 0 ? cond.true_values : cond.false_values);
+                    if (values.size() == 1U && Token::Match(tok, "==|!|(")) {
                         const Token *parent = tok->astParent();
                         while (parent && parent->str() == "&&")
                             parent = parent->astParent();
-                        if (parent && (parent->str() == "!" || Token::simpleMatch(parent, "== false"))) {
-                            check_if = !check_if;
-                            check_else = !check_else;
-                        }
+                        if (parent && parent->str() == "(")
+                            values.front().setKnown();
                     }
 
-                    // determine startToken(s)
-                    if (check_if && Token::simpleMatch(top->link(), ") {"))
-                        startTokens[0] = top->link()->next();
-                    if (check_else && Token::simpleMatch(top->link()->linkAt(1), "} else {"))
-                        startTokens[1] = top->link()->linkAt(1)->tokAt(2);
+                    bool changed = forward(startTokens[i], startTokens[i]->link(), var, values, true);
+                    values.front().setPossible();
+                    if (changed) {
+                        // TODO: The endToken should not be startTokens[i]->link() in the valueFlowForward call
+                        if (settings->debugwarnings)
+                            bailout(tokenlist,
+                                    errorLogger,
+                                    startTokens[i]->link(),
+                                    "valueFlowAfterCondition: " + var->name() + " is changed in conditional block");
+                        bail = true;
+                        break;
+                    }
+                }
+                if (bail)
+                    continue;
 
-                    bool bail = false;
+                // After conditional code..
+                if (Token::simpleMatch(top->link(), ") {")) {
+                    Token *after = top->link()->linkAt(1);
+                    std::string unknownFunction;
+                    if (settings->library.isScopeNoReturn(after, &unknownFunction)) {
+                        if (settings->debugwarnings && !unknownFunction.empty())
+                            bailout(tokenlist, errorLogger, after, "possible noreturn scope");
+                        continue;
+                    }
 
-                    for (int i = 0; i < 2; i++) {
-                        const Token *const startToken = startTokens[i];
-                        if (!startToken)
-                            continue;
-                        std::list<ValueFlow::Value> &values = (i == 0 ? cond.true_values : cond.false_values);
-                        if (values.size() == 1U && Token::Match(tok, "==|!|(")) {
-                            const Token *parent = tok->astParent();
-                            while (parent && parent->str() == "&&")
-                                parent = parent->astParent();
-                            if (parent && parent->str() == "(")
-                                values.front().setKnown();
-                        }
+                    const bool dead_if = isReturnScope(after);
+                    bool dead_else = false;
 
-                        bool changed = forward(startTokens[i], startTokens[i]->link(), var, values, true);
-                        values.front().setPossible();
-                        if (changed) {
-                            // TODO: The endToken should not be startTokens[i]->link() in the valueFlowForward call
+                    if (Token::simpleMatch(after, "} else {")) {
+                        after = after->linkAt(2);
+                        if (Token::simpleMatch(after->tokAt(-2), ") ; }")) {
                             if (settings->debugwarnings)
-                                bailout(tokenlist,
-                                        errorLogger,
-                                        startTokens[i]->link(),
-                                        "valueFlowAfterCondition: " + var->name() + " is changed in conditional block");
-                            bail = true;
-                            break;
-                        }
-                    }
-                    if (bail)
-                        continue;
-
-                    // After conditional code..
-                    if (Token::simpleMatch(top->link(), ") {")) {
-                        Token *after = top->link()->linkAt(1);
-                        std::string unknownFunction;
-                        if (settings->library.isScopeNoReturn(after, &unknownFunction)) {
-                            if (settings->debugwarnings && !unknownFunction.empty())
                                 bailout(tokenlist, errorLogger, after, "possible noreturn scope");
                             continue;
                         }
+                        dead_else = isReturnScope(after);
+                    }
 
-                        const bool dead_if = isReturnScope(after);
-                        bool dead_else = false;
-
-                        if (Token::simpleMatch(after, "} else {")) {
-                            after = after->linkAt(2);
-                            if (Token::simpleMatch(after->tokAt(-2), ") ; }")) {
-                                if (settings->debugwarnings)
-                                    bailout(tokenlist, errorLogger, after, "possible noreturn scope");
-                                continue;
-                            }
-                            dead_else = isReturnScope(after);
-                        }
-
-                        std::list<ValueFlow::Value> *values = nullptr;
-                        if (!dead_if && check_if)
-                            values = &cond.true_values;
-                        else if (!dead_else && check_else)
-                            values = &cond.false_values;
-
-                        if (values) {
-                            // TODO: constValue could be true if there are no assignments in the conditional blocks and
-                            //       perhaps if there are no && and no || in the condition
-                            bool constValue = false;
-                            forward(after, top->scope()->bodyEnd, var, *values, constValue);
-                        }
+                    std::list<ValueFlow::Value> *values = nullptr;
+                    if (!dead_if && check_if)
+                        values = &cond.true_values;
+                    else if (!dead_else && check_else)
+                        values = &cond.false_values;
+
+                    if (values) {
+                        // TODO: constValue could be true if there are no assignments in the conditional blocks and
+                        //       perhaps if there are no && and no || in the condition
+                        bool constValue = false;
+                        forward(after, top->scope()->bodyEnd, var, *values, constValue);
                     }
                 }
             }
         }
     }
+
+    void afterCondition(TokenList *tokenlist,
+                        SymbolDatabase *symboldatabase,
+                        ErrorLogger *errorLogger,
+                        const Settings *settings,
+                        const ValueFlowScopes &scopes) const {
+        forEachFunctionScope(symboldatabase, errorLogger, settings, scopes, [&](const Scope *scope) {
+            afterCondition(tokenlist, scope, errorLogger, settings);
+        });
+    }
 };
 
 static void setConditionalValues(const Token *tok,
@@ -3880,7 +4073,8 @@ static const Token *parseCompareInt(const Token *tok, ValueFlow::Value &true_val
 static void valueFlowAfterCondition(TokenList *tokenlist,
                                     SymbolDatabase *symboldatabase,
                                     ErrorLogger *errorLogger,
-                                    const Settings *settings)
+                                    const Settings *settings,
+                                    const ValueFlowScopes &scopes)
 {
     ValueFlowConditionHandler handler;
     handler.forward = [&](Token *start,
@@ -3924,7 +4118,7 @@ static void valueFlowAfterCondition(TokenList *tokenlist,
 
         return cond;
     };
-    handler.afterCondition(tokenlist, symboldatabase, errorLogger, settings);
+    handler.afterCondition(tokenlist, symboldatabase, errorLogger, settings, scopes);
 }
 
 static void execute(const Token *expr,
@@ -4331,10 +4525,10 @@ static void valueFlowForLoopSimplifyAfter(Token *fortok, unsigned int varid, con
                      settings);
 }
 
-static void valueFlowForLoop(TokenList *tokenlist, SymbolDatabase* symboldatabase, ErrorLogger *errorLogger, const Settings *settings)
+static void valueFlowForLoop(TokenList *tokenlist, SymbolDatabase* symboldatabase, ErrorLogger *errorLogger, const Settings *settings, const ValueFlowScopes &scopes)
 {
     for (const Scope &scope : symboldatabase->scopeList) {
-        if (scope.type != Scope::eFor)
+        if (scope.type != Scope::eFor || !scopes.contains(&scope))
             continue;
 
         Token* tok = const_cast<Token*>(scope.classDef);
@@ -4392,10 +4586,10 @@ static void valueFlowInjectParameter(TokenList* tokenlist, ErrorLogger* errorLog
     valueFlowForward(const_cast<Token*>(functionScope->bodyStart->next()), functionScope->bodyEnd, arg, varid2, argvalues, false, true, tokenlist, errorLogger, settings);
 }
 
-static void valueFlowSwitchVariable(TokenList *tokenlist, SymbolDatabase* symboldatabase, ErrorLogger *errorLogger, const Settings *settings)
+static void valueFlowSwitchVariable(TokenList *tokenlist, SymbolDatabase* symboldatabase, ErrorLogger *errorLogger, const Settings *settings, const ValueFlowScopes &scopes)
 {
     for (const Scope &scope : symboldatabase->scopeList) {
-        if (scope.type != Scope::ScopeType::eSwitch)
+        if (scope.type != Scope::ScopeType::eSwitch || !scopes.contains(&scope))
             continue;
         if (!Token::Match(scope.classDef, "switch ( %var% ) {"))
             continue;
@@ -4598,7 +4792,7 @@ static bool evaluate(const Token *expr, const std::vector<std::list<ValueFlow::V
 
 static std::list<ValueFlow::Value> getFunctionArgumentValues(const Token *argtok)
 {
-    std::list<ValueFlow::Value> argvalues(argtok->values());
+    std::list<ValueFlow::Value> argvalues(argtok->values().begin(), argtok->values().end());
     if (argvalues.empty() && Token::Match(argtok, "%comp%|%oror%|&&|!")) {
         argvalues.emplace_back(0);
         argvalues.emplace_back(1);
@@ -4650,10 +4844,10 @@ static void valueFlowLibraryFunction(Token *tok, const std::string &returnValue,
         setTokenValues(tok, results, settings);
 }
 
-static void valueFlowSubFunction(TokenList *tokenlist, const Settings *settings)
+static void valueFlowSubFunction(TokenList *tokenlist, const Settings *settings, const ValueFlowScopes &scopes)
 {
     for (Token *tok = tokenlist->front(); tok; tok = tok->next()) {
-        if (!Token::Match(tok, "%name% ("))
+        if (!Token::Match(tok, "%name% (") || !scopes.contains(tok->scope()))
             continue;
 
         const Function * const calledFunction = tok->function();
@@ -4723,7 +4917,7 @@ static void valueFlowFunctionDefaultParameter(TokenList *tokenlist, SymbolDataba
         for (std::size_t arg = function->minArgCount(); arg < function->argCount(); arg++) {
             const Variable* var = function->getArgumentVar(arg);
             if (var && var->hasDefault() && Token::Match(var->nameToken(), "%var% = %num%|%str% [,)]")) {
-                const std::list<ValueFlow::Value> &values = var->nameToken()->tokAt(2)->values();
+                const ValueFlow::Values &values = var->nameToken()->tokAt(2)->values();
                 std::list<ValueFlow::Value> argvalues;
                 for (const ValueFlow::Value &value : values) {
                     ValueFlow::Value v(value);
@@ -4812,12 +5006,12 @@ static void valueFlowFunctionReturn(TokenList *tokenlist, ErrorLogger *errorLogg
     }
 }
 
-static void valueFlowUninit(TokenList *tokenlist, SymbolDatabase * /*symbolDatabase*/, ErrorLogger *errorLogger, const Settings *settings)
+static void valueFlowUninit(TokenList *tokenlist, SymbolDatabase * /*symbolDatabase*/, ErrorLogger *errorLogger, const Settings *settings, const ValueFlowScopes &scopes)
 {
     for (Token *tok = tokenlist->front(); tok; tok = tok->next()) {
         if (!Token::Match(tok,"[;{}] %type%"))
             continue;
-        if (!tok->scope()->isExecutable())
+        if (!tok->scope()->isExecutable() || !scopes.contains(tok->scope()))
             continue;
         const Token *vardecl = tok->next();
         bool stdtype = false;
@@ -5022,12 +5216,12 @@ static bool isContainerSizeChanged(unsigned int varId, const Token *start, const
     return false;
 }
 
-static void valueFlowSmartPointer(TokenList *tokenlist, ErrorLogger * errorLogger, const Settings *settings)
+static void valueFlowSmartPointer(TokenList *tokenlist, ErrorLogger * errorLogger, const Settings *settings, const ValueFlowScopes &scopes)
 {
     for (Token *tok = tokenlist->front(); tok; tok = tok->next()) {
         if (!tok->scope())
             continue;
-        if (!tok->scope()->isExecutable())
+        if (!tok->scope()->isExecutable() || !scopes.contains(tok->scope()))
             continue;
         if (!tok->variable())
             continue;
@@ -5037,7 +5231,7 @@ static void valueFlowSmartPointer(TokenList *tokenlist, ErrorLogger * errorLogge
         if (var->nameToken() == tok) {
             if (Token::Match(tok, "%var% (|{") && tok->next()->astOperand2() && tok->next()->astOperand2()->str() != ",") {
                 const Token * inTok = tok->next()->astOperand2();
-                std::list<ValueFlow::Value> values = inTok->values();
+                std::list<ValueFlow::Value> values(inTok->values().begin(), inTok->values().end());
                 const bool constValue = inTok->isNumber();
                 valueFlowForwardAssign(const_cast<Token *>(inTok), var, values, constValue, true, tokenlist, errorLogger, settings);
 
@@ -5060,7 +5254,7 @@ static void valueFlowSmartPointer(TokenList *tokenlist, ErrorLogger * errorLogge
                 const Token * inTok = tok->tokAt(3)->astOperand2();
                 if (!inTok)
                     continue;
-                std::list<ValueFlow::Value> values = inTok->values();
+                std::list<ValueFlow::Value> values(inTok->values().begin(), inTok->values().end());
                 const bool constValue = inTok->isNumber();
                 valueFlowForwardAssign(const_cast<Token *>(inTok), var, values, constValue, false, tokenlist, errorLogger, settings);
             }
@@ -5074,11 +5268,11 @@ static void valueFlowSmartPointer(TokenList *tokenlist, ErrorLogger * errorLogge
     }
 }
 
-static void valueFlowContainerSize(TokenList *tokenlist, SymbolDatabase* symboldatabase, ErrorLogger * /*errorLogger*/, const Settings *settings)
+static void valueFlowContainerSize(TokenList *tokenlist, SymbolDatabase* symboldatabase, ErrorLogger * /*errorLogger*/, const Settings *settings, const ValueFlowScopes &scopes)
 {
     // declaration
     for (const Variable *var : symboldatabase->variableList()) {
-        if (!var || !var->isLocal() || var->isPointer() || var->isReference())
+        if (!var || !var->isLocal() || var->isPointer() || var->isReference() || !scopes.contains(var->scope()))
             continue;
         if (!var->valueType() || !var->valueType()->container)
             continue;
@@ -5100,6 +5294,8 @@ static void valueFlowContainerSize(TokenList *tokenlist, SymbolDatabase* symbold
 
     // after assignment
     for (const Scope *functionScope : symboldatabase->functionScopes) {
+        if (!scopes.contains(functionScope))
+            continue;
         for (const Token *tok = functionScope->bodyStart; tok != functionScope->bodyEnd; tok = tok->next()) {
             if (Token::Match(tok, "[;{}] %var% = %str% ;")) {
                 const Token *containerTok = tok->next();
@@ -5115,7 +5311,7 @@ static void valueFlowContainerSize(TokenList *tokenlist, SymbolDatabase* symbold
 
     // conditional conditionSize
     for (const Scope &scope : symboldatabase->scopeList) {
-        if (scope.type != Scope::ScopeType::eIf) // TODO: while
+        if (scope.type != Scope::ScopeType::eIf || !scopes.contains(&scope)) // TODO: while
             continue;
         for (const Token *tok = scope.classDef; tok && tok->str() != "{"; tok = tok->next()) {
             if (!tok->isName() || !tok->valueType() || tok->valueType()->type != ValueType::CONTAINER || !tok->valueType()->container)
@@ -5161,7 +5357,8 @@ static void valueFlowContainerSize(TokenList *tokenlist, SymbolDatabase* symbold
 static void valueFlowContainerAfterCondition(TokenList *tokenlist,
         SymbolDatabase *symboldatabase,
         ErrorLogger *errorLogger,
-        const Settings *settings)
+        const Settings *settings,
+        const ValueFlowScopes &scopes)
 {
     ValueFlowConditionHandler handler;
     handler.forward =
@@ -5231,7 +5428,7 @@ static void valueFlowContainerAfterCondition(TokenList *tokenlist,
         }
         return cond;
     };
-    handler.afterCondition(tokenlist, symboldatabase, errorLogger, settings);
+    handler.afterCondition(tokenlist, symboldatabase, errorLogger, settings, scopes);
 }
 
 static void valueFlowFwdAnalysis(const TokenList *tokenlist, const Settings *settings)
@@ -5378,57 +5575,100 @@ const ValueFlow::Value *ValueFlow::valueFlowConstantFoldAST(const Token *expr, c
     return expr && expr->hasKnownValue() ? &expr->values().front() : nullptr;
 }
 
-static std::size_t getTotalValues(TokenList *tokenlist)
+namespace {
+    /** Records the value changes of the token list while it exists */
+    class RecordValueFlowChanges {
+    public:
+        RecordValueFlowChanges(TokenList *tokenlist, ValueFlow::Changes *changes) : mTokenList(tokenlist) {
+            mTokenList->setValueFlowChanges(changes);
+        }
+        ~RecordValueFlowChanges() {
+            mTokenList->setValueFlowChanges(nullptr);
+        }
+    private:
+        TokenList *mTokenList;
+    };
+}
+
+/** Report that the analysis of the file was limited by a --valueflow-max-* option */
+static void budgetExceeded(const TokenList *tokenlist, ErrorLogger *errorLogger, const std::string &id, const std::string &what)
 {
-    std::size_t n = 1;
-    for (Token *tok = tokenlist->front(); tok; tok = tok->next())
-        n += tok->values().size();
-    return n;
+    std::list<ErrorLogger::ErrorMessage::FileLocation> callstack(1, ErrorLogger::ErrorMessage::FileLocation(tokenlist->front(), tokenlist));
+    ErrorLogger::ErrorMessage errmsg(callstack, tokenlist->getSourceFilePath(), Severity::debug,
+                                     "ValueFlow: " + what, id, false);
+    errorLogger->reportErr(errmsg);
 }
 
-void ValueFlow::setValues(TokenList *tokenlist, SymbolDatabase* symboldatabase, ErrorLogger *errorLogger, const Settings *settings)
+void ValueFlow::setValues(TokenList *tokenlist, SymbolDatabase* symboldatabase, ErrorLogger *errorLogger, const Settings *settings, TimerResultsIntf *timerResults, bool incremental)
 {
+    const auto runPass = [&](const char name[], const std::function<void()> &pass) {
+        if (timerResults) {
+            Timer t(std::string("ValueFlow::") + name, settings->showtime, timerResults);
+            pass();
+        } else {
+            pass();
+        }
+    };
+
     for (Token *tok = tokenlist->front(); tok; tok = tok->next())
         tok->clearValueFlow();
 
-    valueFlowNumber(tokenlist);
-    valueFlowString(tokenlist);
-    valueFlowArray(tokenlist);
-    valueFlowGlobalConstVar(tokenlist, settings);
-    valueFlowGlobalStaticVar(tokenlist, settings);
-    valueFlowPointerAlias(tokenlist);
-    valueFlowLifetime(tokenlist, symboldatabase, errorLogger, settings);
-    valueFlowFunctionReturn(tokenlist, errorLogger);
-    valueFlowBitAnd(tokenlist);
-    valueFlowSameExpressions(tokenlist);
-    valueFlowFwdAnalysis(tokenlist, settings);
-
-    // Temporary hack.. run valueflow until there is nothing to update or timeout expires
-    const std::time_t timeout = std::time(0) + TIMEOUT;
-    std::size_t values = 0;
-    while (std::time(0) < timeout && values < getTotalValues(tokenlist)) {
-        values = getTotalValues(tokenlist);
-        valueFlowArrayBool(tokenlist);
-        valueFlowRightShift(tokenlist, settings);
-        valueFlowOppositeCondition(symboldatabase, settings);
-        valueFlowTerminatingCondition(tokenlist, symboldatabase, settings);
-        valueFlowBeforeCondition(tokenlist, symboldatabase, errorLogger, settings);
-        valueFlowAfterMove(tokenlist, symboldatabase, errorLogger, settings);
-        valueFlowAfterAssign(tokenlist, symboldatabase, errorLogger, settings);
-        valueFlowAfterCondition(tokenlist, symboldatabase, errorLogger, settings);
-        valueFlowSwitchVariable(tokenlist, symboldatabase, errorLogger, settings);
-        valueFlowForLoop(tokenlist, symboldatabase, errorLogger, settings);
-        valueFlowSubFunction(tokenlist, settings);
-        valueFlowFunctionDefaultParameter(tokenlist, symboldatabase, errorLogger, settings);
-        valueFlowUninit(tokenlist, symboldatabase, errorLogger, settings);
+    ValueFlow::Changes changes;
+    changes.concurrent = settings->valueFlowJobs > 1;
+    const RecordValueFlowChanges recordChanges(tokenlist, &changes);
+
+    runPass("valueFlowNumber", [&] { valueFlowNumber(tokenlist); });
+    runPass("valueFlowString", [&] { valueFlowString(tokenlist); });
+    runPass("valueFlowArray", [&] { valueFlowArray(tokenlist); });
+    runPass("valueFlowGlobalConstVar", [&] { valueFlowGlobalConstVar(tokenlist, settings); });
+    runPass("valueFlowGlobalStaticVar", [&] { valueFlowGlobalStaticVar(tokenlist, settings); });
+    runPass("valueFlowPointerAlias", [&] { valueFlowPointerAlias(tokenlist); });
+    runPass("valueFlowLifetime", [&] { valueFlowLifetime(tokenlist, symboldatabase, errorLogger, settings); });
+    runPass("valueFlowFunctionReturn", [&] { valueFlowFunctionReturn(tokenlist, errorLogger); });
+    runPass("valueFlowBitAnd", [&] { valueFlowBitAnd(tokenlist); });
+    runPass("valueFlowSameExpressions", [&] { valueFlowSameExpressions(tokenlist); });
+    runPass("valueFlowFwdAnalysis", [&] { valueFlowFwdAnalysis(tokenlist, settings); });
+
+    // Temporary hack.. run valueflow until there is nothing to update or the number of iterations is reached.
+    // The number of values of a token is limited, so the loop ends when there is no limit.
+    // After the first iteration only the functions where values were added are analysed.
+    ValueFlowScopes scopes;
+    unsigned int iterations = 0;
+    std::size_t values;
+    do {
+        ++iterations;
+        values = changes.values;
+        changes.scopes.clear();
+        runPass("valueFlowArrayBool", [&] { valueFlowArrayBool(tokenlist); });
+        runPass("valueFlowRightShift", [&] { valueFlowRightShift(tokenlist, settings); });
+        runPass("valueFlowOppositeCondition", [&] { valueFlowOppositeCondition(symboldatabase, settings, scopes); });
+        runPass("valueFlowTerminatingCondition", [&] { valueFlowTerminatingCondition(tokenlist, symboldatabase, settings); });
+        runPass("valueFlowBeforeCondition", [&] { valueFlowBeforeCondition(tokenlist, symboldatabase, errorLogger, settings, scopes); });
+        runPass("valueFlowAfterMove", [&] { valueFlowAfterMove(tokenlist, symboldatabase, errorLogger, settings, scopes); });
+        runPass("valueFlowAfterAssign", [&] { valueFlowAfterAssign(tokenlist, symboldatabase, errorLogger, settings, scopes); });
+        runPass("valueFlowAfterCondition", [&] { valueFlowAfterCondition(tokenlist, symboldatabase, errorLogger, settings, scopes); });
+        runPass("valueFlowSwitchVariable", [&] { valueFlowSwitchVariable(tokenlist, symboldatabase, errorLogger, settings, scopes); });
+        runPass("valueFlowForLoop", [&] { valueFlowForLoop(tokenlist, symboldatabase, errorLogger, settings, scopes); });
+        runPass("valueFlowSubFunction", [&] { valueFlowSubFunction(tokenlist, settings, scopes); });
+        runPass("valueFlowFunctionDefaultParameter", [&] { valueFlowFunctionDefaultParameter(tokenlist, symboldatabase, errorLogger, settings); });
+        runPass("valueFlowUninit", [&] { valueFlowUninit(tokenlist, symboldatabase, errorLogger, settings, scopes); });
         if (tokenlist->isCPP()) {
-            valueFlowSmartPointer(tokenlist, errorLogger, settings);
-            valueFlowContainerSize(tokenlist, symboldatabase, errorLogger, settings);
-            valueFlowContainerAfterCondition(tokenlist, symboldatabase, errorLogger, settings);
+            runPass("valueFlowSmartPointer", [&] { valueFlowSmartPointer(tokenlist, errorLogger, settings, scopes); });
+            runPass("valueFlowContainerSize", [&] { valueFlowContainerSize(tokenlist, symboldatabase, errorLogger, settings, scopes); });
+            runPass("valueFlowContainerAfterCondition", [&] { valueFlowContainerAfterCondition(tokenlist, symboldatabase, errorLogger, settings, scopes); });
         }
-    }
+        if (incremental)
+            scopes.select(changes.scopes);
+    } while ((settings->valueFlowMaxIterations == 0 || iterations < settings->valueFlowMaxIterations) && values < changes.values);
+
+    runPass("valueFlowDynamicBufferSize", [&] { valueFlowDynamicBufferSize(tokenlist, symboldatabase, errorLogger, settings); });
 
-    valueFlowDynamicBufferSize(tokenlist, symboldatabase, errorLogger, settings);
+    if (settings->debugwarnings) {
+        if (values < changes.values)
+            budgetExceeded(tokenlist, errorLogger, "valueFlowMaxIterations", "max number of iterations (" + MathLib::toString(settings->valueFlowMaxIterations) + ") reached, more values could be found");
+        if (changes.droppedValues > 0)
+            budgetExceeded(tokenlist, errorLogger, "valueFlowMaxValues", "max number of values per token (" + MathLib::toString(settings->valueFlowMaxValues) + ") reached, " + MathLib::toString(changes.droppedValues) + " values were dropped");
+    }
 }
 
 
@@ -22,15 +22,23 @@
 //---------------------------------------------------------------------------
 
 #include "config.h"
+#include "utils.h"
 
+#include <cstddef>
 #include <list>
+#include <memory>
+#include <mutex>
+#include <set>
 #include <string>
+#include <type_traits>
 #include <utility>
 
 class ErrorLogger;
+class Scope;
 class Settings;
 class SymbolDatabase;
 class Token;
+class TimerResultsIntf;
 class TokenList;
 class Variable;
 
@@ -40,6 +48,68 @@ namespace ValueFlow {
         typedef std::pair<const Token *, std::string> ErrorPathItem;
         typedef std::list<ErrorPathItem> ErrorPath;
 
+        /**
+         * Error path that the copies of a value share. The copies can be
+         * used by the threads of --valueflow-jobs, so the items do not
+         * change after they are added. Each item points to the items
+         * before it, so an item is added to a shared path without copying
+         * the path. The list is built when the path is read.
+         */
+        class CPPCHECKLIB SharedErrorPath {
+        public:
+            SharedErrorPath() {}
+            SharedErrorPath(const ErrorPath &errorPath) {
+                for (const ErrorPathItem &item : errorPath)
+                    emplace_back(item);
+            }
+
+            operator ErrorPath() const {
+                ErrorPath ret;
+                for (const Node *node = mLast.get(); node; node = node->previous.get())
+                    ret.push_front(node->item);
+                return ret;
+            }
+
+            bool empty() const {
+                return !mLast;
+            }
+            std::size_t size() const {
+                return mLast ? mLast->size : 0;
+            }
+
+            template<class ... Args>
+            void emplace_back(Args&& ... args) {
+                std::shared_ptr<const Node> previous = std::move(mLast);
+                mLast = std::make_shared<const Node>(std::move(previous), ErrorPathItem(std::forward<Args>(args)...));
+            }
+            template<class ... Args>
+            void emplace_front(Args&& ... args) {
+                ErrorPath path = *this;
+                path.emplace_front(std::forward<Args>(args)...);
+                *this = SharedErrorPath(path);
+            }
+
+        private:
+            struct Node {
+                Node(std::shared_ptr<const Node> &&previous, ErrorPathItem &&item)
+                    : previous(std::move(previous)), item(std::move(item)), size(this->previous ? this->previous->size + 1 : 1) {}
+
+                /** The items of a long path are released in a loop, not by recursion */
+                ~Node() {
+                    std::shared_ptr<const Node> node = std::move(previous);
+                    while (node && node.use_count() == 1)
+                        node = std::move(node->previous);
+                }
+
+                mutable std::shared_ptr<const Node> previous;
+                const ErrorPathItem item;
+                const std::size_t size;
+            };
+
+            /** The last item of the path, null if the path is empty */
+            std::shared_ptr<const Node> mLast;
+        };
+
         explicit Value(long long val = 0)
             : valueType(INT),
               intvalue(val),
@@ -155,7 +225,7 @@ namespace ValueFlow {
         /** Condition that this value depends on */
         const Token *condition;
 
-        ErrorPath errorPath;
+        SharedErrorPath errorPath;
 
         /** For calculated values - varId that calculated value depends on */
         unsigned int varId;
@@ -227,11 +297,72 @@ namespace ValueFlow {
         }
     };
 
+    /** The values of a token, almost all tokens with values have one */
+    typedef SmallVector<Value, 1> Values;
+    static_assert(std::is_nothrow_move_constructible<Values>::value, "the values are moved when containers of values grow");
+
+    /** Changes of the token values. Recorded by the tokens while setValues() runs. */
+    struct Changes {
+        Changes() : values(0), droppedValues(0), concurrent(false) {}
+
+        /** A value was added to a token in @p scope */
+        void addValue(const Scope *scope) {
+            std::unique_lock<std::mutex> lock(mMutex, std::defer_lock);
+            if (concurrent)
+                lock.lock();
+            ++values;
+            scopes.insert(scope);
+        }
+
+        /** A value of a token in @p scope was replaced */
+        void changeValue(const Scope *scope) {
+            std::unique_lock<std::mutex> lock(mMutex, std::defer_lock);
+            if (concurrent)
+                lock.lock();
+            scopes.insert(scope);
+        }
+
+        /** A value was not added because the token has Settings::valueFlowMaxValues values */
+        void dropValue() {
+            std::unique_lock<std::mutex> lock(mMutex, std::defer_lock);
+            if (concurrent)
+                lock.lock();
+            ++droppedValues;
+        }
+
+        /** @p count values were removed from a token */
+        void removeValues(std::size_t count) {
+            std::unique_lock<std::mutex> lock(mMutex, std::defer_lock);
+            if (concurrent)
+                lock.lock();
+            values -= count;
+        }
+
+        /** Number of values of all tokens */
+        std::size_t values;
+
+        /** Scopes of the tokens that got a new value */
+        std::set<const Scope *> scopes;
+
+        /** Number of values that were not added, see dropValue() */
+        std::size_t droppedValues;
+
+        /** Are values added by several threads? (--valueflow-jobs) */
+        bool concurrent;
+
+    private:
+        std::mutex mMutex;
+    };
+
     /// Constant folding of expression. This can be used before the full ValueFlow has been executed (ValueFlow::setValues).
     const ValueFlow::Value * valueFlowConstantFoldAST(const Token *expr, const Settings *settings);
 
-    /// Perform valueflow analysis.
-    void setValues(TokenList *tokenlist, SymbolDatabase* symboldatabase, ErrorLogger *errorLogger, const Settings *settings);
+    /**
+     * Perform valueflow analysis. Each pass is timed when @p timerResults is given.
+     * After the first iteration only the functions where values were added are
+     * analysed again, unless @p incremental is false.
+     */
+    void setValues(TokenList *tokenlist, SymbolDatabase* symboldatabase, ErrorLogger *errorLogger, const Settings *settings, TimerResultsIntf *timerResults = nullptr, bool incremental = true);
 
     std::string eitherTheConditionIsRedundant(const Token *condition);
 }
@@ -0,0 +1,233 @@
+/*
+ * Cppcheck - A tool for static C/C++ code analysis
+ * Copyright (C) 2007-2019 Cppcheck team.
+ *
+ * This program is free software: you can redistribute it and/or modify
+ * it under the terms of the GNU General Public License as published by
+ * the Free Software Foundation, either version 3 of the License, or
+ * (at your option) any later version.
+ *
+ * This program is distributed in the hope that it will be useful,
+ * but WITHOUT ANY WARRANTY; without even the implied warranty of
+ * MERCHANTABILITY or FITNESS FOR A PARTICULAR PURPOSE.  See the
+ * GNU General Public License for more details.
+ *
+ * You should have received a copy of the GNU General Public License
+ * along with this program.  If not, see <http://www.gnu.org/licenses/>.
+ */
+
+#include "analyzerinfo.h"
+#include "errorlogger.h"
+#include "testsuite.h"
+#include "utils.h"
+
+#include <cstdio>
+#include <fstream>
+#include <iterator>
+#include <list>
+#include <map>
+#include <set>
+#include <string>
+
+class TestAnalyzerInformation : public TestFixture {
+public:
+    TestAnalyzerInformation() : TestFixture("TestAnalyzerInformation") {
+    }
+
+private:
+    static const char sourcefile[];
+    static const char headerfile[];
+    static const char missingheaderfile[];
+
+    void run() OVERRIDE {
+        TEST_CASE(checksum);
+        TEST_CASE(binaryFormat);
+        TEST_CASE(xmlFormat);
+        TEST_CASE(incompleteFile);
+        TEST_CASE(inputsBinaryFormat);
+        TEST_CASE(inputsXmlFormat);
+        TEST_CASE(timings);
+    }
+
+    void checksum() {
+        // xxHash64 with seed 0
+        ASSERT_EQUALS(0xef46db3751d8e999ULL, Checksum::calculate(""));
+        ASSERT_EQUALS(0xd24ec4f1a98c6e5bULL, Checksum::calculate("a"));
+        ASSERT_EQUALS(0x44bc2cf5ad770999ULL, Checksum::calculate("abc"));
+        ASSERT_EQUALS(0xfbcea83c8a378bf1ULL, Checksum::calculate("Nobody inspects the spammish repetition"));
+
+        // The data can be given in parts
+        std::string data;
+        for (int i = 0; i < 100; ++i)
+            data += (char)('a' + i % 26);
+        Checksum checksum;
+        checksum.update(data.substr(0, 5));
+        checksum.update(data[5]);
+        checksum.update(data.substr(6, 40));
+        checksum.update(data.substr(46));
+        ASSERT_EQUALS(Checksum::calculate(data), checksum.digest());
+    }
+
+    /** Write an analyzer info file with an error and a file info, return its name */
+    static std::string writeFile(bool xml) {
+        std::list<ErrorLogger::ErrorMessage::FileLocation> locs(1, ErrorLogger::ErrorMessage::FileLocation(sourcefile, 3));
+        const ErrorLogger::ErrorMessage errmsg(locs, sourcefile, Severity::error, "Null pointer dereference", "nullPointer", false);
+
+        AnalyzerInformation analyzerInformation;
+        std::list<ErrorLogger::ErrorMessage> errors;
+        analyzerInformation.analyzeFile(".", sourcefile, "", 1234, &errors, xml);
+        analyzerInformation.reportErr(errmsg, false);
+        analyzerInformation.setFileInfo("ctu", "<function-call call-id=\"f\"/>\n");
+        analyzerInformation.close();
+        return AnalyzerInformation::getAnalyzerInfoFile(".", sourcefile, "");
+    }
+
+    void readFile(bool xml) {
+        const std::string filename = writeFile(xml);
+
+        AnalyzerInformation::Info info;
+        ASSERT_EQUALS(true, AnalyzerInformation::readFile(filename, &info));
+        ASSERT_EQUALS(1234ULL, info.checksum);
+        ASSERT_EQUALS(1U, info.errors.size());
+        ASSERT_EQUALS("nullPointer", info.errors.front()._id);
+        ASSERT_EQUALS(3, info.errors.front()._callStack.front().line);
+        ASSERT_EQUALS(1U, info.fileInfo.size());
+        ASSERT_EQUALS("ctu", info.fileInfo.front().first);
+        ASSERT_EQUALS("<function-call call-id=\"f\"/>\n", info.fileInfo.front().second);
+
+        // The results are used when the checksum is the same
+        AnalyzerInformation analyzerInformation;
+        std::list<ErrorLogger::ErrorMessage> errors;
+        ASSERT_EQUALS(false, analyzerInformation.analyzeFile(".", sourcefile, "", 1234, &errors, xml));
+        ASSERT_EQUALS(1U, errors.size());
+        analyzerInformation.close();
+
+        std::remove(filename.c_str());
+    }
+
+    void binaryFormat() {
+        readFile(false);
+    }
+
+    void xmlFormat() {
+        readFile(true);
+    }
+
+    void incompleteFile() {
+        const std::string filename = writeFile(false);
+        std::string data;
+        {
+            std::ifstream fin(filename, std::ios::binary);
+            data.assign(std::istreambuf_iterator<char>(fin), std::istreambuf_iterator<char>());
+        }
+        {
+            std::ofstream fout(filename, std::ios::binary);
+            fout << data.substr(0, data.size() - 1U);
+        }
+
+        AnalyzerInformation::Info info;
+        ASSERT_EQUALS(false, AnalyzerInformation::readFile(filename, &info));
+
+        std::remove(filename.c_str());
+    }
+
+    static void writeHeader(const char code[]) {
+        std::ofstream fout(headerfile);
+        fout << code;
+    }
+
+    void inputs(bool xml) {
+        writeHeader("#define N 2\n");
+        const std::list<std::string> headers(1, headerfile);
+        const std::set<std::string> missingHeaders = { missingheaderfile };
+        const AnalyzerInformation::Inputs inputs = AnalyzerInformation::getInputs(1, 2, headers, missingHeaders);
+        ASSERT_EQUALS(1U, inputs.headers.size());
+        ASSERT_EQUALS(1U, inputs.missingHeaders.size());
+
+        std::list<ErrorLogger::ErrorMessage::FileLocation> locs(1, ErrorLogger::ErrorMessage::FileLocation(sourcefile, 3));
+        const ErrorLogger::ErrorMessage errmsg(locs, sourcefile, Severity::error, "Null pointer dereference", "nullPointer", false);
+        {
+            AnalyzerInformation analyzerInformation;
+            std::list<ErrorLogger::ErrorMessage> errors;
+            ASSERT_EQUALS(true, analyzerInformation.analyzeFile(".", sourcefile, "", 1234, &errors, xml, &inputs));
+            analyzerInformation.reportErr(errmsg, false);
+            analyzerInformation.close();
+        }
+
+        std::list<ErrorLogger::ErrorMessage> errors;
+        ASSERT_EQUALS(true, AnalyzerInformation::isUpToDate(".", sourcefile, "", 1, 2, &errors));
+        ASSERT_EQUALS(1U, errors.size());
+        ASSERT_EQUALS(false, AnalyzerInformation::isUpToDate(".", sourcefile, "", 3, 2, &errors));
+        ASSERT_EQUALS(false, AnalyzerInformation::isUpToDate(".", sourcefile, "", 1, 3, &errors));
+
+        // The source file was changed but the checksum of the code is the same => the inputs are updated
+        {
+            const AnalyzerInformation::Inputs inputs2 = AnalyzerInformation::getInputs(1, 3, headers, missingHeaders);
+            AnalyzerInformation analyzerInformation;
+            errors.clear();
+            ASSERT_EQUALS(false, analyzerInformation.analyzeFile(".", sourcefile, "", 1234, &errors, xml, &inputs2));
+            ASSERT_EQUALS(1U, errors.size());
+        }
+        errors.clear();
+        ASSERT_EQUALS(true, AnalyzerInformation::isUpToDate(".", sourcefile, "", 1, 3, &errors));
+        ASSERT_EQUALS(1U, errors.size());
+
+        // A missing header is created
+        {
+            std::ofstream fout(missingheaderfile);
+        }
+        ASSERT_EQUALS(false, AnalyzerInformation::isUpToDate(".", sourcefile, "", 1, 3, &errors));
+        std::remove(missingheaderfile);
+        ASSERT_EQUALS(true, AnalyzerInformation::isUpToDate(".", sourcefile, "", 1, 3, &errors));
+
+        // The header is changed
+        writeHeader("#define N 10\n");
+        ASSERT_EQUALS(false, AnalyzerInformation::isUpToDate(".", sourcefile, "", 1, 3, &errors));
+
+        std::remove(AnalyzerInformation::getAnalyzerInfoFile(".", sourcefile, "").c_str());
+        std::remove(headerfile);
+    }
+
+    void inputsBinaryFormat() {
+        inputs(false);
+    }
+
+    void inputsXmlFormat() {
+        inputs(true);
+    }
+
+    void timings() {
+        std::map<std::string, double> timings1;
+        timings1["a.c"] = 1.5;
+        timings1["dir/b c.c"] = 0.25;
+        AnalyzerInformation::writeTimings(".", timings1);
+
+        std::map<std::string, double> result = AnalyzerInformation::readTimings(".");
+        ASSERT_EQUALS(2U, result.size());
+        ASSERT_EQUALS_DOUBLE(1.5, result["a.c"], 0.001);
+        ASSERT_EQUALS_DOUBLE(0.25, result["dir/b c.c"], 0.001);
+
+        // The timings of a later run are merged with the saved ones
+        std::map<std::string, double> timings2;
+        timings2["a.c"] = 2.0;
+        timings2["c.c"] = 3.0;
+        AnalyzerInformation::writeTimings(".", timings2);
+
+        result = AnalyzerInformation::readTimings(".");
+        ASSERT_EQUALS(3U, result.size());
+        ASSERT_EQUALS_DOUBLE(2.0, result["a.c"], 0.001);
+        ASSERT_EQUALS_DOUBLE(0.25, result["dir/b c.c"], 0.001);
+        ASSERT_EQUALS_DOUBLE(3.0, result["c.c"], 0.001);
+
+        std::remove("timings.txt");
+
+        // No timings are saved
+        ASSERT_EQUALS(true, AnalyzerInformation::readTimings(".").empty());
+    }
+};
+
+const char TestAnalyzerInformation::sourcefile[] = "testanalyzerinfo.c";
+const char TestAnalyzerInformation::headerfile[] = "testanalyzerinfo.h";
+const char TestAnalyzerInformation::missingheaderfile[] = "testanalyzerinfo_missing.h";
+
+REGISTER_TEST(TestAnalyzerInformation)
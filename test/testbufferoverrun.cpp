@@ -250,6 +250,7 @@ private:
         TEST_CASE(ctu_array);
         TEST_CASE(ctu_variable);
         TEST_CASE(ctu_arithmetic);
+        TEST_CASE(ctu_binary);
     }
 
 
@@ -4057,7 +4058,7 @@ private:
         ASSERT_EQUALS("error", errout.str());
     }
 
-    void ctu(const char code[]) {
+    void ctu(const char code[], bool binary = false) {
         // Clear the error buffer..
         errout.str("");
 
@@ -4072,6 +4073,18 @@ private:
         std::list<Check::FileInfo*> fileInfo;
         CheckBufferOverrun check(&tokenizer, &settings0, this);
         fileInfo.push_back(check.getFileInfo(&tokenizer, &settings0));
+
+        // Use the data as it is read from the binary analyzer info files
+        if (binary) {
+            CTU::FileInfo *ctu2 = new CTU::FileInfo;
+            ctu2->loadFromBinary(ctu->toBinary());
+            delete ctu;
+            ctu = ctu2;
+            const Check &c = check;
+            Check::FileInfo *fileInfo2 = c.loadFileInfoFromBinary(fileInfo.front()->toBinary());
+            delete fileInfo.front();
+            fileInfo.front() = fileInfo2;
+        }
         check.analyseWholeProgram(ctu, fileInfo, settings0, *this);
         while (!fileInfo.empty()) {
             delete fileInfo.back();
@@ -4210,6 +4223,24 @@ private:
             "}");
         ASSERT_EQUALS("[test.cpp:4] -> [test.cpp:1]: (error) Pointer arithmetic overflow; 'p' buffer size is 12\n", errout.str());
     }
+
+    void ctu_binary() {
+        ctu("void dostuff(char *p) {\n"
+            "    p[10] = 0;\n"
+            "}\n"
+            "int main() {\n"
+            "  char str[4];\n"
+            "  dostuff(str);\n"
+            "}", true);
+        ASSERT_EQUALS("[test.cpp:6] -> [test.cpp:2]: (error) Array index out of bounds; 'p' buffer size is 4 and it is accessed at offset 10.\n", errout.str());
+
+        ctu("void dostuff(int *p) { x = p + 10; }\n"
+            "int main() {\n"
+            "  int x[3];\n"
+            "  dostuff(x);\n"
+            "}", true);
+        ASSERT_EQUALS("[test.cpp:4] -> [test.cpp:1]: (error) Pointer arithmetic overflow; 'p' buffer size is 12\n", errout.str());
+    }
 };
 
 REGISTER_TEST(TestBufferOverrun)
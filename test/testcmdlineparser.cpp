@@ -98,6 +98,14 @@ private:
         TEST_CASE(jobs);
         TEST_CASE(jobsMissingCount);
         TEST_CASE(jobsInvalid);
+        TEST_CASE(workerPool);
+        TEST_CASE(analyzerInfoXml);
+        TEST_CASE(configJobs);
+        TEST_CASE(configJobsInvalid);
+        TEST_CASE(valueFlowJobs);
+        TEST_CASE(valueFlowJobsInvalid);
+        TEST_CASE(valueFlowMaxIterations);
+        TEST_CASE(valueFlowMaxIterationsInvalid);
         TEST_CASE(maxConfigs);
         TEST_CASE(maxConfigsMissingCount);
         TEST_CASE(maxConfigsInvalid);
@@ -125,6 +133,9 @@ private:
         TEST_CASE(xmlverinvalid);
         TEST_CASE(doc);
         TEST_CASE(showtime);
+        TEST_CASE(showtimeJson);
+        TEST_CASE(trace);
+        TEST_CASE(traceNoFile);
         TEST_CASE(errorlist1);
         TEST_CASE(errorlistverbose1);
         TEST_CASE(errorlistverbose2);
@@ -654,6 +665,64 @@ private:
         ASSERT_EQUALS(false, defParser.parseFromArgs(4, argv));
     }
 
+    void workerPool() {
+        REDIRECT;
+        const char * const argv[] = {"cppcheck", "-j", "3", "--worker-pool", "file.cpp"};
+        settings.workerPool = false;
+        ASSERT(defParser.parseFromArgs(5, argv));
+        ASSERT_EQUALS(true, settings.workerPool);
+    }
+
+    void analyzerInfoXml() {
+        REDIRECT;
+        const char * const argv[] = {"cppcheck", "--cppcheck-build-dir=build", "--analyzer-info-xml", "file.cpp"};
+        settings.analyzerInfoXml = false;
+        ASSERT(defParser.parseFromArgs(4, argv));
+        ASSERT_EQUALS(true, settings.analyzerInfoXml);
+    }
+
+    void configJobs() {
+        REDIRECT;
+        const char * const argv[] = {"cppcheck", "--config-jobs=4", "file.cpp"};
+        settings.configJobs = 1;
+        ASSERT(defParser.parseFromArgs(3, argv));
+        ASSERT_EQUALS(4, settings.configJobs);
+    }
+
+    void configJobsInvalid() {
+        REDIRECT;
+        const char * const argv[] = {"cppcheck", "--config-jobs=0", "file.cpp"};
+        ASSERT_EQUALS(false, defParser.parseFromArgs(3, argv));
+    }
+
+    void valueFlowJobs() {
+        REDIRECT;
+        const char * const argv[] = {"cppcheck", "--valueflow-jobs=4", "file.cpp"};
+        settings.valueFlowJobs = 1;
+        ASSERT(defParser.parseFromArgs(3, argv));
+        ASSERT_EQUALS(4, settings.valueFlowJobs);
+    }
+
+    void valueFlowJobsInvalid() {
+        REDIRECT;
+        const char * const argv[] = {"cppcheck", "--valueflow-jobs=0", "file.cpp"};
+        ASSERT_EQUALS(false, defParser.parseFromArgs(3, argv));
+    }
+
+    void valueFlowMaxIterations() {
+        REDIRECT;
+        const char * const argv[] = {"cppcheck", "--valueflow-max-iterations=3", "file.cpp"};
+        settings.valueFlowMaxIterations = 0;
+        ASSERT(defParser.parseFromArgs(3, argv));
+        ASSERT_EQUALS(3, settings.valueFlowMaxIterations);
+    }
+
+    void valueFlowMaxIterationsInvalid() {
+        REDIRECT;
+        const char * const argv[] = {"cppcheck", "--valueflow-max-iterations=many", "file.cpp"};
+        ASSERT_EQUALS(false, defParser.parseFromArgs(3, argv));
+    }
+
     void maxConfigs() {
         REDIRECT;
         const char * const argv[] = {"cppcheck", "-f", "--max-configs=12", "file.cpp"};
@@ -898,6 +967,31 @@ private:
         ASSERT(settings.showtime == SHOWTIME_SUMMARY);
     }
 
+    void showtimeJson() {
+        REDIRECT;
+        const char * const argv[] = {"cppcheck", "--showtime=json"};
+        settings.showtime = SHOWTIME_NONE;
+        settings.quiet = false;
+        ASSERT(defParser.parseFromArgs(2, argv));
+        ASSERT(settings.showtime == SHOWTIME_JSON);
+        ASSERT_EQUALS(true, settings.quiet);
+    }
+
+    void trace() {
+        REDIRECT;
+        const char * const argv[] = {"cppcheck", "--trace=trace.json", "file.cpp"};
+        settings.traceFile.clear();
+        ASSERT(defParser.parseFromArgs(3, argv));
+        ASSERT_EQUALS("trace.json", settings.traceFile);
+        settings.traceFile.clear();
+    }
+
+    void traceNoFile() {
+        REDIRECT;
+        const char * const argv[] = {"cppcheck", "--trace=", "file.cpp"};
+        ASSERT_EQUALS(false, defParser.parseFromArgs(3, argv));
+    }
+
     void errorlist1() {
         REDIRECT;
         const char * const argv[] = {"cppcheck", "--errorlist"};
@@ -16,14 +16,18 @@
  * along with this program.  If not, see <http://www.gnu.org/licenses/>.
  */
 
+#include "analyzerinfo.h"
 #include "check.h"
 #include "cppcheck.h"
 #include "errorlogger.h"
 #include "testsuite.h"
 
 #include <algorithm>
+#include <cstdio>
+#include <fstream>
 #include <list>
 #include <string>
+#include <vector>
 
 
 class TestCppcheck : public TestFixture {
@@ -36,12 +40,16 @@ private:
     class ErrorLogger2 : public ErrorLogger {
     public:
         std::list<std::string> id;
+        std::list<int> line;
+        std::list<std::string> out;
 
-        void reportOut(const std::string & /*outmsg*/) {
+        void reportOut(const std::string &outmsg) {
+            out.push_back(outmsg);
         }
 
         void reportErr(const ErrorLogger::ErrorMessage &msg) {
             id.push_back(msg._id);
+            line.push_back(msg._callStack.empty() ? 0 : msg._callStack.back().line);
         }
     };
 
@@ -49,6 +57,16 @@ private:
         TEST_CASE(instancesSorted);
         TEST_CASE(classInfoFormat);
         TEST_CASE(getErrorMessages);
+        TEST_CASE(uniqueErrors);
+        TEST_CASE(configJobs);
+        TEST_CASE(missingHeaderCreated);
+        TEST_CASE(combinedPattern);
+#ifdef HAVE_RULES
+        TEST_CASE(compileRules);
+        TEST_CASE(ruleLocation);
+        TEST_CASE(combinedRules);
+        TEST_CASE(combinedRulesExtendedMode);
+#endif
     }
 
     void instancesSorted() const {
@@ -105,6 +123,254 @@ private:
         ASSERT(foundPurgedConfiguration);
         ASSERT(foundTooManyConfigs);
     }
+
+    void uniqueErrors() const {
+        ErrorLogger2 errorLogger;
+        CppCheck cppCheck(errorLogger, true);
+
+        // 100000 unique errors, each reported twice. Only the first one is passed on.
+        const unsigned int count = 100000U;
+        for (int pass = 0; pass < 2; ++pass) {
+            for (unsigned int i = 0; i < count; ++i) {
+                std::list<ErrorLogger::ErrorMessage::FileLocation> locs;
+                locs.emplace_back("file" + std::to_string(i % 100U) + ".cpp", i / 100U + 1U);
+                const ErrorLogger::ErrorMessage msg(locs, emptyString, Severity::style, "Message", "id" + std::to_string(pass), false);
+                cppCheck.reportErr(msg);
+            }
+        }
+        ASSERT_EQUALS(count, errorLogger.id.size());
+        ASSERT_EQUALS(count, std::count(errorLogger.id.begin(), errorLogger.id.end(), "id0"));
+
+        // Same location, different severity, inconclusive or message
+        std::list<ErrorLogger::ErrorMessage::FileLocation> locs(1, ErrorLogger::ErrorMessage::FileLocation("file0.cpp", 1));
+        cppCheck.reportErr(ErrorLogger::ErrorMessage(locs, emptyString, Severity::warning, "Message", "id2", false));
+        cppCheck.reportErr(ErrorLogger::ErrorMessage(locs, emptyString, Severity::style, "Message", "id3", true));
+        cppCheck.reportErr(ErrorLogger::ErrorMessage(locs, emptyString, Severity::style, "Message2", "id4", false));
+        ASSERT_EQUALS(count + 3U, errorLogger.id.size());
+    }
+
+    static std::string checkConfigurations(unsigned int configJobs) {
+        const char code[] = "#ifdef A\n"
+                            "void f1() { int a[2]; a[2] = 0; }\n"
+                            "#endif\n"
+                            "#ifdef B\n"
+                            "void f2() { int *p = 0; *p = 0; }\n"
+                            "#endif\n"
+                            "#ifdef C\n"
+                            "void f3() { char c[1]; c[5] = 0; }\n"
+                            "#endif\n"
+                            "void g() { int x[3]; x[3] = 0; }\n";
+        ErrorLogger2 errorLogger;
+        CppCheck cppCheck(errorLogger, true);
+        cppCheck.settings().configJobs = configJobs;
+        cppCheck.check("test.cpp", code);
+
+        std::string result;
+        for (const std::string &s : errorLogger.out)
+            result += s + '\n';
+        std::list<int>::const_iterator line = errorLogger.line.begin();
+        for (const std::string &id : errorLogger.id)
+            result += id + ':' + std::to_string(*line++) + '\n';
+        return result;
+    }
+
+    void configJobs() const {
+        // The results do not depend on the number of threads
+        const std::string expected("Checking test.cpp ...\n"
+                                   "Checking test.cpp: A...\n"
+                                   "Checking test.cpp: B...\n"
+                                   "Checking test.cpp: C...\n"
+                                   "arrayIndexOutOfBounds:10\n"
+                                   "arrayIndexOutOfBounds:2\n"
+                                   "nullPointer:5\n"
+                                   "arrayIndexOutOfBounds:8\n");
+        ASSERT_EQUALS(expected, checkConfigurations(1));
+        ASSERT_EQUALS(expected, checkConfigurations(2));
+        ASSERT_EQUALS(expected, checkConfigurations(4));
+    }
+
+    static std::size_t checkWithBuildDir(const char filename[]) {
+        ErrorLogger2 errorLogger;
+        CppCheck cppCheck(errorLogger, true);
+        cppCheck.settings().buildDir = ".";
+        cppCheck.settings().quiet = true;
+        cppCheck.check(filename);
+        return errorLogger.id.size();
+    }
+
+    void missingHeaderCreated() const {
+        const char sourcefile[] = "testcppcheck_missing.c";
+        const char headerfile[] = "testcppcheck_missing.h";
+        {
+            std::ofstream fout(sourcefile);
+            fout << "#include \"testcppcheck_missing.h\"\n"
+                 << "void f() { int a[2]; a[N] = 0; }\n";
+        }
+        ASSERT_EQUALS(0U, checkWithBuildDir(sourcefile));
+
+        // The header is found in the next run => the results are not reused
+        {
+            std::ofstream fout(headerfile);
+            fout << "#define N 2\n";
+        }
+        ASSERT_EQUALS(1U, checkWithBuildDir(sourcefile));
+        ASSERT_EQUALS(1U, checkWithBuildDir(sourcefile));
+
+        std::remove(AnalyzerInformation::getAnalyzerInfoFile(".", sourcefile, "").c_str());
+        std::remove(headerfile);
+        std::remove(sourcefile);
+    }
+
+    void combinedPattern() const {
+        std::vector<std::string> patterns;
+        patterns.push_back("int");
+        patterns.push_back("a|b");
+        ASSERT_EQUALS("(?>(?:int))(*MARK:0)(?C)|(?>(?:a|b))(*MARK:1)(?C)", CppCheck::combinePatterns(patterns));
+
+        ASSERT_EQUALS(true, CppCheck::isCombinable("[a-z]+ \\("));
+        ASSERT_EQUALS(true, CppCheck::isCombinable("(?i)int|(?i:char)"));
+        ASSERT_EQUALS(true, CppCheck::isCombinable("\\\\1"));
+
+        // group numbers, start offset, backtracking verbs, callouts and extended mode comments
+        ASSERT_EQUALS(false, CppCheck::isCombinable("( ;) int b\\1"));
+        ASSERT_EQUALS(false, CppCheck::isCombinable("(?<x>a) \\k<x>"));
+        ASSERT_EQUALS(false, CppCheck::isCombinable("(a)(?1)"));
+        ASSERT_EQUALS(false, CppCheck::isCombinable("\\Gint"));
+        ASSERT_EQUALS(false, CppCheck::isCombinable("int(*COMMIT) a"));
+        ASSERT_EQUALS(false, CppCheck::isCombinable("int(?C1)"));
+        ASSERT_EQUALS(false, CppCheck::isCombinable("(?x) int # comment"));
+        ASSERT_EQUALS(false, CppCheck::isCombinable("(?ix:INT \\s b)"));
+    }
+
+#ifdef HAVE_RULES
+    void compileRules() const {
+        ErrorLogger2 errorLogger;
+        CppCheck cppCheck(errorLogger, true);
+        Settings &settings = cppCheck.settings();
+        Settings::Rule rule;
+        rule.pattern = "abc";
+        settings.rules.push_back(rule);
+        rule.pattern = "(";
+        rule.id = "invalid";
+        settings.rules.push_back(rule);
+
+        CppCheck::compileRules(settings);
+        ASSERT(settings.rules.front().compiled != nullptr);
+        ASSERT(settings.rules.back().compiled != nullptr);
+
+        // The compiled patterns are shared by copies of the settings, and not compiled again
+        const Settings copy(settings);
+        CppCheck::compileRules(settings);
+        ASSERT(copy.rules.front().compiled == settings.rules.front().compiled);
+        ASSERT(copy.rules.back().compiled == settings.rules.back().compiled);
+
+        // The compile error is reported when the rule is used
+        cppCheck.check("test.cpp", "abc();");
+        ASSERT_EQUALS(1, std::count(errorLogger.id.begin(), errorLogger.id.end(), "rule"));
+        ASSERT_EQUALS(1, std::count(errorLogger.id.begin(), errorLogger.id.end(), "pcre_compile"));
+    }
+
+    void ruleLocation() const {
+        ErrorLogger2 errorLogger;
+        CppCheck cppCheck(errorLogger, true);
+        Settings::Rule rule;
+        rule.tokenlist = "raw";
+        rule.pattern = " b|x";  // a match starts in the space before b, and one in x
+        cppCheck.settings().rules.push_back(rule);
+
+        cppCheck.check("test.cpp", "int a;\n"
+                       "int\n"
+                       "b;\n"
+                       "int x;");
+        ASSERT_EQUALS(2U, errorLogger.line.size());
+        ASSERT_EQUALS(3, errorLogger.line.front());
+        ASSERT_EQUALS(4, errorLogger.line.back());
+    }
+
+    static std::list<std::string> checkRules(const std::list<Settings::Rule> &rules, const char code[]) {
+        ErrorLogger2 errorLogger;
+        CppCheck cppCheck(errorLogger, true);
+        cppCheck.settings().rules = rules;
+        cppCheck.check("test.cpp", code);
+
+        std::list<std::string> ret;
+        std::list<int>::const_iterator line = errorLogger.line.begin();
+        for (std::list<std::string>::const_iterator id = errorLogger.id.begin(); id != errorLogger.id.end(); ++id, ++line)
+            ret.push_back(*id + ':' + std::to_string(*line));
+        ret.sort();
+        return ret;
+    }
+
+    void combinedRules() const {
+        const char code[] = "int a;\n"
+                            "int\n"
+                            "b;\n"
+                            "int x;";
+        const char * const patterns[] = { "int", " b", "b ; int", "( ;) int b\\1", "nomatch", "int .* int" };
+
+        std::list<Settings::Rule> rules;
+        for (std::size_t i = 0; i < sizeof(patterns) / sizeof(patterns[0]); ++i) {
+            Settings::Rule rule;
+            rule.tokenlist = "raw";
+            rule.pattern = patterns[i];
+            rule.id = "rule" + std::to_string(i);
+            rules.push_back(rule);
+        }
+
+        // Same result as when the rules are executed one by one
+        std::list<std::string> expected;
+        for (const Settings::Rule &rule : rules)
+            expected.splice(expected.end(), checkRules(std::list<Settings::Rule>(1, rule), code));
+        expected.sort();
+        ASSERT_EQUALS(7U, expected.size());
+        ASSERT(expected == checkRules(rules, code));
+
+        // The rule with a back reference is not combined
+        Settings settings;
+        settings.rules = rules;
+        CppCheck::compileRules(settings);
+        std::list<Settings::Rule>::const_iterator rule = settings.rules.begin();
+        ASSERT(rule->combined != nullptr);
+        ASSERT(rule->combined == (++rule)->combined);
+        ASSERT(rule->combined == (++rule)->combined);
+        ASSERT((++rule)->combined == nullptr);
+        ASSERT((++rule)->combined != nullptr);
+        ASSERT((++rule)->combined != nullptr);
+    }
+
+    void combinedRulesExtendedMode() const {
+        const char code[] = "int a;\n"
+                            "int b;";
+        const char * const patterns[] = { "(?x) int # comment", "(?ix:INT \\s b)", "b", "a" };
+
+        std::list<Settings::Rule> rules;
+        for (std::size_t i = 0; i < sizeof(patterns) / sizeof(patterns[0]); ++i) {
+            Settings::Rule rule;
+            rule.tokenlist = "raw";
+            rule.pattern = patterns[i];
+            rule.id = "rule" + std::to_string(i);
+            rules.push_back(rule);
+        }
+
+        // Same result as when the rules are executed one by one
+        std::list<std::string> expected;
+        for (const Settings::Rule &rule : rules)
+            expected.splice(expected.end(), checkRules(std::list<Settings::Rule>(1, rule), code));
+        expected.sort();
+        ASSERT_EQUALS(5U, expected.size());
+        ASSERT(expected == checkRules(rules, code));
+
+        // The rules in extended mode are not combined
+        Settings settings;
+        settings.rules = rules;
+        CppCheck::compileRules(settings);
+        std::list<Settings::Rule>::const_iterator rule = settings.rules.begin();
+        ASSERT(rule->combined == nullptr);
+        ASSERT((++rule)->combined == nullptr);
+        ASSERT((++rule)->combined != nullptr);
+        ASSERT(rule->combined == (++rule)->combined);
+    }
+#endif
 };
 
 REGISTER_TEST(TestCppcheck)
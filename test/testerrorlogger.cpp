@@ -57,6 +57,9 @@ private:
         TEST_CASE(SerializeInconclusiveMessage);
         TEST_CASE(DeserializeInvalidInput);
         TEST_CASE(SerializeSanitize);
+        TEST_CASE(SerializeBinary);
+        TEST_CASE(DeserializeBinaryInvalidInput);
+        TEST_CASE(UniqueKey);
 
         TEST_CASE(suppressUnmatchedSuppressions);
     }
@@ -289,6 +292,76 @@ private:
         ASSERT_EQUALS("Illegal character in \"foo\\001bar\"", msg2.verboseMessage());
     }
 
+    void SerializeBinary() const {
+        ErrorLogger::ErrorMessage::FileLocation loc1("foo.h", "first", 300);
+        loc1.col = 7;
+        loc1.fileIndex = 2;
+        loc1.setfile("bar.h");
+        std::list<ErrorLogger::ErrorMessage::FileLocation> locs;
+        locs.push_back(loc1);
+        locs.push_back(fooCpp5);
+        ErrorMessage msg(locs, "foo.cpp", Severity::warning, "$symbol:abc\nProgramming $symbol.\nVerbose \001 error", "errorId", CWE(123U), true);
+
+        std::string data("x");
+        msg.serializeBinary(data);
+
+        ErrorMessage msg2;
+        ASSERT_EQUALS(true, msg2.deserializeBinary(data.data() + 1, data.size() - 1));
+        ASSERT_EQUALS("errorId", msg2._id);
+        ASSERT_EQUALS(Severity::warning, msg2._severity);
+        ASSERT_EQUALS(123U, msg2._cwe.id);
+        ASSERT_EQUALS(true, msg2._inconclusive);
+        ASSERT_EQUALS("foo.cpp", msg2.file0);
+        ASSERT_EQUALS(msg.shortMessage(), msg2.shortMessage());
+        ASSERT_EQUALS(msg.verboseMessage(), msg2.verboseMessage());
+        ASSERT_EQUALS("abc\n", msg2.symbolNames());
+        ASSERT_EQUALS(2U, msg2._callStack.size());
+        ASSERT_EQUALS("bar.h", msg2._callStack.front().getfile(false));
+        ASSERT_EQUALS("foo.h", msg2._callStack.front().getOrigFile(false));
+        ASSERT_EQUALS("first", msg2._callStack.front().getinfo());
+        ASSERT_EQUALS(300, msg2._callStack.front().line);
+        ASSERT_EQUALS(7U, msg2._callStack.front().col);
+        ASSERT_EQUALS(2U, msg2._callStack.front().fileIndex);
+        ASSERT_EQUALS(msg.toXML(), msg2.toXML());
+        ASSERT_EQUALS(msg.toString(true), msg2.toString(true));
+    }
+
+    void DeserializeBinaryInvalidInput() const {
+        std::list<ErrorLogger::ErrorMessage::FileLocation> locs(1, fooCpp5);
+        ErrorMessage msg(locs, emptyString, Severity::error, "Programming error", "errorId", false);
+        std::string data;
+        msg.serializeBinary(data);
+
+        // Truncated data
+        ErrorMessage msg2;
+        for (std::size_t size = 0; size < data.size(); ++size)
+            ASSERT_EQUALS(false, msg2.deserializeBinary(data.data(), size));
+
+        // Trailing data
+        ASSERT_EQUALS(false, msg2.deserializeBinary((data + 'x').data(), data.size() + 1));
+
+        // Invalid severity
+        data[data.find("errorId") + 7] = 100;
+        ASSERT_EQUALS(false, msg2.deserializeBinary(data.data(), data.size()));
+    }
+
+    void UniqueKey() const {
+        std::list<ErrorLogger::ErrorMessage::FileLocation> locs(1, fooCpp5);
+        const ErrorMessage msg1(locs, emptyString, Severity::error, "Programming error.\nVerbose error", "errorId", false);
+        const ErrorMessage msg2(locs, emptyString, Severity::error, "Programming error.\nOther verbose error", "otherId", false);
+        ASSERT(msg1.uniqueKey(false) == msg2.uniqueKey(false));
+        ASSERT(msg1.uniqueKey(true) != msg2.uniqueKey(true));
+
+        locs.push_back(barCpp8);
+        const ErrorMessage msg3(locs, emptyString, Severity::error, "Programming error.\nVerbose error", "errorId", false);
+        ASSERT(msg1.uniqueKey(false) != msg3.uniqueKey(false));
+
+        // inconclusive is not shown without severity
+        const ErrorMessage msg4(locs, emptyString, Severity::none, "Programming error.", "errorId", false);
+        const ErrorMessage msg5(locs, emptyString, Severity::none, "Programming error.", "errorId", true);
+        ASSERT(msg4.uniqueKey(false) == msg5.uniqueKey(false));
+    }
+
     void suppressUnmatchedSuppressions() {
         std::list<Suppressions::Suppression> suppressions;
 
@@ -4,6 +4,7 @@ INCLUDEPATH += ../externals/tinyxml
 
 
 SOURCES += $${BASEPATH}/test64bit.cpp \
+           $${BASEPATH}/testanalyzerinfo.cpp \
            $${BASEPATH}/testassert.cpp \
            $${BASEPATH}/testastutils.cpp \
            $${BASEPATH}/testautovariables.cpp \
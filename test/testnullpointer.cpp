@@ -100,6 +100,7 @@ private:
         TEST_CASE(addNull);
 
         TEST_CASE(ctu);
+        TEST_CASE(ctuBinary);
     }
 
     void check(const char code[], bool inconclusive = false, const char filename[] = "test.cpp") {
@@ -2748,7 +2749,7 @@ private:
         ASSERT_EQUALS("", errout.str());
     }
 
-    void ctu(const char code[]) {
+    void ctu(const char code[], bool binary = false) {
         // Clear the error buffer..
         errout.str("");
 
@@ -2763,6 +2764,17 @@ private:
         std::list<Check::FileInfo*> fileInfo;
         CheckNullPointer check(&tokenizer, &settings, this);
         fileInfo.push_back(check.getFileInfo(&tokenizer, &settings));
+
+        // Use the data as it is read from the binary analyzer info files
+        if (binary) {
+            CTU::FileInfo *ctu2 = new CTU::FileInfo;
+            ctu2->loadFromBinary(ctu->toBinary());
+            delete ctu;
+            ctu = ctu2;
+            Check::FileInfo *fileInfo2 = check.loadFileInfoFromBinary(fileInfo.front()->toBinary());
+            delete fileInfo.front();
+            fileInfo.front() = fileInfo2;
+        }
         check.analyseWholeProgram(ctu, fileInfo, settings, *this);
         while (!fileInfo.empty()) {
             delete fileInfo.back();
@@ -2839,6 +2851,32 @@ private:
             "}");
         ASSERT_EQUALS("", errout.str());
     }
+
+    void ctuBinary() {
+        setMultiline();
+
+        ctu("void f(int *fp) {\n"
+            "    a = *fp;\n"
+            "}\n"
+            "int main() {\n"
+            "  int *p = 0;\n"
+            "  f(p);\n"
+            "}", true);
+        ASSERT_EQUALS("test.cpp:2:error:Null pointer dereference: fp\n"
+                      "test.cpp:5:note:Assignment 'p=0', assigned value is 0\n"
+                      "test.cpp:6:note:Calling function f, 1st argument is null\n"
+                      "test.cpp:2:note:Dereferencing argument fp that is null\n", errout.str());
+
+        ctu("void use(int *p) { a = *p + 3; }\n"
+            "void call(int x, int *p) { x++; use(p); }\n"
+            "int main() {\n"
+            "  call(4,0);\n"
+            "}", true);
+        ASSERT_EQUALS("test.cpp:1:error:Null pointer dereference: p\n"
+                      "test.cpp:4:note:Calling function call, 2nd argument is null\n"
+                      "test.cpp:2:note:Calling function use, 1st argument is null\n"
+                      "test.cpp:1:note:Dereferencing argument p that is null\n", errout.str());
+    }
 };
 
 REGISTER_TEST(TestNullPointer)
@@ -26,10 +26,13 @@
 #include "testsuite.h"
 
 #include <simplecpp.h>
+#include <cstdio>
 #include <cstring>
+#include <fstream>
 #include <list>
 #include <map>
 #include <set>
+#include <sstream>
 #include <string>
 #include <vector>
 
@@ -84,6 +87,12 @@ private:
 
         TEST_CASE(setPlatformInfo);
 
+        TEST_CASE(headerCache);
+        TEST_CASE(headerCacheLimit);
+        TEST_CASE(readfileUtf16);
+        TEST_CASE(macroNames);
+        TEST_CASE(sharedConfigurations);
+
         // Handling include guards (don't create extra configuration for it)
         TEST_CASE(includeguard1);
         TEST_CASE(includeguard2);
@@ -427,6 +436,186 @@ private:
         ASSERT_EQUALS("\nB\n", getConfigsStr(filedata));
     }
 
+    void headerCache() {
+        const char filename[] = "headercache.h";
+        {
+            std::ofstream fout(filename);
+            fout << "int x;";
+        }
+
+        simplecpp::FileCache cache;
+
+        std::vector<std::string> files1(1, "1.c");
+        std::ifstream fin1(filename);
+        simplecpp::TokenList *tokens1 = cache.get(fin1, files1, filename);
+        ASSERT_EQUALS("x", tokens1->cfront()->next->str());
+        ASSERT_EQUALS(filename, tokens1->cfront()->location.file());
+        delete tokens1;
+
+        // The cached tokens get the file index of the other source file
+        std::vector<std::string> files2;
+        files2.push_back("2.c");
+        files2.push_back("2.h");
+        std::ifstream fin2(filename);
+        simplecpp::TokenList *tokens2 = cache.get(fin2, files2, filename);
+        ASSERT_EQUALS("x", tokens2->cfront()->next->str());
+        ASSERT_EQUALS(2U, tokens2->cfront()->location.fileIndex);
+        ASSERT_EQUALS(filename, tokens2->cback()->location.file());
+        ASSERT_EQUALS(1U, cache.size());
+        delete tokens2;
+
+        // The header is tokenized again when it has been changed
+        {
+            std::ofstream fout(filename);
+            fout << "int xyz;";
+        }
+        std::ifstream fin3(filename);
+        simplecpp::TokenList *tokens3 = cache.get(fin3, files1, filename);
+        ASSERT_EQUALS("xyz", tokens3->cfront()->next->str());
+        delete tokens3;
+
+        // Also when the size is the same
+        {
+            std::ofstream fout(filename);
+            fout << "int abc;";
+        }
+        std::ifstream fin4(filename);
+        simplecpp::TokenList *tokens4 = cache.get(fin4, files1, filename);
+        ASSERT_EQUALS("abc", tokens4->cfront()->next->str());
+        ASSERT_EQUALS(1U, cache.size());
+        delete tokens4;
+
+        fin1.close();
+        fin2.close();
+        fin3.close();
+        fin4.close();
+        std::remove(filename);
+    }
+
+    static std::string readfile(const std::string &code) {
+        std::istringstream istr(code);
+        std::vector<std::string> files;
+        const simplecpp::TokenList tokens(istr, files, "test.c");
+        return tokens.stringify();
+    }
+
+    static std::string utf16(const std::string &code, bool bigEndian) {
+        std::string ret(bigEndian ? "\xfe\xff" : "\xff\xfe");
+        for (std::string::const_iterator it = code.begin(); it != code.end(); ++it) {
+            ret += bigEndian ? '\0' : *it;
+            ret += bigEndian ? *it : '\0';
+        }
+        return ret;
+    }
+
+    void readfileUtf16() {
+        // UTF-16 files are tokenized from the istream, other files from a
+        // buffer in memory. Both must give the same tokens.
+        const char code[] = "#define A(x) \\\n"
+                            "  x + 1\n"
+                            "/* comment\n"
+                            "   */ int a = A(2); // comment \\\n"
+                            "continued\n"
+                            "const char *s = \"a\\\"b\";\r\n"
+                            "char c = '\\'';\r\n"
+                            "const char *r = R\"x(raw\n"
+                            "string)x\";\n"
+                            "  #  if 0x1p-2 > .5e+1\n"
+                            "#endif\n"
+                            "int b";
+        const std::string expected = readfile(code);
+        ASSERT_EQUALS(expected, readfile("\xef\xbb\xbf" + std::string(code)));
+        ASSERT_EQUALS(expected, readfile(utf16(code, false)));
+        ASSERT_EQUALS(expected, readfile(utf16(code, true)));
+
+        // Tokenize a buffer without a stream
+        const std::string utf16le = utf16(code, false);
+        std::vector<std::string> files;
+        ASSERT_EQUALS(expected, simplecpp::TokenList(code, sizeof(code) - 1U, files, "test.c").stringify());
+        ASSERT_EQUALS(expected, simplecpp::TokenList(utf16le.data(), utf16le.size(), files, "test.c").stringify());
+    }
+
+    void headerCacheLimit() {
+        // At most 5 tokens are cached
+        simplecpp::FileCache cache(5);
+        std::vector<std::string> files(1, "1.c");
+
+        std::istringstream istr1("int a;");
+        delete cache.get(istr1, files, "a.h");
+        std::istringstream istr2("int b;");
+        delete cache.get(istr2, files, "b.h");
+        ASSERT_EQUALS(1U, cache.size());
+
+        // Files with more tokens than the limit are not cached
+        std::istringstream istr3("int c = 0;");
+        simplecpp::TokenList *tokens = cache.get(istr3, files, "c.h");
+        ASSERT_EQUALS("c", tokens->cfront()->next->str());
+        ASSERT_EQUALS(1U, cache.size());
+        delete tokens;
+    }
+
+    void macroNames() {
+        const char code[] = "#define M(x) x + y\n"
+                            "#ifdef A\n"
+                            "#ifdef B\n"
+                            "b\n"
+                            "#endif\n"
+                            "#elif C > 1\n"
+                            "#endif\n"
+                            "M(z)";
+        std::vector<std::string> files;
+        std::istringstream istr(code);
+        const simplecpp::TokenList tokens1(istr, files, "test.c");
+        std::map<std::string, simplecpp::TokenList*> filedata;
+        simplecpp::TokenList tokens2(files);
+        std::set<std::string> names;
+        simplecpp::preprocess(tokens2, tokens1, files, filedata, simplecpp::DUI(), nullptr, nullptr, &names);
+        ASSERT_EQUALS(true, names.find("A") != names.end());
+        ASSERT_EQUALS(false, names.find("B") != names.end());
+        ASSERT_EQUALS(true, names.find("C") != names.end());
+        ASSERT_EQUALS(true, names.find("y") != names.end());
+
+        // Token pasting creates names
+        std::istringstream istr2("#define CAT(a,b) a##b\nCAT(x,y)");
+        const simplecpp::TokenList tokens3(istr2, files, "test.c");
+        simplecpp::TokenList tokens4(files);
+        names.clear();
+        simplecpp::preprocess(tokens4, tokens3, files, filedata, simplecpp::DUI(), nullptr, nullptr, &names);
+        ASSERT_EQUALS(true, names.find("##") != names.end());
+    }
+
+    void sharedConfigurations() {
+        // B is only used when A is defined, the configuration B has the output of the configuration ""
+        const char code[] = "#ifdef A\n"
+                            "#ifdef B\n"
+                            "b\n"
+                            "#endif\n"
+                            "a\n"
+                            "#endif\n"
+                            "x";
+        Settings settings;
+        Preprocessor preprocessor(settings, this);
+        std::vector<std::string> files(1, "test.c");
+        std::istringstream istr(code);
+        const simplecpp::TokenList tokens1(istr, files, "test.c");
+        preprocessor.loadFiles(tokens1, files);
+        ASSERT_EQUALS("\n\n\n\n\n\nx", preprocessor.getcode(tokens1, "", files, false));
+        ASSERT_EQUALS("\n\n\n\n\n\nx", preprocessor.getcode(tokens1, "B", files, false));
+        ASSERT_EQUALS("\n\n\n\na\n\nx", preprocessor.getcode(tokens1, "A", files, false));
+        ASSERT_EQUALS("\n\nb\n\na\n\nx", preprocessor.getcode(tokens1, "A;B", files, false));
+
+        // The configuration B is not preprocessed again
+        bool duplicate = true;
+        ASSERT_EQUALS(false, preprocessor.preprocess(tokens1, "", files, false, &duplicate).empty());
+        ASSERT_EQUALS(false, duplicate);
+        ASSERT_EQUALS(true, preprocessor.preprocess(tokens1, "B", files, false, &duplicate).empty());
+        ASSERT_EQUALS(true, duplicate);
+        ASSERT_EQUALS(false, preprocessor.preprocess(tokens1, "A", files, false, &duplicate).empty());
+        ASSERT_EQUALS(false, duplicate);
+        ASSERT_EQUALS(false, preprocessor.preprocess(tokens1, "A;B", files, false, &duplicate).empty());
+        ASSERT_EQUALS(false, duplicate);
+    }
+
     void setPlatformInfo() {
         Settings settings;
         Preprocessor preprocessor(settings, this);
@@ -16,11 +16,13 @@
  * along with this program.  If not, see <http://www.gnu.org/licenses/>.
  */
 
+#include "analyzerinfo.h"
 #include "settings.h"
 #include "testsuite.h"
 #include "threadexecutor.h"
 
 #include <cstddef>
+#include <cstdio>
 #include <map>
 #include <ostream>
 #include <string>
@@ -38,7 +40,7 @@ private:
      * Execute check using n jobs for y files which are have
      * identical data, given within data.
      */
-    void check(unsigned int jobs, int files, int result, const std::string &data) {
+    void check(unsigned int jobs, int files, int result, const std::string &data, bool workerPool = false) {
         errout.str("");
         output.str("");
         if (!ThreadExecutor::isEnabled()) {
@@ -54,6 +56,7 @@ private:
         }
 
         settings.jobs = jobs;
+        settings.workerPool = workerPool;
         ThreadExecutor executor(filemap, settings, *this);
         for (std::map<std::string, std::size_t>::const_iterator i = filemap.begin(); i != filemap.end(); ++i)
             executor.addFileContent(i->first, data);
@@ -71,6 +74,10 @@ private:
         TEST_CASE(no_errors_equal_amount_files);
         TEST_CASE(one_error_less_files);
         TEST_CASE(one_error_several_files);
+        TEST_CASE(worker_pool_deadlock_with_many_errors);
+        TEST_CASE(worker_pool_more_files);
+        TEST_CASE(worker_pool_less_files);
+        TEST_CASE(job_order);
     }
 
     void deadlock_with_many_errors() {
@@ -135,6 +142,71 @@ private:
               "  return 0;\n"
               "}");
     }
+
+    void worker_pool_deadlock_with_many_errors() {
+        std::ostringstream oss;
+        oss << "int main()\n"
+            << "{\n";
+        for (int i = 0; i < 500; i++)
+            oss << "  {char *a = malloc(10);}\n";
+
+        oss << "  return 0;\n"
+            << "}\n";
+        check(2, 3, 3, oss.str(), true);
+    }
+
+    void worker_pool_more_files() {
+        check(4, 50, 50,
+              "int main()\n"
+              "{\n"
+              "  {char *a = malloc(10);}\n"
+              "  return 0;\n"
+              "}", true);
+    }
+
+    void worker_pool_less_files() {
+        check(16, 3, 3,
+              "int main()\n"
+              "{\n"
+              "  {char *a = malloc(10);}\n"
+              "  return 0;\n"
+              "}", true);
+    }
+
+    static std::string jobNames(const ThreadExecutor &executor) {
+        std::string names;
+        for (const ThreadExecutor::Job &job : executor._jobs)
+            names += (names.empty() ? "" : " ") + job.name();
+        return names;
+    }
+
+    void job_order() {
+        std::map<std::string, std::size_t> filemap;
+        filemap["a.c"] = 100;
+        filemap["b.c"] = 300;
+        filemap["c.c"] = 200;
+        filemap["d.c"] = 50;
+
+        // Without timings the biggest files are started first
+        Settings settings1;
+        ThreadExecutor executor(filemap, settings1, *this);
+        executor.createJobs();
+        ASSERT_EQUALS("b.c c.c a.c d.c", jobNames(executor));
+
+        // The check times of an earlier run are used when they are known. The
+        // cost of the other files is their size times the known time per byte.
+        std::map<std::string, double> timings;
+        timings["a.c"] = 0.1;
+        timings["d.c"] = 4.0;
+        AnalyzerInformation::writeTimings(".", timings);
+        settings1.buildDir = ".";
+        executor.createJobs();
+        ASSERT_EQUALS("b.c c.c d.c a.c", jobNames(executor));
+        ASSERT_EQUALS_DOUBLE(300 * 4.1 / 150, executor._jobs[0].cost, 0.001);
+        ASSERT_EQUALS_DOUBLE(4.0, executor._jobs[2].cost, 0.001);
+
+        std::remove("timings.txt");
+    }
 };
 
 REGISTER_TEST(TestThreadExecutor)
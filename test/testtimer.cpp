@@ -16,11 +16,20 @@
  * along with this program.  If not, see <http://www.gnu.org/licenses/>.
  */
 
+#include "redirect.h"
 #include "testsuite.h"
 #include "timer.h"
+#include "utils.h"
 
+#include <algorithm>
 #include <cmath>
+#include <cstdio>
 #include <ctime>
+#include <fstream>
+#include <iterator>
+#include <list>
+#include <string>
+#include <vector>
 
 class TestTimer : public TestFixture {
 public:
@@ -31,6 +40,36 @@ private:
 
     void run() OVERRIDE {
         TEST_CASE(result);
+        TEST_CASE(count);
+        TEST_CASE(nested);
+        TEST_CASE(summary);
+        TEST_CASE(top5);
+        TEST_CASE(json);
+        TEST_CASE(merge);
+        TEST_CASE(trace);
+    }
+
+    /** Records the paths of the timers */
+    class TimerPaths : public TimerResultsIntf {
+    public:
+        void AddResults(const std::vector<std::string>& path, const TimerResultsData& /*data*/) OVERRIDE {
+            std::string str;
+            for (const std::string &name : path)
+                str += (str.empty() ? "" : "/") + name;
+            paths.push_back(str);
+        }
+        void AddFileResults(const std::string& file, const TimerResultsData& /*data*/) OVERRIDE {
+            paths.push_back("file:" + file);
+        }
+        std::list<std::string> paths;
+    };
+
+    static TimerResultsData data(long seconds, double wall) {
+        TimerResultsData d;
+        d.mClocks = CLOCKS_PER_SEC * seconds;
+        d.mWall = wall;
+        d.mNumberOfResults = 1;
+        return d;
     }
 
     void result() const {
@@ -41,6 +80,147 @@ private:
         t1.mClocks = CLOCKS_PER_SEC * 5 / 2;
         ASSERT(std::fabs(t1.seconds()-2.5) < 0.01);
     }
+
+    void count() {
+        REDIRECT;
+        TimerResults results;
+        results.AddCount("Skipped duplicate configurations");
+        results.AddCount("Skipped duplicate configurations");
+        results.ShowResults(SHOWTIME_SUMMARY);
+        ASSERT_EQUALS("\nOverall time: 0s\nSkipped duplicate configurations: 2\n", GET_REDIRECT_OUTPUT);
+    }
+
+    void nested() const {
+        TimerPaths timerPaths;
+        {
+            Timer file(SHOWTIME_SUMMARY, &timerPaths, "test.c");
+            Timer t1("a", SHOWTIME_SUMMARY, &timerPaths);
+            {
+                Timer t2("b", SHOWTIME_SUMMARY, &timerPaths);
+                Timer t3("c", SHOWTIME_SUMMARY, &timerPaths);
+            }
+            Timer t4("d", SHOWTIME_SUMMARY, &timerPaths);
+            t1.Stop();
+            Timer t5("e", SHOWTIME_SUMMARY, &timerPaths);
+        }
+        {
+            Timer t6("f", SHOWTIME_NONE, &timerPaths);
+            Timer t7("g", SHOWTIME_SUMMARY, &timerPaths);
+        }
+        // "a" is stopped before "d" => "d" is moved to the parent of "a"
+        std::string paths;
+        for (const std::string &path : timerPaths.paths)
+            paths += path + ' ';
+        ASSERT_EQUALS("a/b/c a/b a d/e d file:test.c g ", paths);
+    }
+
+    void summary() {
+        REDIRECT;
+        TimerResults results;
+        results.AddResults(std::vector<std::string>(1, "a"), data(3, 4));
+        results.AddResults(std::vector<std::string> {"a", "b"}, data(1, 1.5));
+        results.AddResults(std::vector<std::string> {"a", "c"}, data(2, 2));
+        results.AddResults(std::vector<std::string>(1, "d"), data(1, 1));
+        results.AddFileResults("test.c", data(4, 5));
+        results.ShowResults(SHOWTIME_SUMMARY);
+        ASSERT_EQUALS("\n"
+                      "a: 3s (avg. 3s - 1 result(s), wall 4s)\n"
+                      "  c: 2s (avg. 2s - 1 result(s), wall 2s)\n"
+                      "  b: 1s (avg. 1s - 1 result(s), wall 1.5s)\n"
+                      "d: 1s (avg. 1s - 1 result(s), wall 1s)\n"
+                      "Overall time: 4s\n"
+                      "Slowest files:\n"
+                      "  test.c: 5s (cpu 4s)\n", GET_REDIRECT_OUTPUT);
+    }
+
+    void top5() {
+        REDIRECT;
+        TimerResults results;
+        results.AddResults(std::vector<std::string>(1, "a"), data(6, 7));
+        results.AddResults(std::vector<std::string> {"a", "b"}, data(1, 1.5));
+        results.AddResults(std::vector<std::string> {"a", "c"}, data(2, 2));
+        results.AddResults(std::vector<std::string>(1, "d"), data(1, 1));
+        results.ShowResults(SHOWTIME_TOP5);
+        // The time of "a" without the times of "b" and "c" is ranked
+        ASSERT_EQUALS("\n"
+                      "a: 3s (avg. 3s - 1 result(s), wall 3.5s)\n"
+                      "c: 2s (avg. 2s - 1 result(s), wall 2s)\n"
+                      "b: 1s (avg. 1s - 1 result(s), wall 1.5s)\n"
+                      "d: 1s (avg. 1s - 1 result(s), wall 1s)\n"
+                      "Overall time: 7s\n", GET_REDIRECT_OUTPUT);
+    }
+
+    void json() {
+        REDIRECT;
+        TimerResults results;
+        results.AddResults(std::vector<std::string>(1, "a"), data(3, 4));
+        results.AddResults(std::vector<std::string> {"a", "b"}, data(1, 1.5));
+        results.AddFileResults("dir\\test.c", data(4, 5));
+        results.AddCount("Skipped duplicate configurations");
+        results.ShowResults(SHOWTIME_JSON);
+        ASSERT_EQUALS("{\n"
+                      "  \"overall\": {\"cpu\": 3, \"wall\": 4, \"count\": 1},\n"
+                      "  \"timers\": [\n"
+                      "    {\"name\": \"a\", \"cpu\": 3, \"wall\": 4, \"count\": 1, \"children\": [\n"
+                      "      {\"name\": \"b\", \"cpu\": 1, \"wall\": 1.5, \"count\": 1, \"children\": []}\n"
+                      "    ]}\n"
+                      "  ],\n"
+                      "  \"files\": [\n"
+                      "    {\"file\": \"dir\\\\test.c\", \"cpu\": 4, \"wall\": 5, \"count\": 1}\n"
+                      "  ],\n"
+                      "  \"counts\": {\n"
+                      "    \"Skipped duplicate configurations\": 1\n"
+                      "  }\n"
+                      "}\n", GET_REDIRECT_OUTPUT);
+    }
+
+    void merge() const {
+        TimerResults results1;
+        results1.AddResults(std::vector<std::string> {"a", "b"}, data(1, 1.5));
+        results1.AddFileResults("test.c", data(4, 5));
+        results1.AddCount("Skipped duplicate configurations", 2);
+
+        TimerResults results2;
+        const std::string data1 = results1.serialize();
+        ASSERT_EQUALS(true, results2.merge(data1.data(), data1.size()));
+        ASSERT_EQUALS(data1, results2.serialize());
+
+        results1.AddResults(std::vector<std::string> {"a", "b"}, data(1, 1.5));
+        results1.AddFileResults("test.c", data(4, 5));
+        results1.AddCount("Skipped duplicate configurations", 2);
+        ASSERT_EQUALS(true, results2.merge(data1.data(), data1.size()));
+        ASSERT_EQUALS(results1.serialize(), results2.serialize());
+
+        ASSERT_EQUALS(false, results2.merge(data1.data(), data1.size() - 1));
+    }
+
+    void trace() const {
+        ASSERT_EQUALS(true, TraceEvents::open("testtimer.json"));
+
+        // The events of a ThreadExecutor child are given to the writer after each file
+        std::string events;
+        TraceEvents::setWriter([&events](const std::string &e) {
+            events += e;
+        });
+        {
+            Timer file(SHOWTIME_NONE, nullptr, "test.c");
+            Timer t1("a", SHOWTIME_NONE, nullptr);
+        }
+        TraceEvents::setWriter(nullptr);
+        ASSERT_EQUALS(2, std::count(events.begin(), events.end(), '\n'));
+        ASSERT(events.find("{\"name\":\"a\",\"cat\":\"cppcheck\",\"ph\":\"X\",") == 0);
+        ASSERT(events.find("{\"name\":\"test.c\",\"cat\":\"file\",\"ph\":\"X\",") != std::string::npos);
+        TraceEvents::append(events);
+        TraceEvents::close();
+        ASSERT_EQUALS(false, TraceEvents::enabled());
+
+        std::ifstream fin("testtimer.json");
+        const std::string data((std::istreambuf_iterator<char>(fin)), std::istreambuf_iterator<char>());
+        ASSERT(data.find("{\"traceEvents\":[\n" + events + "{\"name\":\"process_name\",\"ph\":\"M\",") == 0);
+        ASSERT(endsWith(data, "}\n]}\n", 5));
+        fin.close();
+        std::remove("testtimer.json");
+    }
 };
 
 REGISTER_TEST(TestTimer)
@@ -23,6 +23,7 @@
 #include "tokenize.h"
 #include "tokenlist.h"
 
+#include <cstring>
 #include <string>
 #include <vector>
 
@@ -79,6 +80,9 @@ private:
         TEST_CASE(matchOr);
         TEST_CASE(matchOp);
         TEST_CASE(matchConstOp);
+        TEST_CASE(matchCompiled);
+        TEST_CASE(matchCompiledArray);
+        TEST_CASE(arena);
 
         TEST_CASE(isArithmeticalOp);
         TEST_CASE(isOp);
@@ -604,6 +608,111 @@ private:
         ASSERT_EQUALS(true, Token::Match(logicalAnd.tokens(), "; %oror%|&&"));
     }
 
+    /** Compare the compiled pattern with the interpreted pattern at each token, return the differences */
+    template<std::size_t N>
+    static std::string compareCompiled(const Token *tokens, const char (&pattern)[N]) {
+        std::string ret;
+        for (const Token *tok = tokens; tok; tok = tok->next()) {
+            if (Token::Match(tok, pattern, 1) != Token::Match(tok, Token::DynamicPattern(pattern), 1))
+                ret += "Match:" + tok->str() + ' ';
+            if (Token::simpleMatch(tok, pattern) != Token::simpleMatch(tok, Token::DynamicPattern(pattern)))
+                ret += "simpleMatch:" + tok->str() + ' ';
+        }
+        if (Token::Match(nullptr, pattern, 1) != Token::Match(nullptr, Token::DynamicPattern(pattern), 1))
+            ret += "Match:null ";
+        if (Token::findmatch(tokens, pattern, 1) != Token::findmatch(tokens, Token::DynamicPattern(pattern), 1))
+            ret += "findmatch ";
+        if (Token::findsimplematch(tokens, pattern) != Token::findsimplematch(tokens, Token::DynamicPattern(pattern)))
+            ret += "findsimplematch ";
+        return ret;
+    }
+
+    void matchCompiled() const {
+        givenACodeSampleToTokenize code("void f(int x, char *s) {\n"
+                                        "    if (x == 1 || x | 2) { s[0] = 'a'; s = \"a b\"; }\n"
+                                        "    else { x %= 3; x = x % 2; return !true; }\n"
+                                        "}");
+        ASSERT_EQUALS("", compareCompiled(code.tokens(), "%name% ("));
+        ASSERT_EQUALS("", compareCompiled(code.tokens(), "%var%|%num% )|;"));
+        ASSERT_EQUALS("", compareCompiled(code.tokens(), "if|while ( %varid% =="));
+        ASSERT_EQUALS("", compareCompiled(code.tokens(), "[;{}] %name%"));
+        ASSERT_EQUALS("", compareCompiled(code.tokens(), "[[]]] %num%|0"));
+        ASSERT_EQUALS("", compareCompiled(code.tokens(), "} !!else"));
+        ASSERT_EQUALS("", compareCompiled(code.tokens(), "} !!"));
+        ASSERT_EQUALS("", compareCompiled(code.tokens(), "; } !!else"));
+        ASSERT_EQUALS("", compareCompiled(code.tokens(), "x %op%|"));
+        ASSERT_EQUALS("", compareCompiled(code.tokens(), "( x| x"));
+        ASSERT_EQUALS("", compareCompiled(code.tokens(), "( |x"));
+        ASSERT_EQUALS("", compareCompiled(code.tokens(), "x x||y|%num%"));
+        ASSERT_EQUALS("", compareCompiled(code.tokens(), "%oror%|%or% %num%"));
+        ASSERT_EQUALS("", compareCompiled(code.tokens(), "%comp%|%assign% %any%"));
+        ASSERT_EQUALS("", compareCompiled(code.tokens(), "= %str%|%char%"));
+        ASSERT_EQUALS("", compareCompiled(code.tokens(), "= \"a b\""));
+        ASSERT_EQUALS("", compareCompiled(code.tokens(), "! %bool% ;"));
+        ASSERT_EQUALS("", compareCompiled(code.tokens(), "%cop% %type%|%var%"));
+        ASSERT_EQUALS("", compareCompiled(code.tokens(), "x % 2"));
+        ASSERT_EQUALS("", compareCompiled(code.tokens(), "%|= %num%"));
+        ASSERT_EQUALS("", compareCompiled(code.tokens(), "  s  [  "));
+        ASSERT_EQUALS("", compareCompiled(code.tokens(), "s [ "));
+        ASSERT_EQUALS("", compareCompiled(code.tokens(), ""));
+    }
+
+    void matchCompiledArray() const {
+        givenACodeSampleToTokenize code("if ( x ) { } else { }", true);
+
+        // The content of a non-const array can change, it is interpreted
+        char pattern[10] = "if (";
+        ASSERT_EQUALS(true, Token::Match(code.tokens(), pattern));
+        ASSERT_EQUALS(true, Token::simpleMatch(code.tokens(), pattern));
+        std::strcpy(pattern, "else");
+        ASSERT_EQUALS(false, Token::Match(code.tokens(), pattern));
+        ASSERT_EQUALS(false, Token::simpleMatch(code.tokens(), pattern));
+        ASSERT_EQUALS("else", Token::findmatch(code.tokens(), pattern)->str());
+        ASSERT_EQUALS("else", Token::findsimplematch(code.tokens(), pattern)->str());
+
+        // A const local array has the same address in each iteration but not the same content
+        const char * const patterns[] = {"if (", "else", "( x "};
+        const bool matches[] = {true, false, false};
+        const char * const found[] = {"if", "else", "("};
+        for (int i = 0; i < 3; ++i) {
+            const char * const str = patterns[i];
+            const char localPattern[5] = {str[0], str[1], str[2], str[3], '\0'};
+            ASSERT_EQUALS(matches[i], Token::Match(code.tokens(), localPattern));
+            ASSERT_EQUALS(matches[i], Token::simpleMatch(code.tokens(), localPattern));
+            ASSERT_EQUALS(found[i], Token::findmatch(code.tokens(), localPattern)->str());
+        }
+    }
+
+    void arena() {
+        TokenArena arena;
+        void *p1 = arena.allocate(20);
+        void *p2 = arena.allocate(24);
+        ASSERT(p1 != p2);
+        arena.deallocate(p1, 20);
+        ASSERT(p1 == arena.allocate(24)); // same size after rounding
+        ASSERT_EQUALS(3U, arena.allocations());
+        ASSERT_EQUALS(1U, arena.reused());
+        arena.clear(); // not released, two objects are allocated
+        ASSERT(arena.size() > 0);
+        arena.deallocate(p1, 24);
+        arena.deallocate(p2, 24);
+        arena.clear();
+        ASSERT_EQUALS(0U, arena.size());
+
+        // The tokens, the original names and the value types are in the arena of the list
+        static const Settings settings;
+        Tokenizer tokenizer(&settings, this);
+        std::istringstream istr("std::size_t x ; x = 1 ;");
+        tokenizer.tokenize(istr, "test.cpp");
+        const TokenArena &listArena = tokenizer.list.arena();
+        ASSERT(listArena.size() > 0);
+        ASSERT(listArena.allocations() > listArena.reused());
+        const Token *x = Token::findsimplematch(tokenizer.tokens(), "x =");
+        ASSERT(x && x->valueType());
+        tokenizer.list.deallocateTokens();
+        ASSERT_EQUALS(0U, listArena.size());
+    }
+
     static void append_vector(std::vector<std::string> &dest, const std::vector<std::string> &src) {
         dest.insert(dest.end(), src.begin(), src.end());
     }
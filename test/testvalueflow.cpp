@@ -51,6 +51,9 @@ private:
         "</def>";
         settings.library.loadxmldata(cfg, sizeof(cfg));
 
+        TEST_CASE(valueContainer);
+        TEST_CASE(sharedErrorPath);
+
         TEST_CASE(valueFlowNumber);
         TEST_CASE(valueFlowString);
         TEST_CASE(valueFlowPointerAlias);
@@ -116,6 +119,12 @@ private:
         TEST_CASE(valueFlowTerminatingCond);
 
         TEST_CASE(valueFlowContainerSize);
+
+        TEST_CASE(valueFlowIncremental);
+        TEST_CASE(valueFlowJobs);
+        TEST_CASE(valueFlowMaxForwardTokens);
+        TEST_CASE(valueFlowMaxIterations);
+        TEST_CASE(valueFlowMaxValues);
     }
 
     static bool isNotTokValue(const ValueFlow::Value &val) {
@@ -148,7 +157,7 @@ private:
 
         for (const Token *tok = tokenizer.tokens(); tok; tok = tok->next()) {
             if (tok->str() == "x" && tok->linenr() == linenr) {
-                std::list<ValueFlow::Value>::const_iterator it;
+                ValueFlow::Values::const_iterator it;
                 for (it = tok->values().begin(); it != tok->values().end(); ++it) {
                     if (it->isIntValue() && it->intvalue == value)
                         return true;
@@ -167,7 +176,7 @@ private:
 
         for (const Token *tok = tokenizer.tokens(); tok; tok = tok->next()) {
             if (tok->str() == "x" && tok->linenr() == linenr) {
-                std::list<ValueFlow::Value>::const_iterator it;
+                ValueFlow::Values::const_iterator it;
                 for (it = tok->values().begin(); it != tok->values().end(); ++it) {
                     if (it->isFloatValue() && it->floatValue >= value - diff && it->floatValue <= value + diff)
                         return true;
@@ -189,9 +198,10 @@ private:
                 continue;
 
             std::ostringstream ostr;
-            std::list<ValueFlow::Value>::const_iterator it;
+            ValueFlow::Values::const_iterator it;
             for (it = tok->values().begin(); it != tok->values().end(); ++it) {
-                for (ValueFlow::Value::ErrorPath::const_iterator ep = it->errorPath.begin(); ep != it->errorPath.end(); ++ep) {
+                const ValueFlow::Value::ErrorPath errorPath = it->errorPath;
+                for (ValueFlow::Value::ErrorPath::const_iterator ep = errorPath.begin(); ep != errorPath.end(); ++ep) {
                     const Token *eptok = ep->first;
                     const std::string &msg = ep->second;
                     ostr << eptok->linenr() << ',' << msg << '\n';
@@ -211,7 +221,7 @@ private:
 
         for (const Token *tok = tokenizer.tokens(); tok; tok = tok->next()) {
             if (tok->str() == "x" && tok->linenr() == linenr) {
-                std::list<ValueFlow::Value>::const_iterator it;
+                ValueFlow::Values::const_iterator it;
                 for (it = tok->values().begin(); it != tok->values().end(); ++it) {
                     if (it->valueType == type && Token::simpleMatch(it->tokvalue, value))
                         return true;
@@ -230,7 +240,7 @@ private:
 
         for (const Token *tok = tokenizer.tokens(); tok; tok = tok->next()) {
             if (tok->str() == "x" && tok->linenr() == linenr) {
-                std::list<ValueFlow::Value>::const_iterator it;
+                ValueFlow::Values::const_iterator it;
                 for (it = tok->values().begin(); it != tok->values().end(); ++it) {
                     if (it->isMovedValue() && it->moveKind == moveKind)
                         return true;
@@ -249,7 +259,7 @@ private:
 
         for (const Token *tok = tokenizer.tokens(); tok; tok = tok->next()) {
             if (tok->str() == "x" && tok->linenr() == linenr) {
-                std::list<ValueFlow::Value>::const_iterator it;
+                ValueFlow::Values::const_iterator it;
                 for (it = tok->values().begin(); it != tok->values().end(); ++it) {
                     if (it->isIntValue() && it->intvalue == value && it->condition)
                         return true;
@@ -286,7 +296,7 @@ private:
         errout.str("");
         tokenizer.tokenize(istr, "test.cpp");
         const Token *tok = Token::findmatch(tokenizer.tokens(), tokstr);
-        return tok ? tok->values() : std::list<ValueFlow::Value>();
+        return tok ? std::list<ValueFlow::Value>(tok->values().begin(), tok->values().end()) : std::list<ValueFlow::Value>();
     }
 
     ValueFlow::Value valueOfTok(const char code[], const char tokstr[]) {
@@ -294,6 +304,65 @@ private:
         return values.size() == 1U && !values.front().isTokValue() ? values.front() : ValueFlow::Value();
     }
 
+    void valueContainer() const {
+        ValueFlow::Values values;
+        ASSERT(values.empty());
+        for (int i = 1; i <= 5; ++i) // more than fit inline
+            values.push_back(ValueFlow::Value(i));
+        values.insert(values.begin(), ValueFlow::Value(0));
+        ASSERT_EQUALS(6U, values.size());
+        for (int i = 0; i <= 5; ++i)
+            ASSERT_EQUALS(i, values[i].intvalue);
+
+        values.remove_if([](const ValueFlow::Value &v) {
+            return v.intvalue % 2 == 0;
+        });
+        ASSERT_EQUALS(3U, values.size());
+        ASSERT_EQUALS(1, values.front().intvalue);
+        ASSERT_EQUALS(5, values.back().intvalue);
+
+        ValueFlow::Values copy(values);
+        ASSERT(copy == values);
+        ValueFlow::Values moved(std::move(copy));
+        ASSERT(moved == values);
+        moved.remove_if([](const ValueFlow::Value &v) {
+            return v.intvalue > 1;
+        });
+        ValueFlow::Values small(std::move(moved)); // inline elements are moved one by one
+        ASSERT_EQUALS(1U, small.size());
+        ASSERT_EQUALS(1, small.front().intvalue);
+    }
+
+    void sharedErrorPath() const {
+        ValueFlow::Value value1(1);
+        ASSERT(value1.errorPath.empty());
+        value1.errorPath.emplace_back(nullptr, "first");
+
+        // copies share the items, an item that is added to a copy is not in the other copies
+        ValueFlow::Value value2(value1);
+        value2.errorPath.emplace_back(nullptr, "second");
+        ASSERT_EQUALS(1U, value1.errorPath.size());
+        ASSERT_EQUALS(2U, value2.errorPath.size());
+
+        ErrorPath errorPath = value2.errorPath;
+        ASSERT_EQUALS("first", errorPath.front().second);
+        ASSERT_EQUALS("second", errorPath.back().second);
+        value1.errorPath = errorPath;
+        ASSERT_EQUALS(2U, value1.errorPath.size());
+
+        value1.errorPath.emplace_front(nullptr, "zero");
+        errorPath = value1.errorPath;
+        ASSERT_EQUALS(3U, errorPath.size());
+        ASSERT_EQUALS("zero", errorPath.front().second);
+        ASSERT_EQUALS("second", errorPath.back().second);
+
+        // a long path is released without recursion
+        ValueFlow::Value value3(3);
+        for (int i = 0; i < 1000000; ++i)
+            value3.errorPath.emplace_back(nullptr, "");
+        ASSERT_EQUALS(1000000U, value3.errorPath.size());
+    }
+
     void valueFlowNumber() {
         ASSERT_EQUALS(123, valueOfTok("x=123;", "123").intvalue);
         ASSERT(std::fabs(valueOfTok("x=0.5;", "0.5").floatValue - 0.5f) < 0.1f);
@@ -3787,6 +3856,191 @@ private:
                "}";
         ASSERT_EQUALS("", isKnownContainerSizeValue(tokenValues(code, "+"), 8));
     }
+
+    /** The values of all tokens, as in the --debug output */
+    std::string valueFlowOutput(const char code[], bool incremental = true) {
+        Tokenizer tokenizer(&settings, this);
+        std::istringstream istr(code);
+        tokenizer.tokenize(istr, "test.cpp");
+        // Analyse all functions in each iteration
+        if (!incremental)
+            ValueFlow::setValues(&tokenizer.list, const_cast<SymbolDatabase *>(tokenizer.getSymbolDatabase()), this, &settings, nullptr, false);
+        std::ostringstream ostr;
+        tokenizer.tokens()->printValueFlow(false, ostr);
+        return ostr.str();
+    }
+
+    void valueFlowIncremental() {
+        // Values that are only found in the second iteration. The functions
+        // where no values were added are not analysed again.
+        const char * const code[] = {
+            "void f1() {\n"
+            "  for (int i = 0; i < 10; i++) {\n"
+            "    int x = i;\n"
+            "    a[x] = 0;\n"
+            "  }\n"
+            "}\n"
+            "void f2(int c) {\n"
+            "  int x = 0;\n"
+            "  if (c == 5) { x = 3; }\n"
+            "  a = x;\n"
+            "}\n"
+            "void f3(int y) {\n"
+            "  switch (y) {\n"
+            "  case 3: {\n"
+            "    int x = y;\n"
+            "    a = x;\n"
+            "    break;\n"
+            "  }\n"
+            "  }\n"
+            "}",
+
+            "void f1(int y) {\n"
+            "  switch (y) {\n"
+            "  case 3: {\n"
+            "    int z = y;\n"
+            "    for (int i = z; i < 10; i++) {\n"
+            "      int x = i;\n"
+            "      a[x] = 0;\n"
+            "    }\n"
+            "    break;\n"
+            "  }\n"
+            "  }\n"
+            "}\n"
+            "void f2(int x) {\n"
+            "  if (x == 4) {}\n"
+            "  a = x;\n"
+            "}"
+        };
+
+        for (std::size_t i = 0; i < sizeof(code) / sizeof(code[0]); ++i) {
+            ASSERT_EQUALS(valueFlowOutput(code[i], false), valueFlowOutput(code[i]));
+        }
+
+        ASSERT_EQUALS(true, testValueOfX(code[0], 4U, 9));
+        ASSERT_EQUALS(true, testValueOfX(code[0], 10U, 3));
+        ASSERT_EQUALS(true, testValueOfX(code[0], 16U, 3));
+        ASSERT_EQUALS(true, testValueOfX(code[1], 15U, 4));
+
+        // They are not found in one iteration
+        settings.valueFlowMaxIterations = 1;
+        ASSERT_EQUALS(false, testValueOfX(code[0], 4U, 9));
+        ASSERT_EQUALS(false, testValueOfX(code[0], 16U, 3));
+        settings.valueFlowMaxIterations = 0;
+    }
+
+    void valueFlowJobs() {
+        // The functions are analysed in parallel, the result is the same as
+        // when they are analysed one by one
+        const char code[] = "void f1(int x) {\n"
+                            "  a = x;\n"
+                            "  if (x == 1) {}\n"
+                            "}\n"
+                            "void f2() {\n"
+                            "  int x = 2;\n"
+                            "  a = x;\n"
+                            "}\n"
+                            "void f3(int x) {\n"
+                            "  a = x;\n"
+                            "  if (x == 3) {}\n"
+                            "}\n"
+                            "void f4(int x) {\n"
+                            "  a = x;\n"
+                            "  while (x == 4) { x++; }\n"
+                            "}\n"
+                            "void f5(int x) {\n"
+                            "  if (x == 5) {}\n"
+                            "  a = x;\n"
+                            "}\n"
+                            "int g;\n"
+                            "void f6() {\n"
+                            "  g = 6;\n"
+                            "}\n"
+                            "void f7() {\n"
+                            "  a = g;\n"
+                            "}";
+        const unsigned int jobs[] = { 1, 4 };
+        for (unsigned int valueFlowJobs : jobs) {
+            settings.valueFlowJobs = valueFlowJobs;
+            ASSERT_EQUALS(true, testValueOfX(code, 2U, 1));
+            ASSERT_EQUALS(true, testValueOfX(code, 7U, 2));
+            ASSERT_EQUALS(true, testValueOfX(code, 10U, 3));
+            ASSERT_EQUALS(false, testValueOfX(code, 14U, 4));
+            ASSERT_EQUALS(true, testValueOfX(code, 19U, 5));
+        }
+
+        // The values of all tokens are the same
+        settings.valueFlowJobs = 1;
+        const std::string values = valueFlowOutput(code);
+        settings.valueFlowJobs = 4;
+        ASSERT_EQUALS(values, valueFlowOutput(code));
+
+        // Bailout messages are reported in the order of the functions. The
+        // analysis of g is continued after f6 when all functions are done.
+        settings.valueFlowJobs = 1;
+        bailout(code);
+        const std::string bailouts = errout.str();
+        settings.valueFlowJobs = 4;
+        bailout(code);
+        settings.valueFlowJobs = 1;
+        ASSERT_EQUALS(bailouts, errout.str());
+        ASSERT_EQUALS_WITHOUT_LINENUMBERS("[test.cpp:15]: (debug) valueflow.cpp:1:valueFlowBeforeCondition bailout: variable x used in loop\n"
+                                          "[test.cpp:25]: (debug) valueflow.cpp:1:valueFlowForward bailout: variable g is assigned in conditional code\n"
+                                          "[test.cpp:15]: (debug) valueflow.cpp:1:afterCondition bailout: valueFlowAfterCondition: x is changed in conditional block\n", errout.str());
+    }
+
+    void valueFlowMaxForwardTokens() {
+        const char code[] = "void f() {\n"
+                            "  int x = 1;\n"
+                            "  a = 0;\n"
+                            "  a = x;\n"
+                            "}";
+        ASSERT_EQUALS(true, testValueOfX(code, 4U, 1));
+        settings.valueFlowMaxForwardTokens = 5;
+        ASSERT_EQUALS(false, testValueOfX(code, 4U, 1));
+
+        bailout(code);
+        settings.valueFlowMaxForwardTokens = 100000;
+        ASSERT_EQUALS_WITHOUT_LINENUMBERS("[test.cpp:4]: (debug) valueflow.cpp:1:valueFlowForward bailout: max number of forwarded tokens (5) reached\n", errout.str());
+    }
+
+    void valueFlowMaxIterations() {
+        // The value of x is found in the second iteration
+        const char code[] = "void f() {\n"
+                            "  for (int i = 0; i < 10; i++) {\n"
+                            "    int x = i;\n"
+                            "    a[x] = 0;\n"
+                            "  }\n"
+                            "}";
+
+        // By default the analysis is repeated until no values are added
+        ASSERT_EQUALS(0U, Settings().valueFlowMaxIterations);
+        ASSERT_EQUALS(true, testValueOfX(code, 4U, 9));
+        settings.valueFlowMaxIterations = 2;
+        ASSERT_EQUALS(true, testValueOfX(code, 4U, 9));
+        settings.valueFlowMaxIterations = 1;
+        ASSERT_EQUALS(false, testValueOfX(code, 4U, 9));
+
+        bailout(code);
+        settings.valueFlowMaxIterations = 0;
+        ASSERT(errout.str().find("(debug) ValueFlow: max number of iterations (1) reached, more values could be found") != std::string::npos);
+    }
+
+    void valueFlowMaxValues() {
+        const char code[] = "void f(int x) {\n"
+                            "  if (x == 1) {}\n"
+                            "  if (x == 2) {}\n"
+                            "  if (x == 3) {}\n"
+                            "  a = x;\n"
+                            "}";
+        ASSERT_EQUALS(true, testValueOfX(code, 5U, 3));
+        settings.valueFlowMaxValues = 2;
+        ASSERT_EQUALS(false, testValueOfX(code, 5U, 3));
+
+        bailout(code);
+        settings.valueFlowMaxValues = 10;
+        ASSERT(errout.str().find("(debug) ValueFlow: max number of values per token (2) reached") != std::string::npos);
+    }
 };
 
 REGISTER_TEST(TestValueFlow)
@@ -257,6 +257,9 @@ int main(int argc, char **argv)
          << "        endif # !CPPCHK_GLIBCXX_DEBUG\n"
          << "    endif # GNU/kFreeBSD\n"
          << "\n"
+         << "    # std::thread is used by the ValueFlow analysis\n"
+         << "    override LDFLAGS += -pthread\n"
+         << "\n"
          << "endif # COMSPEC\n"
          << "\n";
 
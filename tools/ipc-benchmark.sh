@@ -0,0 +1,40 @@
+#!/bin/bash
+#
+# Measure how fast diagnostics are passed from the -j child processes
+# to the main process. Generates files that give many findings each and
+# checks them with and without --worker-pool.
+#
+# Arguments:
+# $1: cppcheck binary (default: ./cppcheck)
+# $2: number of jobs (default: 4)
+# $3: number of files (default: 16)
+# $4: findings per file (default: 5000)
+#
+# Example usage:
+# tools/ipc-benchmark.sh ./cppcheck 8 32 10000
+
+set -e
+
+cppcheck=${1:-./cppcheck}
+jobs=${2:-4}
+files=${3:-16}
+findings=${4:-5000}
+
+dir=$(mktemp -d)
+trap 'rm -rf "$dir"' EXIT
+
+for ((f = 0; f < files; f++)); do
+    {
+        for ((i = 0; i < findings; i++)); do
+            echo "void f$i() { char a[10]; a[$((i + 10))] = 0; }"
+        done
+    } > "$dir/file$f.c"
+done
+
+for mode in "" "--worker-pool"; do
+    start=$(date +%s.%N)
+    count=$("$cppcheck" -q -j"$jobs" $mode --template='{file}:{line}:{id}' "$dir" 2>&1 | wc -l)
+    end=$(date +%s.%N)
+    awk -v mode="${mode:-fork per file}" -v count="$count" -v t="$(echo "$end $start" | awk '{print $1 - $2}')" \
+        'BEGIN { printf "%s: %d messages in %.2f s, %.0f messages/s\n", mode, count, t, count / t }'
+done
@@ -0,0 +1,35 @@
+#!/bin/bash
+#
+# Compare the time spent on Token::Match patterns in different cppcheck
+# binaries. Build the binaries with the same optimisation flags, for
+# instance one from the current revision, one from an older revision that
+# interprets all patterns and one with the matchcompiler (make SRCDIR=build).
+# Each binary checks the files a few times and the best time is shown.
+#
+# Arguments:
+# $1: file or directory to check (default: lib/tokenize.cpp)
+# $2...: cppcheck binaries (default: ./cppcheck)
+#
+# Example usage:
+# tools/match-benchmark.sh lib/tokenize.cpp ./cppcheck ~/cppcheck-old/cppcheck ~/cppcheck-matchcompiler/cppcheck
+
+set -e
+
+files=${1:-lib/tokenize.cpp}
+shift || true
+binaries=("$@")
+if [ ${#binaries[@]} -eq 0 ]; then
+    binaries=(./cppcheck)
+fi
+runs=3
+
+for binary in "${binaries[@]}"; do
+    best=
+    for ((i = 0; i < runs; i++)); do
+        start=$(date +%s.%N)
+        "$binary" -q --enable=all --inconclusive "$files" 2> /dev/null
+        end=$(date +%s.%N)
+        best=$(echo "$end $start $best" | awk '{ t = $1 - $2; if ($3 == "" || t < $3) print t; else print $3 }')
+    done
+    printf "%s: %.2f s\n" "$binary" "$best"
+done